@@ -0,0 +1,350 @@
+/*
+ * Benchmark of the bigint operations across operand sizes.
+ *
+ * Every operation is timed on random operands of a number of decimal digits that goes from one
+ * machine word (19 digits) up to 10^7 digits, and reported as ns/op, ops/s, input bytes/s and
+ * limb bytes allocated per operation. The results are printed as a table and can be written as
+ * JSON with --json, to be compared between releases. Built with BIGINT_BENCH_GMP defined and
+ * linked with -lgmpxx -lgmp, every operation is also timed with GMP.
+ *
+ * Usage: bench [--max-digits N] [--min-time SECONDS] [--only OPERATION] [--threads N]
+ *              [--json FILE]
+ */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include "../bigint.hpp"
+#ifdef BIGINT_BENCH_GMP
+#include <gmpxx.h>
+#endif
+using namespace std;
+
+/**
+ * @brief Memory resource that counts the bytes allocated through it and forwards to another.
+ */
+class counting_resource : public pmr::memory_resource
+{
+public:
+    explicit counting_resource(pmr::memory_resource *upstream_) : upstream(upstream_) {}
+
+    size_t allocated() const
+    {
+        return bytes.load(memory_order_relaxed);
+    }
+    void reset()
+    {
+        bytes.store(0, memory_order_relaxed);
+    }
+
+private:
+    pmr::memory_resource *upstream;
+    atomic<size_t> bytes{0};
+
+    void *do_allocate(size_t size, size_t alignment) override
+    {
+        bytes.fetch_add(size, memory_order_relaxed);
+        return upstream->allocate(size, alignment);
+    }
+    void do_deallocate(void *p, size_t size, size_t alignment) override
+    {
+        upstream->deallocate(p, size, alignment);
+    }
+    bool do_is_equal(const pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+/* One line of the report. */
+struct result
+{
+    string operation;
+    size_t digits;
+    double ns_per_op;
+    double bytes_per_op;
+    double input_bytes;
+    double gmp_ns_per_op;
+};
+
+struct options
+{
+    size_t max_digits = 10000000;
+    double min_time = 0.2;
+    string only;
+    size_t threads = 0;
+    string json;
+};
+
+/* Keeps the optimizer from discarding a computed value. */
+template <class T>
+void keep(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+/**
+ * @brief Runs op repeatedly for at least min_time seconds and returns the mean time per call in
+ * nanoseconds, together with the limb bytes allocated per call.
+ */
+template <class F>
+pair<double, double> measure(const F &op, double min_time, counting_resource *counter)
+{
+    using clock = chrono::steady_clock;
+    op(); /* Warms up the caches and the lazily built tables. */
+    size_t iterations = 0;
+    if (counter != nullptr)
+    {
+        counter->reset();
+    }
+    const clock::time_point start = clock::now();
+    double elapsed = 0;
+    for (size_t batch = 1; elapsed < min_time; batch *= 2)
+    {
+        for (size_t i = 0; i < batch; i++)
+        {
+            op();
+        }
+        iterations += batch;
+        elapsed = chrono::duration<double>(clock::now() - start).count();
+    }
+    const double bytes = counter != nullptr ? (double)counter->allocated() / (double)iterations : 0;
+    return {elapsed * 1e9 / (double)iterations, bytes};
+}
+
+string random_digits(mt19937_64 &rng, size_t digits)
+{
+    string s(digits, '0');
+    s[0] = (char)('1' + rng() % 9);
+    for (size_t i = 1; i < digits; i++)
+    {
+        s[i] = (char)('0' + rng() % 10);
+    }
+    return s;
+}
+
+void print_row(const result &r)
+{
+    cout << left << setw(12) << r.operation << right << setw(10) << r.digits << setw(16) << fixed << setprecision(1)
+         << r.ns_per_op << setw(14) << setprecision(0) << 1e9 / r.ns_per_op << setw(12) << setprecision(1)
+         << r.input_bytes / r.ns_per_op * 1e9 / 1048576 << setw(14) << setprecision(0) << r.bytes_per_op;
+    if (r.gmp_ns_per_op > 0)
+    {
+        cout << setw(16) << setprecision(1) << r.gmp_ns_per_op << setw(10) << setprecision(2) << r.ns_per_op / r.gmp_ns_per_op;
+    }
+    cout << endl;
+}
+
+void write_json(const string &path, const options &opts, const vector<result> &results)
+{
+    ofstream out(path);
+    if (!out)
+    {
+        throw runtime_error("cannot open " + path);
+    }
+    out << "{\n  \"benchmark\": \"bigint\",\n";
+#ifdef BIGINT_BENCH_GMP
+    out << "  \"gmp\": \"" << gmp_version << "\",\n";
+#else
+    out << "  \"gmp\": null,\n";
+#endif
+    out << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+    out << "  \"min_time\": " << opts.min_time << ",\n";
+    out << "  \"threads\": " << opts.threads << ",\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const result &r = results[i];
+        out << (i == 0 ? "\n" : ",\n") << setprecision(6) << defaultfloat;
+        out << "    {\"operation\": \"" << r.operation << "\", \"digits\": " << r.digits
+            << ", \"ns_per_op\": " << r.ns_per_op << ", \"ops_per_second\": " << 1e9 / r.ns_per_op
+            << ", \"input_bytes_per_second\": " << r.input_bytes / r.ns_per_op * 1e9
+            << ", \"bytes_allocated_per_op\": " << r.bytes_per_op;
+        if (r.gmp_ns_per_op > 0)
+        {
+            out << ", \"gmp_ns_per_op\": " << r.gmp_ns_per_op;
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+options parse_options(int argc, char **argv)
+{
+    options opts;
+    for (int i = 1; i < argc; i++)
+    {
+        const string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            throw invalid_argument("missing value for " + arg);
+        }
+        const string value = argv[++i];
+        if (arg == "--max-digits")
+        {
+            opts.max_digits = stoull(value);
+        }
+        else if (arg == "--min-time")
+        {
+            opts.min_time = stod(value);
+        }
+        else if (arg == "--only")
+        {
+            opts.only = value;
+        }
+        else if (arg == "--threads")
+        {
+            opts.threads = stoull(value);
+        }
+        else if (arg == "--json")
+        {
+            opts.json = value;
+        }
+        else
+        {
+            throw invalid_argument("unknown option " + arg);
+        }
+    }
+    return opts;
+}
+
+int main(int argc, char **argv)
+{
+    options opts;
+    try
+    {
+        opts = parse_options(argc, argv);
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << "\nusage: bench [--max-digits N] [--min-time SECONDS] [--only OPERATION] "
+             << "[--threads N] [--json FILE]\n";
+        return 1;
+    }
+    unique_ptr<bigint_parallel_scope> parallel;
+    if (opts.threads > 1)
+    {
+        parallel = make_unique<bigint_parallel_scope>(opts.threads);
+    }
+    counting_resource counter(pmr::new_delete_resource());
+    mt19937_64 rng(20231218);
+    vector<result> results;
+
+    cout << left << setw(12) << "operation" << right << setw(10) << "digits" << setw(16) << "ns/op" << setw(14)
+         << "ops/s" << setw(12) << "MB/s" << setw(14) << "bytes/op";
+#ifdef BIGINT_BENCH_GMP
+    cout << setw(16) << "gmp ns/op" << setw(10) << "ratio";
+#endif
+    cout << endl;
+
+    /* Runs one operation of the sweep; gmp_op is ignored when GMP is not compiled in. */
+    auto run = [&](const string &name, size_t digits, double input_bytes, const auto &op, const auto &gmp_op)
+    {
+        if (!opts.only.empty() && opts.only != name)
+        {
+            return;
+        }
+        result r{name, digits, 0, 0, input_bytes, 0};
+        {
+            bigint_memory_scope scope(&counter);
+            tie(r.ns_per_op, r.bytes_per_op) = measure(op, opts.min_time, &counter);
+        }
+#ifdef BIGINT_BENCH_GMP
+        r.gmp_ns_per_op = measure(gmp_op, opts.min_time, nullptr).first;
+#else
+        (void)gmp_op;
+#endif
+        print_row(r);
+        results.push_back(r);
+    };
+
+    /* Powmod costs a multiplication per bit of the exponent, so its sweep stops earlier. */
+    const size_t powmod_max_digits = 1000;
+    for (size_t digits = 19; digits <= opts.max_digits; digits = digits == 19 ? 100 : digits * 10)
+    {
+        const string s = random_digits(rng, digits), t = random_digits(rng, digits);
+        const string wide = random_digits(rng, 2 * digits);
+        const bigint x(s), y(t), w(wide);
+        /* Equal to x except in the last digit, so the comparison reads every limb. */
+        string s_last = s;
+        s_last.back() = s_last.back() == '9' ? '0' : (char)(s_last.back() + 1);
+        const bigint x_last(s_last);
+        const double bytes = 8.0 * (double)((digits * 3322 / 1000 + 63) / 64);
+#ifdef BIGINT_BENCH_GMP
+        const mpz_class gx(s), gy(t), gw(wide), gx_last(s_last);
+#define GMP_OP(...) [&] { __VA_ARGS__; }
+#else
+#define GMP_OP(...) [] {}
+#endif
+
+        if (digits == 19)
+        {
+            const int64_t value = (int64_t)(rng() >> 1);
+            run("from_int64", digits, 8, [&]
+                { bigint r(value); keep(r); },
+                GMP_OP(mpz_class r((long)value); keep(r)));
+        }
+        run("from_string", digits, (double)digits, [&]
+            { bigint r(s); keep(r); },
+            GMP_OP(mpz_class r(s); keep(r)));
+        run("to_stream", digits, bytes, [&]
+            { ostringstream out; out << x; keep(out); },
+            GMP_OP(ostringstream out; out << gx; keep(out)));
+        /* The same conversions with decimal_bigint, whose limbs are decimal. */
+        const decimal_bigint dx(s);
+        run("dec_parse", digits, (double)digits, [&]
+            { decimal_bigint r(s); keep(r); },
+            GMP_OP(mpz_class r(s); keep(r)));
+        run("dec_print", digits, bytes, [&]
+            { ostringstream out; out << dx; keep(out); },
+            GMP_OP(ostringstream out; out << gx; keep(out)));
+        run("compare", digits, 2 * bytes, [&]
+            { bool r = x < x_last; keep(r); },
+            GMP_OP(bool r = gx < gx_last; keep(r)));
+        run("shift_left", digits, bytes, [&]
+            { bigint r = x << 77; keep(r); },
+            GMP_OP(mpz_class r = gx << 77; keep(r)));
+        run("and", digits, 2 * bytes, [&]
+            { bigint r = x & y; keep(r); },
+            GMP_OP(mpz_class r = gx & gy; keep(r)));
+        {
+            /* The running sum grows by at most one bit per doubling of the iterations. */
+            bigint r = x;
+#ifdef BIGINT_BENCH_GMP
+            mpz_class gr = gx;
+#endif
+            run("add_assign", digits, 2 * bytes, [&]
+                { r += y; keep(r); },
+                GMP_OP(gr += gy; keep(gr)));
+            run("sub_assign", digits, 2 * bytes, [&]
+                { r -= y; keep(r); },
+                GMP_OP(gr -= gy; keep(gr)));
+        }
+        run("multiply", digits, 2 * bytes, [&]
+            { bigint r = x * y; keep(r); },
+            GMP_OP(mpz_class r = gx * gy; keep(r)));
+        run("divide", digits, 3 * bytes, [&]
+            { bigint r = w / y; keep(r); },
+            GMP_OP(mpz_class r = gw / gy; keep(r)));
+        if (digits <= powmod_max_digits)
+        {
+            /* An odd modulus, as in cryptography, and an exponent of the same size. */
+            const bigint m = y + ((t.back() - '0') % 2 == 0 ? 1 : 0), e = w % m;
+            const bigint_modulus ctx(m);
+#ifdef BIGINT_BENCH_GMP
+            const mpz_class gm(m.get_string()), ge(e.get_string());
+#endif
+            run("powmod", digits, 3 * bytes, [&]
+                { bigint r = ctx.powmod(x, e); keep(r); },
+                GMP_OP(mpz_class r; mpz_powm(r.get_mpz_t(), gx.get_mpz_t(), ge.get_mpz_t(), gm.get_mpz_t()); keep(r)));
+        }
+#undef GMP_OP
+    }
+
+    if (!opts.json.empty())
+    {
+        write_json(opts.json, opts, results);
+        cout << "results written to " << opts.json << endl;
+    }
+    return 0;
+}
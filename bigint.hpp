@@ -3,703 +3,10101 @@
 #include <vector>
 #include <string>
 #include <typeinfo>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <tuple>
+#include <memory_resource>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <exception>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <string_view>
+#include <span>
+#include <optional>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+#if __has_include(<sys/mman.h>)
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 /**
- * @brief A class representing arbitrary-precision integers (bigint).
- *
- * The `bigint` class allows the representation and manipulation of integers with
- * arbitrary precision. It supports various arithmetic operations, including
- * addition, subtraction, and multiplication, as well as comparison operations.
- * Additionally, it includes utility functions for handling large integers.
- *
- * @note The implementation ensures proper handling of negative integers and
- *       performs input validation to ensure the integrity of the stored data.
+ * @brief Crossover points, in limbs, between the multiplication and division algorithms of bigint.
  *
- * @details The class provides a set of constructors and overloaded operators to
- *          facilitate the creation and manipulation of bigint instances.
- *          Operations like addition, subtraction, and multiplication are implemented
- *          as friend functions to allow seamless usage with other bigint instances.
+ * @details An algorithm is used once both operands have at least the given number of limbs.
+ * The number-theoretic transform (ntt) is also used for unbalanced operands as soon as the
+ * smaller one reaches its threshold. Division switches from schoolbook to Burnikel-Ziegler (bz)
+ * once both the divisor and the quotient block reach div_bz limbs. Conversion to and from
+ * decimal strings switches to divide and conquer above conversion_dc limbs, and the greatest
+ * common divisor switches from Lehmer's algorithm to the half-gcd above gcd_hgcd limbs.
+ * When an executor is installed with bigint_parallel_scope, multiplications and conversions
+ * of at least parallel limbs run their independent parts as parallel tasks.
+ * The squaring thresholds apply when both operands are the same object. The defaults were
+ * measured on x86-64; bigint::tune_thresholds() measures them for the host machine, except
+ * gcd_hgcd, which depends on all the others, and parallel.
  */
-class bigint
+struct bigint_thresholds
 {
+    size_t mul_karatsuba = 24;
+    size_t mul_toom3 = 300;
+    size_t sqr_karatsuba = 40;
+    size_t sqr_toom3 = 260;
+    size_t mul_ntt = 3072;
+    size_t sqr_ntt = 3584;
+    size_t div_bz = 24;
+    size_t conversion_dc = 30;
+    size_t gcd_hgcd = 300;
+    size_t parallel = 2048;
+};
 
+/**
+ * @brief Interface through which bigint runs the independent parts of large operations in
+ * parallel.
+ *
+ * @details bigint_thread_pool implements it. An application that already has a thread pool can
+ * implement it on top of that pool and install it with a bigint_parallel_scope. A task that is
+ * submitted may run on any thread at any later time: when bigint needs the result of a task
+ * that has not started yet, it runs the task on the waiting thread, so no executor can
+ * deadlock, even one with a single thread or with all of its threads busy.
+ */
+class bigint_executor
+{
 public:
+    virtual ~bigint_executor() = default;
     /**
-     * @brief Default constructor initializing the bigint to 0.
+     * @brief Schedules a task to run on one of the threads of the executor.
+     *
+     * @details It is called concurrently from several threads, including from the tasks
+     * themselves, so it must be thread-safe.
      */
-    bigint()
+    virtual void submit(function<void()> task) = 0;
+    /**
+     * @brief Returns the number of tasks the executor runs at the same time, which tells how
+     * finely the work is split.
+     */
+    virtual size_t concurrency() const = 0;
+};
+
+/**
+ * @brief Counters of the work done by bigint, collected when the program is compiled with
+ * BIGINT_INSTRUMENTATION defined.
+ *
+ * @details Every thread counts into its own counters, without locks; snapshot() adds up the
+ * counters of all threads, including the ones that have exited, since the last reset().
+ * Operations are counted at the public entry points only: the multiplications done inside a
+ * powmod count as one powmod, and show up in the algorithm counters. The operand size of an
+ * operation is the number of limbs of its largest operand, and is recorded in a histogram
+ * with one bucket per power of two. Algorithms count every call of the corresponding kernel,
+ * including the recursive ones, so a Karatsuba multiplication also counts the basecase
+ * multiplications at its leaves. Allocations count the heap buffers of limbs; values of up to
+ * two limbs never allocate. Without BIGINT_INSTRUMENTATION the hooks compile to nothing and
+ * snapshot() returns zeros.
+ */
+struct bigint_stats
+{
+    enum class operation
     {
-        biginteger = "0";
-    }
+        from_string,
+        to_string,
+        compare,
+        add,
+        sub,
+        mul,
+        addmul,
+        div,
+        pow,
+        powmod,
+        mulmod,
+        gcd,
+        root,
+        batch,
+        shift,
+        bitwise,
+        product,
+        prime,
+        count
+    };
+    enum class algorithm
+    {
+        mul_basecase,
+        sqr_basecase,
+        mul_karatsuba,
+        sqr_karatsuba,
+        mul_toom3,
+        sqr_toom3,
+        mul_ntt,
+        sqr_ntt,
+        divrem_1,
+        div_basecase,
+        div_bz,
+        parse_basecase,
+        parse_dc,
+        print_basecase,
+        print_dc,
+        gcd_lehmer,
+        gcd_hgcd,
+        sqrtrem,
+        reduce_barrett,
+        reduce_montgomery,
+        count
+    };
+    static constexpr size_t operation_count = (size_t)operation::count;
+    static constexpr size_t algorithm_count = (size_t)algorithm::count;
+    /* Bucket 0 holds operations on zero limbs, bucket b > 0 the ones on [2^(b-1), 2^b) limbs. */
+    static constexpr size_t size_buckets = 40;
+#ifdef BIGINT_INSTRUMENTATION
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    uint64_t calls[operation_count] = {};
+    uint64_t sizes[operation_count][size_buckets] = {};
+    uint64_t dispatches[algorithm_count] = {};
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t bytes_deallocated = 0;
+    /* Calls of erase_left_zeros and the leading zero limbs they removed. */
+    uint64_t normalizations = 0;
+    uint64_t limbs_stripped = 0;
+
+    uint64_t count(operation op) const { return calls[(size_t)op]; }
+    uint64_t count(algorithm a) const { return dispatches[(size_t)a]; }
+    static size_t size_bucket(size_t limbs) { return min<size_t>((size_t)bit_width(limbs), size_buckets - 1); }
+    static const char *name(operation op);
+    static const char *name(algorithm a);
+
     /**
-     * @brief Constructor initializing the bigint with a 64-bit integer.
+     * @brief Returns the counters of all threads since the program started or since the last
+     * call to reset().
+     */
+    static bigint_stats snapshot();
+    /**
+     * @brief Starts counting from zero again, for all threads.
+     */
+    static void reset();
+    /**
+     * @brief Function called at the end of every counted operation with the operation, the
+     * size of its largest operand in limbs and the time it took.
+     */
+    using timing_callback = function<void(operation, size_t, chrono::nanoseconds)>;
+    /**
+     * @brief Installs the function that receives the timing of every operation, or removes it
+     * when given an empty function.
      *
-     * @param a The 64-bit integer to initialize the bigint with.
+     * @details The clock is only read while a callback is installed. The callback runs on the
+     * thread that did the operation, possibly on several threads at once, and must not throw.
+     * A callback that is replaced is kept alive until the program ends, because another thread
+     * may still be calling it.
      */
-    bigint(const int64_t x_)
+    static void set_timing_callback(timing_callback callback);
+};
+
+/**
+ * @brief Low-level routines working on little-endian arrays of 64-bit limbs.
+ *
+ * @details A magnitude is stored as an array of machine words (limbs), least significant limb
+ * first. The routines in this namespace implement the word-at-a-time loops used by the bigint
+ * class. None of them allocate: the caller provides the output buffer, which may alias an input
+ * buffer as long as both start at the same limb.
+ */
+namespace bigint_detail
+{
+    using limb_t = uint64_t;
+    __extension__ typedef unsigned __int128 dlimb_t;
+    __extension__ typedef __int128 signed_dlimb_t;
+
+    /* Largest power of ten that fits in a limb, used to convert to and from decimal strings. */
+    constexpr limb_t decimal_base = 10000000000000000000ULL;
+    constexpr size_t decimal_base_digits = 19;
+
+    /**
+     * @brief Portable versions of the kernels that have processor-specific variants.
+     *
+     * @details They are the reference the other variants must agree with, and the ones used on
+     * processors without the required instructions. add_nc and sub_nc take an incoming carry
+     * (borrow), for the variants that finish the last limbs here.
+     */
+    namespace generic
     {
-        biginteger = to_string(x_);
+        inline limb_t add_nc(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t carry)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                limb_t s = a[i] + carry;
+                limb_t c = s < carry;
+                limb_t t = s + b[i];
+                c += t < s;
+                r[i] = t;
+                carry = c;
+            }
+            return carry;
+        }
+        inline limb_t add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            return add_nc(r, a, b, n, 0);
+        }
+        inline limb_t sub_nc(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t borrow)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                limb_t ai = a[i], bi = b[i];
+                limb_t d = ai - bi;
+                limb_t c = ai < bi;
+                c |= d < borrow;
+                r[i] = d - borrow;
+                borrow = c;
+            }
+            return borrow;
+        }
+        inline limb_t sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            return sub_nc(r, a, b, n, 0);
+        }
+        inline limb_t addmul_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+        {
+            limb_t carry = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                dlimb_t p = (dlimb_t)a[i] * b + r[i] + carry;
+                r[i] = (limb_t)p;
+                carry = (limb_t)(p >> 64);
+            }
+            return carry;
+        }
+        inline int cmp_n(const limb_t *a, const limb_t *b, size_t n)
+        {
+            for (size_t i = n; i-- > 0;)
+            {
+                if (a[i] != b[i])
+                {
+                    return a[i] < b[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+        inline size_t normalized_size(const limb_t *a, size_t n)
+        {
+            while (n > 0 && a[n - 1] == 0)
+            {
+                n--;
+            }
+            return n;
+        }
     }
+
+#if defined(__x86_64__) && defined(__GNUC__)
     /**
-     * @brief Set function that stores the value of a given integer passed as string to the private
-     * member of the bigint object.
-     *
-     * @param s The string to initialize the bigint with.
+     * @brief x86-64 variants of the kernels.
      *
-     * @note The implementation ensures proper handling of negative integers and
-     * performs input validation to ensure the integrity of the stored data. If string with an
-     * invalid integer is give, an invalid_argument error is thrown.
+     * @details Each function is compiled for the instruction set named in its target attribute,
+     * so the header needs no special compiler flags, and supported_kernels() only hands it out
+     * once the processor has been checked to support that instruction set.
      */
-    void set_string(const string &x_)
+    namespace x86
     {
-        if (x_[0] == '-')
+        /* Carry chain with adc, four limbs per iteration: dec leaves the carry flag alone and
+           mov and lea do not touch the flags, so the carry goes through the whole loop. */
+        inline limb_t add_n_adc(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            limb_t carry, t0, t1;
+            const size_t rest = n % 4, blocks = n / 4;
+            __asm__("xor %k[carry], %k[carry]\n\t"
+                    "mov %[rest], %%rcx\n\t"
+                    "jrcxz 2f\n"
+                    "1:\n\t"
+                    "mov (%[a]), %[t0]\n\t"
+                    "adc (%[b]), %[t0]\n\t"
+                    "mov %[t0], (%[r])\n\t"
+                    "lea 8(%[a]), %[a]\n\t"
+                    "lea 8(%[b]), %[b]\n\t"
+                    "lea 8(%[r]), %[r]\n\t"
+                    "dec %%rcx\n\t"
+                    "jnz 1b\n"
+                    "2:\n\t"
+                    "mov %[blocks], %%rcx\n\t"
+                    "jrcxz 4f\n"
+                    "3:\n\t"
+                    "mov (%[a]), %[t0]\n\t"
+                    "mov 8(%[a]), %[t1]\n\t"
+                    "adc (%[b]), %[t0]\n\t"
+                    "adc 8(%[b]), %[t1]\n\t"
+                    "mov %[t0], (%[r])\n\t"
+                    "mov %[t1], 8(%[r])\n\t"
+                    "mov 16(%[a]), %[t0]\n\t"
+                    "mov 24(%[a]), %[t1]\n\t"
+                    "adc 16(%[b]), %[t0]\n\t"
+                    "adc 24(%[b]), %[t1]\n\t"
+                    "mov %[t0], 16(%[r])\n\t"
+                    "mov %[t1], 24(%[r])\n\t"
+                    "lea 32(%[a]), %[a]\n\t"
+                    "lea 32(%[b]), %[b]\n\t"
+                    "lea 32(%[r]), %[r]\n\t"
+                    "dec %%rcx\n\t"
+                    "jnz 3b\n"
+                    "4:\n\t"
+                    "adc $0, %[carry]"
+                    : [carry] "=&r"(carry), [t0] "=&r"(t0), [t1] "=&r"(t1), [a] "+r"(a), [b] "+r"(b), [r] "+r"(r)
+                    : [rest] "r"(rest), [blocks] "r"(blocks)
+                    : "rcx", "cc", "memory");
+            return carry;
+        }
+        /* Borrow chain with sbb, organized like add_n_adc. */
+        inline limb_t sub_n_sbb(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            limb_t borrow, t0, t1;
+            const size_t rest = n % 4, blocks = n / 4;
+            __asm__("xor %k[borrow], %k[borrow]\n\t"
+                    "mov %[rest], %%rcx\n\t"
+                    "jrcxz 2f\n"
+                    "1:\n\t"
+                    "mov (%[a]), %[t0]\n\t"
+                    "sbb (%[b]), %[t0]\n\t"
+                    "mov %[t0], (%[r])\n\t"
+                    "lea 8(%[a]), %[a]\n\t"
+                    "lea 8(%[b]), %[b]\n\t"
+                    "lea 8(%[r]), %[r]\n\t"
+                    "dec %%rcx\n\t"
+                    "jnz 1b\n"
+                    "2:\n\t"
+                    "mov %[blocks], %%rcx\n\t"
+                    "jrcxz 4f\n"
+                    "3:\n\t"
+                    "mov (%[a]), %[t0]\n\t"
+                    "mov 8(%[a]), %[t1]\n\t"
+                    "sbb (%[b]), %[t0]\n\t"
+                    "sbb 8(%[b]), %[t1]\n\t"
+                    "mov %[t0], (%[r])\n\t"
+                    "mov %[t1], 8(%[r])\n\t"
+                    "mov 16(%[a]), %[t0]\n\t"
+                    "mov 24(%[a]), %[t1]\n\t"
+                    "sbb 16(%[b]), %[t0]\n\t"
+                    "sbb 24(%[b]), %[t1]\n\t"
+                    "mov %[t0], 16(%[r])\n\t"
+                    "mov %[t1], 24(%[r])\n\t"
+                    "lea 32(%[a]), %[a]\n\t"
+                    "lea 32(%[b]), %[b]\n\t"
+                    "lea 32(%[r]), %[r]\n\t"
+                    "dec %%rcx\n\t"
+                    "jnz 3b\n"
+                    "4:\n\t"
+                    "adc $0, %[borrow]"
+                    : [borrow] "=&r"(borrow), [t0] "=&r"(t0), [t1] "=&r"(t1), [a] "+r"(a), [b] "+r"(b), [r] "+r"(r)
+                    : [rest] "r"(rest), [blocks] "r"(blocks)
+                    : "rcx", "cc", "memory");
+            return borrow;
+        }
+        /* Two independent carry chains: mulx does not touch the flags, adcx adds the high limb
+           of the previous product through the carry flag and adox adds r[i] through the
+           overflow flag. Loop control uses lea and jrcxz, which leave both flags alone. The
+           first n % 4 limbs go through the portable loop. */
+        __attribute__((target("bmi2,adx"))) inline limb_t addmul_1_adx(limb_t *r, const limb_t *a, size_t n, limb_t b)
         {
-            for (uint64_t i = 1; i < x_.size(); i++)
+            const size_t rest = n % 4;
+            size_t blocks = n / 4;
+            limb_t carry = generic::addmul_1(r, a, rest, b);
+            if (blocks == 0)
             {
-                try
+                return carry;
+            }
+            r += rest;
+            a += rest;
+            limb_t lo, hi, zero;
+            __asm__("xor %k[zero], %k[zero]\n"
+                    "1:\n\t"
+                    "mulx (%[a]), %[lo], %[hi]\n\t"
+                    "adcx %[carry], %[lo]\n\t"
+                    "adox (%[r]), %[lo]\n\t"
+                    "mov %[lo], (%[r])\n\t"
+                    "mulx 8(%[a]), %[lo], %[carry]\n\t"
+                    "adcx %[hi], %[lo]\n\t"
+                    "adox 8(%[r]), %[lo]\n\t"
+                    "mov %[lo], 8(%[r])\n\t"
+                    "mulx 16(%[a]), %[lo], %[hi]\n\t"
+                    "adcx %[carry], %[lo]\n\t"
+                    "adox 16(%[r]), %[lo]\n\t"
+                    "mov %[lo], 16(%[r])\n\t"
+                    "mulx 24(%[a]), %[lo], %[carry]\n\t"
+                    "adcx %[hi], %[lo]\n\t"
+                    "adox 24(%[r]), %[lo]\n\t"
+                    "mov %[lo], 24(%[r])\n\t"
+                    "lea 32(%[a]), %[a]\n\t"
+                    "lea 32(%[r]), %[r]\n\t"
+                    "lea -1(%[blocks]), %[blocks]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n"
+                    "2:\n\t"
+                    "adcx %[zero], %[carry]\n\t"
+                    "adox %[zero], %[carry]"
+                    : [carry] "+&r"(carry), [lo] "=&r"(lo), [hi] "=&r"(hi), [zero] "=&r"(zero), [a] "+r"(a), [r] "+r"(r), [blocks] "+c"(blocks)
+                    : "d"(b)
+                    : "cc", "memory");
+            return carry;
+        }
+
+        /* The vector additions add all the lanes at once and then fix the carries between lanes
+           with integer arithmetic on lane masks: g marks the lanes whose sum wrapped (generate)
+           and p the lanes equal to all ones (propagate). The lanes that receive a carry are
+           ((g << 1 | carry) + p) ^ p, like in a carry-lookahead adder, and the bit above the
+           last lane is the carry out of the block. Subtraction is the same with borrows, the
+           propagating lanes being the zero ones. */
+        __attribute__((target("avx2"))) inline __m256i avx2_lane_mask(unsigned mask)
+        {
+            const __m256i bits = _mm256_setr_epi64x(1, 2, 4, 8);
+            return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(mask), bits), bits);
+        }
+        __attribute__((target("avx2"))) inline limb_t add_n_avx2(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            const __m256i sign = _mm256_set1_epi64x(INT64_MIN), ones = _mm256_set1_epi64x(-1);
+            unsigned carry = 0;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+                __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+                __m256i sum = _mm256_add_epi64(x, y);
+                __m256i wrapped = _mm256_cmpgt_epi64(_mm256_xor_si256(x, sign), _mm256_xor_si256(sum, sign));
+                unsigned g = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(wrapped));
+                unsigned p = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(sum, ones)));
+                unsigned c = (g << 1 | carry) + p;
+                /* Adding the all-ones lanes of the mask is subtracting -1. */
+                sum = _mm256_sub_epi64(sum, avx2_lane_mask((c ^ p) & 0xF));
+                _mm256_storeu_si256((__m256i *)(r + i), sum);
+                carry = c >> 4;
+            }
+            return generic::add_nc(r + i, a + i, b + i, n - i, carry);
+        }
+        __attribute__((target("avx2"))) inline limb_t sub_n_avx2(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            const __m256i sign = _mm256_set1_epi64x(INT64_MIN), zero = _mm256_setzero_si256();
+            unsigned borrow = 0;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+                __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+                __m256i difference = _mm256_sub_epi64(x, y);
+                __m256i wrapped = _mm256_cmpgt_epi64(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign));
+                unsigned g = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(wrapped));
+                unsigned p = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(difference, zero)));
+                unsigned c = (g << 1 | borrow) + p;
+                difference = _mm256_add_epi64(difference, avx2_lane_mask((c ^ p) & 0xF));
+                _mm256_storeu_si256((__m256i *)(r + i), difference);
+                borrow = c >> 4;
+            }
+            return generic::sub_nc(r + i, a + i, b + i, n - i, borrow);
+        }
+        __attribute__((target("avx2"))) inline int cmp_n_avx2(const limb_t *a, const limb_t *b, size_t n)
+        {
+            for (; n >= 4; n -= 4)
+            {
+                __m256i x = _mm256_loadu_si256((const __m256i *)(a + n - 4));
+                __m256i y = _mm256_loadu_si256((const __m256i *)(b + n - 4));
+                unsigned equal = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, y)));
+                if (equal != 0xF)
                 {
-                    stoi(string(1, x_[i]));
+                    size_t i = n - 4 + (size_t)(31 - __builtin_clz(~equal & 0xF));
+                    return a[i] < b[i] ? -1 : 1;
                 }
-                catch (const invalid_argument &e)
+            }
+            return generic::cmp_n(a, b, n);
+        }
+        __attribute__((target("avx2"))) inline size_t normalized_size_avx2(const limb_t *a, size_t n)
+        {
+            while (n >= 4)
+            {
+                __m256i x = _mm256_loadu_si256((const __m256i *)(a + n - 4));
+                if (!_mm256_testz_si256(x, x))
                 {
-                    throw invalid_argument("invalid integer");
+                    break;
                 }
+                n -= 4;
             }
+            return generic::normalized_size(a, n);
         }
-        else
+
+        __attribute__((target("avx512f"))) inline limb_t add_n_avx512(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
         {
-            for (uint64_t i = 0; i < x_.size(); i++)
+            const __m512i ones = _mm512_set1_epi64(-1), one = _mm512_set1_epi64(1);
+            unsigned carry = 0;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
             {
-                try
+                __m512i x = _mm512_loadu_si512(a + i), y = _mm512_loadu_si512(b + i);
+                __m512i sum = _mm512_add_epi64(x, y);
+                unsigned g = _mm512_cmplt_epu64_mask(sum, x);
+                unsigned p = _mm512_cmpeq_epu64_mask(sum, ones);
+                unsigned c = (g << 1 | carry) + p;
+                sum = _mm512_mask_add_epi64(sum, (__mmask8)(c ^ p), sum, one);
+                _mm512_storeu_si512(r + i, sum);
+                carry = c >> 8;
+            }
+            return generic::add_nc(r + i, a + i, b + i, n - i, carry);
+        }
+        __attribute__((target("avx512f"))) inline limb_t sub_n_avx512(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            const __m512i one = _mm512_set1_epi64(1);
+            unsigned borrow = 0;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m512i x = _mm512_loadu_si512(a + i), y = _mm512_loadu_si512(b + i);
+                __m512i difference = _mm512_sub_epi64(x, y);
+                unsigned g = _mm512_cmplt_epu64_mask(x, y);
+                unsigned p = _mm512_testn_epi64_mask(difference, difference);
+                unsigned c = (g << 1 | borrow) + p;
+                difference = _mm512_mask_sub_epi64(difference, (__mmask8)(c ^ p), difference, one);
+                _mm512_storeu_si512(r + i, difference);
+                borrow = c >> 8;
+            }
+            return generic::sub_nc(r + i, a + i, b + i, n - i, borrow);
+        }
+        __attribute__((target("avx512f"))) inline int cmp_n_avx512(const limb_t *a, const limb_t *b, size_t n)
+        {
+            for (; n >= 8; n -= 8)
+            {
+                __m512i x = _mm512_loadu_si512(a + n - 8), y = _mm512_loadu_si512(b + n - 8);
+                unsigned different = _mm512_cmpneq_epu64_mask(x, y);
+                if (different != 0)
                 {
-                    stoi(string(1, x_[i]));
+                    size_t i = n - 8 + (size_t)(31 - __builtin_clz(different));
+                    return a[i] < b[i] ? -1 : 1;
                 }
-                catch (const invalid_argument &e)
+            }
+            return generic::cmp_n(a, b, n);
+        }
+        __attribute__((target("avx512f"))) inline size_t normalized_size_avx512(const limb_t *a, size_t n)
+        {
+            while (n >= 8)
+            {
+                __m512i x = _mm512_loadu_si512(a + n - 8);
+                if (_mm512_test_epi64_mask(x, x) != 0)
                 {
-                    throw invalid_argument("invalid integer");
+                    break;
                 }
+                n -= 8;
             }
+            return generic::normalized_size(a, n);
         }
-        biginteger = x_;
     }
+#endif
+
     /**
-     * @brief Constructor initializing the bigint with a string.
+     * @brief One implementation of each kernel that has processor-specific variants.
+     */
+    struct kernel_table
+    {
+        const char *name;
+        limb_t (*add_n)(limb_t *r, const limb_t *a, const limb_t *b, size_t n);
+        limb_t (*sub_n)(limb_t *r, const limb_t *a, const limb_t *b, size_t n);
+        limb_t (*addmul_1)(limb_t *r, const limb_t *a, size_t n, limb_t b);
+        int (*cmp_n)(const limb_t *a, const limb_t *b, size_t n);
+        size_t (*normalized_size)(const limb_t *a, size_t n);
+    };
+    /**
+     * @brief Returns the kernel tables the processor can run.
      *
-     * @param a The string to initialize the bigint with.
-     * @note The implementation ensures proper handling of negative integers and
-     * performs input validation to ensure the integrity of the stored data. If string with an
-     * invalid integer is give, an invalid_argument error is thrown.
+     * @details The first table is the portable one and the last one is the fastest combination,
+     * the one in use. The tables in between hold the other variants, for newer instruction sets
+     * as they become available, so that every variant can be checked against the portable one:
+     * all the tables must give the same results.
      */
-    bigint(const string &x_)
+    inline vector<kernel_table> supported_kernels()
     {
-        set_string(x_);
+        kernel_table table = {"generic", generic::add_n, generic::sub_n, generic::addmul_1, generic::cmp_n,
+                              generic::normalized_size};
+        vector<kernel_table> tables = {table};
+#if defined(__x86_64__) && defined(__GNUC__)
+        __builtin_cpu_init();
+        table = {"x86-64", x86::add_n_adc, x86::sub_n_sbb, generic::addmul_1, generic::cmp_n, generic::normalized_size};
+        tables.push_back(table);
+        if (__builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx"))
+        {
+            table.name = "adx";
+            table.addmul_1 = x86::addmul_1_adx;
+            tables.push_back(table);
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            table.name = "avx2";
+            table.cmp_n = x86::cmp_n_avx2;
+            table.normalized_size = x86::normalized_size_avx2;
+            /* Fixing the carries between lanes costs more than the adc chain saves, so the
+               vector additions are only listed to be checked. */
+            kernel_table vector_add = table;
+            vector_add.name = "avx2 add/sub";
+            vector_add.add_n = x86::add_n_avx2;
+            vector_add.sub_n = x86::sub_n_avx2;
+            tables.push_back(vector_add);
+            tables.push_back(table);
+        }
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            table.name = "avx512";
+            table.cmp_n = x86::cmp_n_avx512;
+            table.normalized_size = x86::normalized_size_avx512;
+            tables.push_back(table);
+            kernel_table vector_add = table;
+            vector_add.name = "avx512 add/sub";
+            vector_add.add_n = x86::add_n_avx512;
+            vector_add.sub_n = x86::sub_n_avx512;
+            tables.push_back(vector_add);
+        }
+#endif
+        return tables;
     }
+    /* The kernels in use. They start as the portable ones, so they can be called during static
+       initialization, and are replaced by the best ones the processor supports at startup. */
+    inline kernel_table kernels = {"generic", generic::add_n, generic::sub_n, generic::addmul_1, generic::cmp_n,
+                                   generic::normalized_size};
+    inline const bool kernels_selected = (kernels = supported_kernels().back(), true);
+
     /**
-     * @brief Copy constructor creating a new bigint object from another bigint.
+     * @brief Computes r = a + b over n limbs.
      *
-     * @param other The bigint object to copy.
+     * @return The carry out of the most significant limb (0 or 1).
      */
-    bigint(const bigint &other) : biginteger(other.biginteger) {}
+    inline limb_t add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+    {
+        return kernels.add_n(r, a, b, n);
+    }
     /**
-     * @brief Assignment operator for bigint objects.
-     *
-     * @param a The bigint object to assign.
+     * @brief Computes r = a - b over n limbs.
      *
-     * @return Reference to the assigned bigint object.
+     * @return The borrow out of the most significant limb (0 or 1).
      */
-    bigint &operator=(const bigint &a);
+    inline limb_t sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+    {
+        return kernels.sub_n(r, a, b, n);
+    }
     /**
-     * @brief Overloaded assignment operator..
+     * @brief Computes r = r + a * b where a has n limbs and b is a single limb.
      *
-     * @param s The string that contains the integer to assign.
-     *
-     * @return Reference to the assigned bigint object.
+     * @return The limb carried out of r[n - 1].
      */
-    bigint &operator=(const string &s);
+    inline limb_t addmul_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        return kernels.addmul_1(r, a, n, b);
+    }
     /**
-     * @brief Assignment operator for bigint objects.
-     *
-     * @param i  The 64-bit integer to assign.
+     * @brief Compares two n-limb numbers.
      *
-     * @return Reference to the assigned bigint object.
+     * @return A negative value if a < b, zero if a == b and a positive value if a > b.
      */
-    bigint &operator=(const int64_t &i);
+    inline int cmp_n(const limb_t *a, const limb_t *b, size_t n)
+    {
+        return kernels.cmp_n(a, b, n);
+    }
     /**
-     * @brief Equality comparison operator for bigint objects.
-     *
-     * @param lhs The left-hand-side bigint object to compare.
-     *
-     * @param rhs The right-hand-side bigint object to compare.
-     *
-     * @details The objects are equal if their private data member storing the integer is the same.
-     *
-     * @return A boolean object, true if the objects are equal, false if the objects are not.
+     * @brief Returns the number of limbs of a once its most significant zero limbs are dropped.
      */
-    friend bool operator==(const bigint &lhs, const bigint &rhs);
+    inline size_t normalized_size(const limb_t *a, size_t n)
+    {
+        /* Most numbers are already normalized, which is checked without the indirect call. */
+        if (n == 0 || a[n - 1] != 0)
+        {
+            return n;
+        }
+        return kernels.normalized_size(a, n);
+    }
     /**
-     * @brief Less-than comparison operator for bigint objects.
-     *
-     * @param lhs The left-hand-side bigint object to compare.
-     *
-     * @param rhs The right-hand-side bigint object to compare.
-     *
-     * @details lhs is said to be less than rhs if the integer it represents is less than the integer
-     * rhs represents
+     * @brief Computes r = a + b where a has n limbs and b is a single limb.
      *
-     * @return A boolean object, true if lhs is less than rhs, false otherwise
+     * @return The carry out of the most significant limb (0 or 1).
      */
-    friend bool operator<(const bigint &lhs, const bigint &rhs);
+    inline limb_t add_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            limb_t s = a[i] + b;
+            b = s < b;
+            r[i] = s;
+        }
+        return b;
+    }
     /**
-     * @brief Addition assignment operator for bigint objects.
-     *
-     * @param x The left bigint.
-     *
-     * @param y The right side bigint.
+     * @brief Computes r = a - b where a has n limbs and b is a single limb.
      *
-     * @return Reference to the modified left-hand side bigint.
+     * @return The borrow out of the most significant limb (0 or 1).
      */
-    friend bigint &operator+=(bigint &x, bigint &y);
+    inline limb_t sub_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            limb_t ai = a[i];
+            r[i] = ai - b;
+            b = ai < b;
+        }
+        return b;
+    }
     /**
-     * @brief Unsigned addition operation for bigint instances.
-     *
-     * @param x The left-hand side bigint.
-     *
-     * @param y The right-hand side bigint.
+     * @brief Computes r = a * b where a has n limbs and b is a single limb.
      *
-     * @details This function has the basic algorithm for the summation of two integers. The result
-     * of the summation lhs+rhs is stored in lhs. Even though rhs is not defined as const due to the
-     * nature of the algorithm, it is not modified after the function implementation. This function
-     * is used on other basic functions of the class such ass +=,+,*=,* to optimize calculations and
-     * increase readability.
+     * @return The most significant limb of the product, which does not fit in r.
      */
-    friend void unsigned_sum(bigint &x, bigint &y);
+    inline limb_t mul_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        limb_t carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            dlimb_t p = (dlimb_t)a[i] * b + carry;
+            r[i] = (limb_t)p;
+            carry = (limb_t)(p >> 64);
+        }
+        return carry;
+    }
     /**
-     * @brief Unsigned subtraction operation for bigint instances.
+     * @brief Returns the reciprocal floor((B^2 - 1) / d) - B of a normalized limb d (top bit set).
      *
-     * @param x The left bigint.
-     *
-     * @param y The right bigint.
-     *
-     * @details This function has the basic algorithm for the subtraction of two integers.
-     * The result of the subtraction lhs-rhs is stored in lhs. Even though rhs is not defined as
-     * const due to the nature of the algorithm, it is not modified after the function implementation.
-     * This function is used on other basic functions of the class such ass -=,- to increase readability.
+     * @details With the reciprocal, dividing a two-limb number by d costs two multiplications
+     * instead of a hardware division (Moller and Granlund, "Improved division by invariant
+     * integers").
      */
-    friend void unsigned_subtraction(bigint &x, bigint &y);
+    constexpr limb_t reciprocal(limb_t d)
+    {
+        return (limb_t)((((dlimb_t)~d) << 64 | ~(limb_t)0) / d);
+    }
     /**
-     * @brief Subtraction assignment operator for bigint objects.
-     *
-     * @param x The left-hand side bigint.
-     *
-     * @param y The right-hand side bigint.
+     * @brief Divides u1 B + u0 by the normalized limb d, where u1 < d, using its reciprocal v.
      *
-     * @return Reference to the modified left-hand side bigint.
+     * @return The quotient limb; the remainder is stored in r.
      */
-    friend bigint &operator-=(bigint &x, bigint &y);
+    inline limb_t div2by1(limb_t &r, limb_t u1, limb_t u0, limb_t d, limb_t v)
+    {
+        dlimb_t q = (dlimb_t)v * u1 + (((dlimb_t)u1 << 64) | u0);
+        limb_t q1 = (limb_t)(q >> 64) + 1;
+        limb_t rem = u0 - q1 * d;
+        if (rem > (limb_t)q)
+        {
+            q1--;
+            rem += d;
+        }
+        if (rem >= d)
+        {
+            q1++;
+            rem -= d;
+        }
+        r = rem;
+        return q1;
+    }
     /**
-     * @brief Multiplication assignment operator for bigint objects.
-     *
-     * @param x The left-hand side bigint.
+     * @brief Divides the n-limb number a by the single limb d, storing the quotient in q.
      *
-     * @param y The right-hand side bigint.
+     * @details d is shifted so that its top bit is set, and the dividend is shifted on the fly,
+     * so every step is a div2by1 with a precomputed reciprocal. q may be the same as a.
      *
-     * @return Reference to the modified left-hand side bigint.
+     * @return The remainder of the division.
      */
-    friend bigint &operator*=(bigint &x, bigint &y);
+    inline limb_t divrem_1(limb_t *q, const limb_t *a, size_t n, limb_t d)
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        const unsigned shift = (unsigned)__builtin_clzll(d);
+        const limb_t dn = d << shift, v = reciprocal(dn);
+        limb_t rem = shift == 0 ? 0 : a[n - 1] >> (64 - shift);
+        for (size_t i = n; i-- > 0;)
+        {
+            limb_t u0 = a[i] << shift;
+            if (shift != 0 && i > 0)
+            {
+                u0 |= a[i - 1] >> (64 - shift);
+            }
+            q[i] = div2by1(rem, rem, u0, dn, v);
+        }
+        return rem >> shift;
+    }
     /**
-     * @brief A function that eliminates the left zeros of a bigint object.
-     * This is useful cause after a summation or subtraction operation some the result could be
-     * e.g. "002", this function then erase the left zeros of the result.
-     * @param a A reference to a bigint object
-     * @return The same bigint object
+     * @brief Compares two normalized numbers of possibly different sizes.
      */
-    bigint &erase_left_zeros();
+    inline int cmp(const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        if (an != bn)
+        {
+            return an < bn ? -1 : 1;
+        }
+        return cmp_n(a, b, an);
+    }
     /**
-     * @brief Output stream operator for bigint objects.
+     * @brief Computes r = r - a * b where a has n limbs and b is a single limb.
      *
-     * @param os The output stream.
-     * @param a The bigint to be output.
-     * @return Reference to the output stream.
+     * @return The limb borrowed from beyond r[n - 1].
      */
-    friend ostream &operator<<(ostream &out, const bigint &a);
+    inline limb_t submul_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        limb_t carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            dlimb_t p = (dlimb_t)a[i] * b + carry;
+            limb_t low = (limb_t)p, ri = r[i];
+            carry = (limb_t)(p >> 64) + (ri < low);
+            r[i] = ri - low;
+        }
+        return carry;
+    }
     /**
-     * @brief Negation operator for bigint objects.
+     * @brief Shifts the n-limb number a left by 0 < count < 64 bits into r.
      *
-     * @param a A copy of the bigint object
+     * @return The bits shifted out of the most significant limb, in the low bits of a limb.
+     */
+    inline limb_t lshift(limb_t *r, const limb_t *a, size_t n, unsigned count)
+    {
+        limb_t out = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            limb_t ai = a[i];
+            r[i] = (ai << count) | out;
+            out = ai >> (64 - count);
+        }
+        return out;
+    }
+    /**
+     * @brief Shifts the n-limb number a right by 0 < count < 64 bits into r.
      *
-     * @return The copy of the bigint object but with a minus sign.
+     * @return The bits shifted out of the least significant limb, in the high bits of a limb.
      */
-    friend bigint operator-(bigint a);
-
-private:
-    string biginteger = "0";
-};
-bigint &bigint::erase_left_zeros()
-{
-    if (biginteger.size() > 1)
+    inline limb_t rshift(limb_t *r, const limb_t *a, size_t n, unsigned count)
+    {
+        limb_t out = 0;
+        for (size_t i = n; i-- > 0;)
+        {
+            limb_t ai = a[i];
+            r[i] = (ai >> count) | out;
+            out = ai << (64 - count);
+        }
+        return out;
+    }
+    /**
+     * @brief Computes d = |a - b| where a has an limbs and b has bn <= an limbs.
+     *
+     * @return True if a < b, that is, if the difference is negative.
+     */
+    inline bool abs_diff(limb_t *d, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        if (normalized_size(a + bn, an - bn) > 0 || cmp_n(a, b, bn) >= 0)
+        {
+            limb_t borrow = sub_n(d, a, b, bn);
+            sub_1(d + bn, a + bn, an - bn, borrow);
+            return false;
+        }
+        sub_n(d, b, a, bn);
+        fill(d + bn, d + an, 0);
+        return true;
+    }
+    /**
+     * @brief Adds the n-limb number a into the rn-limb number r starting at limb offset.
+     *
+     * @details Limbs of a that fall beyond the end of r are ignored; callers only use this when
+     * the true result is known to fit in r.
+     */
+    inline void add_at(limb_t *r, size_t rn, size_t offset, const limb_t *a, size_t n)
+    {
+        n = min(n, rn - offset);
+        limb_t carry = add_n(r + offset, r + offset, a, n);
+        add_1(r + offset + n, r + offset + n, rn - offset - n, carry);
+    }
+    /**
+     * @brief Negates the n-limb two's complement number a in place.
+     */
+    inline void negate_n(limb_t *a, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            a[i] = ~a[i];
+        }
+        add_1(a, a, n, 1);
+    }
+    /**
+     * @brief Applies a bitwise operation to the two's complement forms of two numbers given in
+     * sign-magnitude form.
+     *
+     * @details a has an limbs and b has bn limbs, both normalized, and each is extended beyond
+     * its limbs with copies of its sign bit. The two's complement of a negative operand,
+     * ~(|a| - 1), and the magnitude of a negative result, ~r + 1, are formed on the fly with a
+     * running borrow and carry, so every operand limb is read once. The low n limbs of the result
+     * are computed, and the caller must choose n so that the limbs above are copies of the sign,
+     * which max(an, bn) always does. r has room for n + 1 limbs, the last one receiving the
+     * carry of the magnitude.
+     *
+     * @return True if the result is negative, r then holding its magnitude.
+     */
+    template <class Op>
+    inline bool bitwise_n(limb_t *r, size_t n, const limb_t *a, size_t an, bool a_negative, const limb_t *b,
+                          size_t bn, bool b_negative, Op op)
     {
-        for (size_t i = 0; i < biginteger.size(); i++)
+        if (!a_negative && !b_negative)
         {
-            if (biginteger[0] == '0')
+            /* The common case needs neither borrows nor carries, and the loop vectorizes. */
+            const size_t m = min(n, min(an, bn));
+            for (size_t i = 0; i < m; i++)
             {
-                biginteger.erase(0, 1);
+                r[i] = op(a[i], b[i]);
             }
-            else
+            for (size_t i = m; i < n; i++)
             {
-                break;
+                r[i] = op(i < an ? a[i] : 0, i < bn ? b[i] : 0);
             }
+            r[n] = 0;
+            return false;
+        }
+        const limb_t a_sign = a_negative ? ~(limb_t)0 : 0, b_sign = b_negative ? ~(limb_t)0 : 0;
+        const limb_t r_sign = op(a_sign, b_sign);
+        limb_t a_borrow = a_negative, b_borrow = b_negative, carry = r_sign & 1;
+        for (size_t i = 0; i < n; i++)
+        {
+            const limb_t ai = i < an ? a[i] : 0, bi = i < bn ? b[i] : 0;
+            const limb_t ri = (op((ai - a_borrow) ^ a_sign, (bi - b_borrow) ^ b_sign) ^ r_sign) + carry;
+            a_borrow &= ai == 0;
+            b_borrow &= bi == 0;
+            carry &= ri == 0;
+            r[i] = ri;
+        }
+        r[n] = carry;
+        return r_sign != 0;
+    }
+    /**
+     * @brief Tells whether the normalized n-limb number a is a power of two, 2^exponent.
+     *
+     * @details The most significant limb is checked first, so most numbers are rejected without
+     * reading the others.
+     */
+    inline bool power_of_two(const limb_t *a, size_t n, uint64_t &exponent)
+    {
+        if (n == 0 || (a[n - 1] & (a[n - 1] - 1)) != 0 || normalized_size(a, n - 1) != 0)
+        {
+            return false;
+        }
+        exponent = 64 * (uint64_t)(n - 1) + (uint64_t)countr_zero(a[n - 1]);
+        return true;
+    }
+    /**
+     * @brief Divides the n-limb two's complement number a by 3, assuming the division is exact.
+     *
+     * @details Uses Hensel (2-adic) division: each quotient limb is obtained by multiplying by the
+     * inverse of 3 modulo 2^64, so no actual division instruction is executed.
+     */
+    inline void divexact_by3(limb_t *r, const limb_t *a, size_t n)
+    {
+        const limb_t inverse = 0xAAAAAAAAAAAAAAABULL;
+        limb_t carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            limb_t ai = a[i];
+            limb_t l = ai - carry;
+            carry = ai < carry;
+            limb_t q = l * inverse;
+            r[i] = q;
+            carry += (limb_t)(((dlimb_t)q * 3) >> 64);
         }
     }
-    return *this;
-};
-bigint &bigint::operator=(const bigint &y)
-{
-    biginteger = y.biginteger;
-    return *this;
-}
-bigint &bigint::operator=(const string &s)
-{
-    set_string(s);
-    return *this;
-}
-bigint &bigint::operator=(const int64_t &i)
-{
-    biginteger = to_string(i);
-    return *this;
-}
 
-bool operator==(const bigint &lhs, const bigint &rhs)
-{
-    if (lhs.biginteger.size() != rhs.biginteger.size())
+    /* Tunable crossover points between the multiplication algorithms, see bigint::thresholds(). */
+    inline bigint_thresholds tuning;
+
+    /* Executor installed on the calling thread by bigint_parallel_scope, or by the task the
+       thread is running; nullptr runs everything on the calling thread. */
+    inline thread_local bigint_executor *scoped_executor = nullptr;
+
+    /* True if an operation on n limbs should split its work into parallel tasks. */
+    inline bool parallel_enabled(size_t n)
     {
-        return false;
+        return scoped_executor != nullptr && n >= tuning.parallel && scoped_executor->concurrency() > 1;
     }
-    for (size_t i = 0; i < lhs.biginteger.size(); i++)
+    /**
+     * @brief Runs the tasks, in parallel on the installed executor if there is one, and returns
+     * when all of them have finished.
+     *
+     * @details The first task runs on the calling thread and the others are submitted to the
+     * executor. The calling thread then runs every task that has not been started yet itself,
+     * and waits only for the ones already running on other threads, which also keeps nested
+     * calls from deadlocking. The installed executor is propagated to the tasks, so they can
+     * split their own work. The first exception thrown by a task is rethrown here.
+     */
+    inline void parallel_invoke(vector<function<void()>> tasks)
     {
-        if (lhs.biginteger[i] != rhs.biginteger[i])
+        bigint_executor *executor = scoped_executor;
+        if (executor == nullptr || tasks.size() < 2)
         {
-            return false;
+            for (function<void()> &task : tasks)
+            {
+                task();
+            }
+            return;
+        }
+        struct shared_task
+        {
+            function<void()> work;
+            /* 0 while pending, 1 while running, 2 once finished. */
+            atomic<int> state{0};
+            exception_ptr error;
+
+            bool claim()
+            {
+                int expected = 0;
+                return state.compare_exchange_strong(expected, 1);
+            }
+            void run(bigint_executor *executor)
+            {
+                bigint_executor *previous = scoped_executor;
+                scoped_executor = executor;
+                try
+                {
+                    work();
+                }
+                catch (...)
+                {
+                    error = current_exception();
+                }
+                scoped_executor = previous;
+                state.store(2, memory_order_release);
+                state.notify_all();
+            }
+        };
+        vector<shared_ptr<shared_task>> submitted;
+        for (size_t i = 1; i < tasks.size(); i++)
+        {
+            shared_ptr<shared_task> task = make_shared<shared_task>();
+            task->work = move(tasks[i]);
+            executor->submit([task, executor]
+                             {
+                                 if (task->claim())
+                                 {
+                                     task->run(executor);
+                                 } });
+            submitted.push_back(move(task));
+        }
+        exception_ptr error;
+        try
+        {
+            tasks[0]();
+        }
+        catch (...)
+        {
+            error = current_exception();
+        }
+        for (shared_ptr<shared_task> &task : submitted)
+        {
+            if (task->claim())
+            {
+                task->run(executor);
+            }
+            for (int state = task->state.load(memory_order_acquire); state != 2; state = task->state.load(memory_order_acquire))
+            {
+                task->state.wait(state);
+            }
+            if (task->error && !error)
+            {
+                error = task->error;
+            }
+        }
+        if (error)
+        {
+            rethrow_exception(error);
         }
     }
-    return true;
-}
-/**
- * @brief Inequality comparison operator for bigint instances.
- *
- * @details Checks whether two bigint instances are not equal.
- *
- * @param x The left-hand side bigint.
- * @param y The right-hand side bigint.
- * @return True if the bigints are not equal, false otherwise.
- */
-bool operator!=(const bigint &lhs, const bigint &rhs)
-{
-    return !(lhs == rhs);
-}
+    /**
+     * @brief Calls f(begin, end) on consecutive ranges covering [first, last), in parallel on
+     * the installed executor if there is one, with ranges of at least grain elements.
+     */
+    template <class F>
+    void parallel_for(size_t first, size_t last, size_t grain, const F &f)
+    {
+        if (scoped_executor == nullptr || last - first < 2 * grain)
+        {
+            f(first, last);
+            return;
+        }
+        const size_t ranges = (last - first) / grain;
+        vector<function<void()>> tasks;
+        for (size_t i = 0; i < ranges; i++)
+        {
+            const size_t begin = first + (last - first) * i / ranges, end = first + (last - first) * (i + 1) / ranges;
+            tasks.push_back([&f, begin, end]
+                            { f(begin, end); });
+        }
+        parallel_invoke(move(tasks));
+    }
+    /* Range size for parallel_for over n elements: about four ranges per thread. */
+    inline size_t parallel_grain(size_t n, size_t minimum)
+    {
+        const size_t threads = scoped_executor != nullptr ? scoped_executor->concurrency() : 1;
+        return max(minimum, n / (4 * threads));
+    }
 
-bool operator<(const bigint &x, const bigint &y)
-{
+    /* Memory resource installed on the calling thread by bigint_memory_scope, if any. */
+    inline thread_local pmr::memory_resource *scoped_resource = nullptr;
+    /* Memory resource limb buffers are allocated from: the one of the innermost
+       bigint_memory_scope of the thread, or else the default resource of the program. */
+    inline pmr::memory_resource *current_resource()
+    {
+        return scoped_resource != nullptr ? scoped_resource : pmr::get_default_resource();
+    }
+
+#ifdef BIGINT_INSTRUMENTATION
+    /**
+     * @brief The bigint_stats counters of one thread.
+     *
+     * @details Only the owning thread writes them, so an increment is a plain load and store;
+     * they are atomic so that snapshot() can read them from another thread. The counters of a
+     * thread are added to the retired totals when it exits.
+     */
+    struct thread_stats
+    {
+        atomic<uint64_t> calls[bigint_stats::operation_count] = {};
+        atomic<uint64_t> sizes[bigint_stats::operation_count][bigint_stats::size_buckets] = {};
+        atomic<uint64_t> dispatches[bigint_stats::algorithm_count] = {};
+        atomic<uint64_t> allocations{0}, deallocations{0}, bytes_allocated{0}, bytes_deallocated{0};
+        atomic<uint64_t> normalizations{0}, limbs_stripped{0};
+        /* Depth of nested operation_scope objects, so only the outermost operation counts. */
+        size_t depth = 0;
 
-    if (x.biginteger[0] == '-' && y.biginteger[0] != '-')
+        thread_stats();
+        ~thread_stats();
+        void add_to(bigint_stats &total) const;
+    };
+    struct stats_registry
     {
-        return true;
+        mutex lock;
+        vector<thread_stats *> threads;
+        bigint_stats retired, baseline;
+        atomic<bigint_stats::timing_callback *> callback{nullptr};
+        vector<unique_ptr<bigint_stats::timing_callback>> callbacks;
+    };
+    /* Never destroyed, so that threads exiting during the shutdown of the program can still
+       retire their counters. */
+    inline stats_registry &registry()
+    {
+        static stats_registry *instance = new stats_registry;
+        return *instance;
     }
-    else if (y.biginteger[0] == '-' && x.biginteger[0] != '-')
+    inline thread_stats::thread_stats()
     {
-        return false;
+        stats_registry &r = registry();
+        lock_guard<mutex> guard(r.lock);
+        r.threads.push_back(this);
     }
-    else
+    inline thread_stats::~thread_stats()
+    {
+        stats_registry &r = registry();
+        lock_guard<mutex> guard(r.lock);
+        add_to(r.retired);
+        r.threads.erase(find(r.threads.begin(), r.threads.end(), this));
+    }
+    inline void thread_stats::add_to(bigint_stats &total) const
     {
-        if (y.biginteger[0] == '-' && x.biginteger[0] == '-')
+        for (size_t i = 0; i < bigint_stats::operation_count; i++)
         {
-            if (x.biginteger.size() < y.biginteger.size())
+            total.calls[i] += calls[i].load(memory_order_relaxed);
+            for (size_t b = 0; b < bigint_stats::size_buckets; b++)
             {
-                return false;
+                total.sizes[i][b] += sizes[i][b].load(memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < bigint_stats::algorithm_count; i++)
+        {
+            total.dispatches[i] += dispatches[i].load(memory_order_relaxed);
+        }
+        total.allocations += allocations.load(memory_order_relaxed);
+        total.deallocations += deallocations.load(memory_order_relaxed);
+        total.bytes_allocated += bytes_allocated.load(memory_order_relaxed);
+        total.bytes_deallocated += bytes_deallocated.load(memory_order_relaxed);
+        total.normalizations += normalizations.load(memory_order_relaxed);
+        total.limbs_stripped += limbs_stripped.load(memory_order_relaxed);
+    }
+    inline thread_local thread_stats local_stats;
+    inline void bump(atomic<uint64_t> &counter, uint64_t n = 1)
+    {
+        counter.store(counter.load(memory_order_relaxed) + n, memory_order_relaxed);
+    }
+#endif
+
+    /* Hooks of bigint_stats; without BIGINT_INSTRUMENTATION they are empty and compile away. */
+    inline void count_algorithm([[maybe_unused]] bigint_stats::algorithm a)
+    {
+#ifdef BIGINT_INSTRUMENTATION
+        bump(local_stats.dispatches[(size_t)a]);
+#endif
+    }
+    inline void count_allocation([[maybe_unused]] size_t bytes)
+    {
+#ifdef BIGINT_INSTRUMENTATION
+        thread_stats &t = local_stats;
+        bump(t.allocations);
+        bump(t.bytes_allocated, bytes);
+#endif
+    }
+    inline void count_deallocation([[maybe_unused]] size_t bytes)
+    {
+#ifdef BIGINT_INSTRUMENTATION
+        thread_stats &t = local_stats;
+        bump(t.deallocations);
+        bump(t.bytes_deallocated, bytes);
+#endif
+    }
+    inline void count_normalization([[maybe_unused]] size_t stripped)
+    {
+#ifdef BIGINT_INSTRUMENTATION
+        thread_stats &t = local_stats;
+        bump(t.normalizations);
+        bump(t.limbs_stripped, stripped);
+#endif
+    }
+    /**
+     * @brief Counts an operation of bigint_stats for the lifetime of the object, and times it
+     * if a timing callback is installed. Operations started inside another are not counted.
+     */
+    class operation_scope
+    {
+    public:
+#ifdef BIGINT_INSTRUMENTATION
+        operation_scope(bigint_stats::operation op_, size_t limbs_) : stats(local_stats)
+        {
+            if (stats.depth++ != 0)
+            {
+                return;
             }
-            else if (y.biginteger.size() < x.biginteger.size())
+            const size_t i = (size_t)op_;
+            bump(stats.calls[i]);
+            bump(stats.sizes[i][bigint_stats::size_bucket(limbs_)]);
+            callback = registry().callback.load(memory_order_acquire);
+            if (callback != nullptr)
             {
-                return true;
+                op = op_;
+                limbs = limbs_;
+                start = chrono::steady_clock::now();
+            }
+        }
+        ~operation_scope()
+        {
+            stats.depth--;
+            if (callback != nullptr)
+            {
+                (*callback)(op, limbs, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start));
+            }
+        }
+#else
+        operation_scope(bigint_stats::operation, size_t) {}
+#endif
+        operation_scope(const operation_scope &) = delete;
+        operation_scope &operator=(const operation_scope &) = delete;
+
+#ifdef BIGINT_INSTRUMENTATION
+    private:
+        thread_stats &stats;
+        bigint_stats::timing_callback *callback = nullptr;
+        bigint_stats::operation op{};
+        size_t limbs = 0;
+        chrono::steady_clock::time_point start;
+#endif
+    };
+
+    /**
+     * @brief Vector of limbs with room for two limbs inside the object.
+     *
+     * @details Values up to 128 bits, which are most of the values in practice, are stored in
+     * the object itself and never touch the heap; larger values move to a heap buffer that grows
+     * geometrically. Only the operations the bigint class needs are provided, with the same
+     * meaning as for vector: new limbs are zero unless another value is given.
+     * Heap buffers come from current_resource() at the time they are allocated. The resource is
+     * remembered next to the pointer, in the space of the inline limbs, so each buffer goes back
+     * to the resource it came from.
+     *
+     * Heap buffers are shared on copy: the limb before the first one holds an atomic count of
+     * the vectors using the buffer, and a copy only increments it. The buffer is copied when a
+     * vector that shares it is about to be changed, that is, by the non-const accessors and by
+     * the operations that write limbs, and freed by the last vector that uses it. A buffer is
+     * only shared with a copy made while its resource is the current one, so that a copy made
+     * under a bigint_memory_scope of another resource, such as the copies that take a result out
+     * of a bigint_arena, still gets memory of its own. Vectors sharing a buffer can be read, copied
+     * and destroyed from several threads at once.
+     */
+    class limb_vector
+    {
+        static_assert(sizeof(atomic<size_t>) == sizeof(limb_t) && atomic<size_t>::is_always_lock_free);
+
+    public:
+        static constexpr size_t inline_capacity = 2;
+
+        limb_vector() {}
+        limb_vector(size_t n, limb_t value = 0)
+        {
+            resize(n, value);
+        }
+        limb_vector(const limb_t *first, const limb_t *last)
+        {
+            assign(first, last);
+        }
+        limb_vector(const limb_vector &other)
+        {
+            if (other.is_inline())
+            {
+                storage = other.storage;
+                length = other.length;
+            }
+            else if (shareable(other))
+            {
+                share(other);
             }
             else
             {
-                for (size_t i = 1; i < x.biginteger.size(); i++)
-                {
-                    if (stoi(string(1, x.biginteger[i])) < stoi(string(1, y.biginteger[i])))
-                    {
-                        return false;
-                    }
-                    else if (stoi(string(1, y.biginteger[i])) < stoi(string(1, x.biginteger[i])))
-                    {
-                        return true;
-                    }
-                    else
-                    {
-                        continue;
-                    }
-                }
+                assign(other.begin(), other.end());
             }
         }
-        else
+        limb_vector(limb_vector &&other) noexcept
+        {
+            steal(other);
+        }
+        ~limb_vector()
+        {
+            release();
+        }
+        limb_vector &operator=(const limb_vector &other)
         {
-            if (x.biginteger.size() < y.biginteger.size())
+            if (this == &other)
             {
-                return true;
+                return *this;
             }
-            else if (y.biginteger.size() < x.biginteger.size())
+            if (!is_inline() && !other.is_inline() && storage.remote.heap == other.storage.remote.heap)
             {
-                return false;
+                length = other.length;
+            }
+            else if (shareable(other))
+            {
+                release();
+                share(other);
             }
             else
             {
-                for (size_t i = 0; i < x.biginteger.size(); i++)
-                {
-                    if (stoi(string(1, x.biginteger[i])) < stoi(string(1, y.biginteger[i])))
-                    {
-                        return true;
-                    }
-                    else if (stoi(string(1, y.biginteger[i])) < stoi(string(1, x.biginteger[i])))
-                    {
-                        return false;
-                    }
-                    else
-                    {
-                        continue;
-                    }
-                }
+                assign(other.begin(), other.end());
             }
+            return *this;
         }
-    }
-    return false;
-}
-/**
- * @brief Bigger-than comparison operator for bigint objects.
- *
- * @param lhs The left-hand-side bigint object to compare.
- *
- * @param rhs The right-hand-side bigint object to compare.
- *
- * @details lhs is said to be greater than rhs if the integer it represents is bigger than the integer
- * rhs represents
- *
- * @return A boolean object, true if lhs is bigger than rhs, false otherwise
- */
-bool operator>(const bigint &lhs, const bigint &rhs)
+        limb_vector &operator=(limb_vector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                steal(other);
+            }
+            return *this;
+        }
+
+        size_t size() const { return length; }
+        size_t capacity() const { return allocated; }
+        bool empty() const { return length == 0; }
+        bool is_inline() const { return allocated == inline_capacity; }
+        limb_t *data()
+        {
+            if (is_inline())
+            {
+                return storage.local;
+            }
+            if (owners().load(memory_order_acquire) != 1)
+            {
+                unshare();
+            }
+            return storage.remote.heap;
+        }
+        const limb_t *data() const { return pointer(); }
+        limb_t *begin() { return data(); }
+        limb_t *end() { return data() + length; }
+        const limb_t *begin() const { return data(); }
+        const limb_t *end() const { return data() + length; }
+        limb_t &operator[](size_t i) { return data()[i]; }
+        const limb_t &operator[](size_t i) const { return data()[i]; }
+        limb_t &back() { return data()[length - 1]; }
+        const limb_t &back() const { return data()[length - 1]; }
+
+        void clear() { length = 0; }
+        void pop_back() { length--; }
+        void reserve(size_t n)
+        {
+            if (n > allocated)
+            {
+                grow(max(n, 2 * allocated));
+            }
+        }
+        void resize(size_t n, limb_t value = 0)
+        {
+            reserve(n);
+            if (n > length)
+            {
+                limb_t *p = data();
+                fill(p + length, p + n, value);
+            }
+            length = n;
+        }
+        void push_back(limb_t value)
+        {
+            reserve(length + 1);
+            data()[length++] = value;
+        }
+        void assign(size_t n, limb_t value)
+        {
+            length = 0;
+            resize(n, value);
+        }
+        void assign(const limb_t *first, const limb_t *last)
+        {
+            size_t n = (size_t)(last - first);
+            length = 0;
+            reserve(n);
+            copy(first, last, data());
+            length = n;
+        }
+
+    private:
+        struct remote_buffer
+        {
+            limb_t *heap;
+            pmr::memory_resource *resource;
+        };
+        union
+        {
+            limb_t local[inline_capacity];
+            remote_buffer remote;
+        } storage = {{0, 0}};
+        size_t length = 0;
+        size_t allocated = inline_capacity;
+
+        limb_t *pointer() { return is_inline() ? storage.local : storage.remote.heap; }
+        const limb_t *pointer() const { return is_inline() ? storage.local : storage.remote.heap; }
+        /* The count of the vectors using the heap buffer, in the limb before it. */
+        atomic<size_t> &owners() const
+        {
+            return *reinterpret_cast<atomic<size_t> *>(storage.remote.heap - 1);
+        }
+        /* Values that fit inline are copied, and so are the ones of another resource. */
+        static bool shareable(const limb_vector &other)
+        {
+            return other.length > inline_capacity && !other.is_inline() &&
+                   other.storage.remote.resource == current_resource();
+        }
+        void share(const limb_vector &other)
+        {
+            other.owners().fetch_add(1, memory_order_relaxed);
+            storage.remote = other.storage.remote;
+            length = other.length;
+            allocated = other.allocated;
+        }
+        /* Gives a vector that shares its buffer a copy of its own before its limbs are changed. */
+        [[gnu::noinline]] void unshare()
+        {
+            grow(allocated);
+        }
+        void grow(size_t n)
+        {
+            pmr::memory_resource *resource = current_resource();
+            limb_t *block = static_cast<limb_t *>(resource->allocate((n + 1) * sizeof(limb_t), alignof(limb_t)));
+            count_allocation((n + 1) * sizeof(limb_t));
+            new (block) atomic<size_t>(1);
+            limb_t *buffer = block + 1;
+            copy(pointer(), pointer() + length, buffer);
+            release();
+            storage.remote = {buffer, resource};
+            allocated = n;
+        }
+        void release()
+        {
+            if (!is_inline())
+            {
+                release_heap();
+                allocated = inline_capacity;
+            }
+        }
+        /* Kept out of line so that the destructor of an inline vector stays a single test. */
+        [[gnu::noinline]] void release_heap()
+        {
+            if (owners().fetch_sub(1, memory_order_acq_rel) == 1)
+            {
+                storage.remote.resource->deallocate(storage.remote.heap - 1, (allocated + 1) * sizeof(limb_t),
+                                                    alignof(limb_t));
+                count_deallocation((allocated + 1) * sizeof(limb_t));
+            }
+        }
+        void steal(limb_vector &other)
+        {
+            storage = other.storage;
+            length = other.length;
+            allocated = other.allocated;
+            other.length = 0;
+            other.allocated = inline_capacity;
+        }
+    };
+
+    /**
+     * @brief Schoolbook multiplication r = a * b, with an >= bn >= 1.
+     *
+     * @details r must have an + bn limbs and must not overlap a or b.
+     */
+    inline void mul_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        count_algorithm(bigint_stats::algorithm::mul_basecase);
+        r[an] = mul_1(r, a, an, b[0]);
+        for (size_t j = 1; j < bn; j++)
+        {
+            r[an + j] = addmul_1(r + j, a, an, b[j]);
+        }
+    }
+    /**
+     * @brief Schoolbook squaring r = a * a.
+     *
+     * @details Every cross product a[i] * a[j] with i < j is computed once and doubled, and the
+     * squares a[i] * a[i] are added afterwards, which halves the number of limb products of
+     * mul_basecase. r must have 2n limbs and must not overlap a.
+     */
+    inline void sqr_basecase(limb_t *r, const limb_t *a, size_t n)
+    {
+        count_algorithm(bigint_stats::algorithm::sqr_basecase);
+        fill(r, r + 2 * n, 0);
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+        }
+        lshift(r, r, 2 * n, 1);
+        limb_t carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            dlimb_t p = (dlimb_t)a[i] * a[i];
+            dlimb_t s = (dlimb_t)r[2 * i] + (limb_t)p + carry;
+            r[2 * i] = (limb_t)s;
+            s = (dlimb_t)r[2 * i + 1] + (limb_t)(p >> 64) + (limb_t)(s >> 64);
+            r[2 * i + 1] = (limb_t)s;
+            carry = (limb_t)(s >> 64);
+        }
+    }
+
+    /**
+     * @brief Arithmetic modulo one of the primes used by the number-theoretic transform.
+     *
+     * @details Residues are kept in Montgomery form x R mod p with R = 2^64, so a modular product
+     * costs two limb multiplications and no division. The primes are below 2^62, which leaves
+     * room for the sum of two residues in a limb.
+     */
+    struct ntt_prime
+    {
+        limb_t p;     /* The prime, of the form c 2^k + 1. */
+        limb_t p_inv; /* -p^-1 mod 2^64. */
+        limb_t r2;    /* R^2 mod p, used to convert into Montgomery form. */
+        limb_t g;     /* A primitive root modulo p. */
+
+        constexpr ntt_prime(limb_t p_, limb_t g_) : p(p_), p_inv(0), r2(0), g(g_)
+        {
+            /* Newton iteration doubles the number of correct low bits of the inverse each step. */
+            limb_t inverse = p;
+            for (int i = 0; i < 5; i++)
+            {
+                inverse *= 2 - p * inverse;
+            }
+            p_inv = 0 - inverse;
+            dlimb_t r = ((dlimb_t)1 << 64) % p;
+            r2 = (limb_t)(r * r % p);
+        }
+        /* Montgomery reduction of t < p R, returning t / R mod p. */
+        constexpr limb_t reduce(dlimb_t t) const
+        {
+            limb_t m = (limb_t)t * p_inv;
+            limb_t r = (limb_t)((t + (dlimb_t)m * p) >> 64);
+            return r >= p ? r - p : r;
+        }
+        constexpr limb_t mul(limb_t a, limb_t b) const
+        {
+            return reduce((dlimb_t)a * b);
+        }
+        constexpr limb_t add(limb_t a, limb_t b) const
+        {
+            limb_t s = a + b;
+            return s >= p ? s - p : s;
+        }
+        constexpr limb_t sub(limb_t a, limb_t b) const
+        {
+            return a >= b ? a - b : a + p - b;
+        }
+        /* Converts any limb, even one larger than p, into Montgomery form. */
+        constexpr limb_t to_montgomery(limb_t a) const
+        {
+            return reduce((dlimb_t)a * r2);
+        }
+        /* Raises a residue in Montgomery form to the power e. */
+        constexpr limb_t pow(limb_t a, limb_t e) const
+        {
+            limb_t result = to_montgomery(1);
+            for (; e > 0; e >>= 1, a = mul(a, a))
+            {
+                if (e & 1)
+                {
+                    result = mul(result, a);
+                }
+            }
+            return result;
+        }
+    };
+    /* Three primes of the form c 2^45 + 1 below 2^62. Their product exceeds 2^185, so any
+       coefficient of a product of two limb polynomials with up to 2^57 coefficients can be
+       recovered from its three residues. */
+    inline constexpr ntt_prime ntt_primes[3] = {
+        ntt_prime(0x3fffc00000000001ULL, 11),
+        ntt_prime(0x3ffac00000000001ULL, 3),
+        ntt_prime(0x3ff8a00000000001ULL, 10)};
+
+    /**
+     * @brief Fills roots[len + j] with w_{2 len}^j in Montgomery form for every power of two len < n.
+     *
+     * @details w_{2 len} is a primitive 2 len-th root of unity, or its inverse if inverse is set.
+     */
+    inline void ntt_roots(limb_t *roots, size_t n, const ntt_prime &m, bool inverse)
+    {
+        for (size_t len = 1; len < n; len <<= 1)
+        {
+            limb_t w = m.pow(m.to_montgomery(m.g), (m.p - 1) / (2 * len));
+            if (inverse)
+            {
+                w = m.pow(w, 2 * len - 1);
+            }
+            roots[len] = m.to_montgomery(1);
+            for (size_t j = 1; j < len; j++)
+            {
+                roots[len + j] = m.mul(roots[len + j - 1], w);
+            }
+        }
+    }
+    /**
+     * @brief Forward transform of length n (a power of two), leaving the output in bit-reversed order.
+     *
+     * @details Decimation-in-frequency (Gentleman-Sande) butterflies; paired with ntt_inverse,
+     * which takes bit-reversed input, no bit-reversal permutation is ever needed.
+     */
+    inline void ntt_forward(limb_t *a, size_t n, const limb_t *roots, const ntt_prime &prime)
+    {
+        /* A local copy, which the stores into a cannot alias, keeps the constants in registers. */
+        const ntt_prime m = prime;
+        for (size_t len = n / 2; len >= 1; len >>= 1)
+        {
+            for (size_t start = 0; start < n; start += 2 * len)
+            {
+                limb_t *x = a + start, *y = a + start + len;
+                for (size_t j = 0; j < len; j++)
+                {
+                    limb_t u = x[j], v = y[j];
+                    x[j] = m.add(u, v);
+                    y[j] = m.mul(m.sub(u, v), roots[len + j]);
+                }
+            }
+        }
+    }
+    /**
+     * @brief Inverse transform of length n taking bit-reversed input, without the 1/n scaling.
+     *
+     * @details Decimation-in-time (Cooley-Tukey) butterflies with the inverse roots.
+     */
+    inline void ntt_inverse(limb_t *a, size_t n, const limb_t *roots, const ntt_prime &prime)
+    {
+        /* A local copy, which the stores into a cannot alias, keeps the constants in registers. */
+        const ntt_prime m = prime;
+        for (size_t len = 1; len < n; len <<= 1)
+        {
+            for (size_t start = 0; start < n; start += 2 * len)
+            {
+                limb_t *x = a + start, *y = a + start + len;
+                for (size_t j = 0; j < len; j++)
+                {
+                    limb_t u = x[j], v = m.mul(y[j], roots[len + j]);
+                    x[j] = m.add(u, v);
+                    y[j] = m.sub(u, v);
+                }
+            }
+        }
+    }
+    /**
+     * @brief ntt_forward with the butterflies of each stage split into parallel tasks.
+     */
+    inline void ntt_forward_parallel(limb_t *a, size_t n, const limb_t *roots, const ntt_prime &m)
+    {
+        if (!parallel_enabled(n))
+        {
+            ntt_forward(a, n, roots, m);
+            return;
+        }
+        /* The first stage splits the transform into two independent halves. */
+        const size_t half = n / 2;
+        parallel_for(0, half, parallel_grain(half, 1024), [&](size_t first, size_t last)
+                     {
+                         for (size_t j = first; j < last; j++)
+                         {
+                             limb_t u = a[j], v = a[half + j];
+                             a[j] = m.add(u, v);
+                             a[half + j] = m.mul(m.sub(u, v), roots[half + j]);
+                         } });
+        parallel_invoke({[&]
+                         { ntt_forward_parallel(a, half, roots, m); },
+                         [&]
+                         { ntt_forward_parallel(a + half, half, roots, m); }});
+    }
+    /**
+     * @brief ntt_inverse with the butterflies of each stage split into parallel tasks.
+     */
+    inline void ntt_inverse_parallel(limb_t *a, size_t n, const limb_t *roots, const ntt_prime &m)
+    {
+        if (!parallel_enabled(n))
+        {
+            ntt_inverse(a, n, roots, m);
+            return;
+        }
+        /* The two halves are independent transforms, joined by the last stage. */
+        const size_t half = n / 2;
+        parallel_invoke({[&]
+                         { ntt_inverse_parallel(a, half, roots, m); },
+                         [&]
+                         { ntt_inverse_parallel(a + half, half, roots, m); }});
+        parallel_for(0, half, parallel_grain(half, 1024), [&](size_t first, size_t last)
+                     {
+                         for (size_t j = first; j < last; j++)
+                         {
+                             limb_t u = a[j], v = m.mul(a[half + j], roots[half + j]);
+                             a[j] = m.add(u, v);
+                             a[half + j] = m.sub(u, v);
+                         } });
+    }
+    /**
+     * @brief Multiplies a by b with number-theoretic transforms modulo three primes, an >= bn >= 1.
+     *
+     * @details Every limb is one coefficient of a polynomial; the cyclic convolution of the two
+     * polynomials is computed modulo each prime, and each coefficient of the product is rebuilt
+     * from its three residues with Garner's form of the Chinese remainder theorem. The carries
+     * between coefficients are propagated while writing r. The result is exact, so it is
+     * bit-identical to the one of the other algorithms. r must have an + bn limbs and must not
+     * overlap a or b. When a and b are the same number only one forward transform is done.
+     */
+    inline void mul_ntt(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        const bool square = a == b && an == bn;
+        count_algorithm(square ? bigint_stats::algorithm::sqr_ntt : bigint_stats::algorithm::mul_ntt);
+        const size_t coefficients = an + bn - 1;
+        size_t n = 1;
+        while (n < coefficients)
+        {
+            n <<= 1;
+        }
+        const bool parallel = parallel_enabled(n);
+        const size_t grain = parallel_grain(n, 1024);
+        /* Leaves in residues the coefficients of the product modulo the prime i; the other
+           buffers are work space of n limbs each. */
+        auto convolve = [&](auto prime, limb_vector &residue, limb_vector &other_buffer, limb_vector &roots, limb_vector &inverse_roots)
+        {
+            const ntt_prime &m = ntt_primes[prime];
+            residue.assign(n, 0);
+            limb_t *fa = residue.data(), *other = other_buffer.data();
+            ntt_roots(roots.data(), n, m, false);
+            ntt_roots(inverse_roots.data(), n, m, true);
+            parallel_for(0, an, grain, [&](size_t first, size_t last)
+                         {
+                             for (size_t j = first; j < last; j++)
+                             {
+                                 fa[j] = m.to_montgomery(a[j]);
+                             } });
+            ntt_forward_parallel(fa, n, roots.data(), m);
+            if (!square)
+            {
+                fill(other, other + n, 0);
+                parallel_for(0, bn, grain, [&](size_t first, size_t last)
+                             {
+                                 for (size_t j = first; j < last; j++)
+                                 {
+                                     other[j] = m.to_montgomery(b[j]);
+                                 } });
+                ntt_forward_parallel(other, n, roots.data(), m);
+            }
+            const limb_t *g = square ? fa : other;
+            parallel_for(0, n, grain, [&](size_t first, size_t last)
+                         {
+                             for (size_t j = first; j < last; j++)
+                             {
+                                 fa[j] = m.mul(fa[j], g[j]);
+                             } });
+            ntt_inverse_parallel(fa, n, inverse_roots.data(), m);
+            /* Multiplying the Montgomery form by the plain 1/n yields the plain coefficient. */
+            limb_t scale = m.pow(m.to_montgomery(n), m.p - 2);
+            scale = m.reduce(scale);
+            parallel_for(0, coefficients, grain, [&](size_t first, size_t last)
+                         {
+                             for (size_t j = first; j < last; j++)
+                             {
+                                 fa[j] = m.mul(fa[j], scale);
+                             } });
+        };
+        limb_vector residues[3];
+        if (parallel)
+        {
+            /* The three primes are independent, each with work space of its own. */
+            parallel_invoke({[&]
+                             {
+                                 limb_vector other(square ? 0 : n), roots(n), inverse_roots(n);
+                                 convolve(integral_constant<int, 0>(), residues[0], other, roots, inverse_roots);
+                             },
+                             [&]
+                             {
+                                 limb_vector other(square ? 0 : n), roots(n), inverse_roots(n);
+                                 convolve(integral_constant<int, 1>(), residues[1], other, roots, inverse_roots);
+                             },
+                             [&]
+                             {
+                                 limb_vector other(square ? 0 : n), roots(n), inverse_roots(n);
+                                 convolve(integral_constant<int, 2>(), residues[2], other, roots, inverse_roots);
+                             }});
+        }
+        else
+        {
+            limb_vector other(square ? 0 : n), roots(n), inverse_roots(n);
+            convolve(integral_constant<int, 0>(), residues[0], other, roots, inverse_roots);
+            convolve(integral_constant<int, 1>(), residues[1], other, roots, inverse_roots);
+            convolve(integral_constant<int, 2>(), residues[2], other, roots, inverse_roots);
+        }
+        const ntt_prime &m1 = ntt_primes[0], &m2 = ntt_primes[1], &m3 = ntt_primes[2];
+        /* Garner constants in Montgomery form, so that m.mul by them yields a plain residue. */
+        const limb_t p1_inv_mod_p2 = m2.pow(m2.to_montgomery(m1.p), m2.p - 2);
+        const limb_t p1_mod_p3 = m3.to_montgomery(m1.p);
+        const limb_t p1p2_inv_mod_p3 = m3.pow(m3.mul(p1_mod_p3, m3.to_montgomery(m2.p)), m3.p - 2);
+        const dlimb_t p1p2 = (dlimb_t)m1.p * m2.p;
+        const limb_t p1p2_low = (limb_t)p1p2, p1p2_high = (limb_t)(p1p2 >> 64);
+        /* Writes the coefficients [first, last) to r[first, last) and returns the two-limb carry
+           out of r[last - 1]. */
+        const limb_t *x1 = residues[0].data(), *x2 = residues[1].data(), *x3 = residues[2].data();
+        auto recombine = [&](size_t first, size_t last)
+        {
+            limb_t carry_low = 0, carry_high = 0;
+            for (size_t j = first; j < last; j++)
+            {
+                limb_t r1 = x1[j], r2 = x2[j], r3 = x3[j];
+                /* x = r1 + t2 p1 + t3 p1 p2 with t2 < p2 and t3 < p3. */
+                limb_t t2 = m2.mul(m2.sub(r2, r1 >= m2.p ? r1 - m2.p : r1), p1_inv_mod_p2);
+                limb_t x_mod_p3 = m3.add(r1 >= m3.p ? r1 - m3.p : r1, m3.mul(t2, p1_mod_p3));
+                limb_t t3 = m3.mul(m3.sub(r3, x_mod_p3), p1p2_inv_mod_p3);
+                dlimb_t low = (dlimb_t)t2 * m1.p + r1;
+                dlimb_t s0 = (dlimb_t)t3 * p1p2_low + (limb_t)low;
+                dlimb_t s1 = (dlimb_t)t3 * p1p2_high + (limb_t)(low >> 64) + (limb_t)(s0 >> 64);
+                dlimb_t u = (dlimb_t)(limb_t)s0 + carry_low;
+                r[j] = (limb_t)u;
+                u = (dlimb_t)(limb_t)s1 + carry_high + (limb_t)(u >> 64);
+                carry_low = (limb_t)u;
+                carry_high = (limb_t)(s1 >> 64) + (limb_t)(u >> 64);
+            }
+            return make_pair(carry_low, carry_high);
+        };
+        if (!parallel)
+        {
+            r[coefficients] = recombine(0, coefficients).first;
+            return;
+        }
+        /* Each chunk is recombined on its own; the carries out of the chunks, which are below
+           2^128, are then added into the following chunks from left to right. */
+        const size_t chunks = min<size_t>(4 * scoped_executor->concurrency(), coefficients / 2 + 1);
+        const size_t chunk_size = (coefficients + chunks - 1) / chunks;
+        vector<pair<limb_t, limb_t>> carries(chunks);
+        parallel_for(0, chunks, 1, [&](size_t first, size_t last)
+                     {
+                         for (size_t c = first; c < last; c++)
+                         {
+                             const size_t begin = min(c * chunk_size, coefficients);
+                             carries[c] = recombine(begin, min(begin + chunk_size, coefficients));
+                         } });
+        r[coefficients] = 0;
+        for (size_t c = 0; c < chunks; c++)
+        {
+            const limb_t carry[2] = {carries[c].first, carries[c].second};
+            add_at(r, coefficients + 1, min((c + 1) * chunk_size, coefficients), carry, 2);
+        }
+    }
+
+    inline void mul_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t *scratch);
+
+    /**
+     * @brief Sizes already computed by mul_n_scratch_size, kept on the stack so that computing
+     * a size allocates nothing.
+     *
+     * @details The pieces of one level of the recursion differ in size by a few limbs, so each
+     * level adds only a handful of entries. Should the table fill up, the remaining sizes are
+     * recomputed instead of stored.
+     */
+    struct scratch_size_memo
+    {
+        static constexpr size_t capacity = 256;
+        size_t operands[capacity];
+        size_t sizes[capacity];
+        size_t count = 0;
+    };
+    /**
+     * @brief Helper of mul_n_scratch_size, memoizing the sizes already visited.
+     */
+    inline size_t mul_n_scratch_size(size_t n, bool square, scratch_size_memo &memo)
+    {
+        size_t karatsuba = max<size_t>(square ? tuning.sqr_karatsuba : tuning.mul_karatsuba, 2);
+        size_t toom3 = max<size_t>(square ? tuning.sqr_toom3 : tuning.mul_toom3, 5);
+        size_t ntt = square ? tuning.sqr_ntt : tuning.mul_ntt;
+        if ((n < karatsuba && n < toom3) || n >= ntt)
+        {
+            return 0;
+        }
+        const size_t *found = find(memo.operands, memo.operands + memo.count, n);
+        if (found != memo.operands + memo.count)
+        {
+            return memo.sizes[found - memo.operands];
+        }
+        size_t size;
+        if (n < toom3)
+        {
+            size_t m = (n + 1) / 2;
+            size_t children = max(mul_n_scratch_size(m, square, memo), mul_n_scratch_size(n - m, square, memo));
+            size = 4 * m + max(children, 2 * m + 1);
+        }
+        else
+        {
+            size_t k = (n + 2) / 3;
+            size_t children = max(mul_n_scratch_size(k + 1, square, memo), mul_n_scratch_size(k, square, memo));
+            children = max(children, mul_n_scratch_size(n - 2 * k, square, memo));
+            size = 6 * (k + 2) + 5 * (2 * k + 2) + children;
+        }
+        if (memo.count < scratch_size_memo::capacity)
+        {
+            memo.operands[memo.count] = n;
+            memo.sizes[memo.count++] = size;
+        }
+        return size;
+    }
+    /**
+     * @brief Returns the number of scratch limbs mul_n needs for n-limb operands.
+     *
+     * @details Mirrors the recursion of mul_n, so it depends on the current thresholds. Nothing
+     * is allocated.
+     */
+    inline size_t mul_n_scratch_size(size_t n, bool square)
+    {
+        scratch_size_memo memo;
+        return mul_n_scratch_size(n, square, memo);
+    }
+    /**
+     * @brief mul_n with scratch space of its own, for the products that run as parallel tasks.
+     */
+    inline void mul_n_task(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+    {
+        limb_vector scratch(mul_n_scratch_size(n, a == b));
+        mul_n(r, a, b, n, scratch.data());
+    }
+    /**
+     * @brief Karatsuba multiplication of two n-limb numbers.
+     *
+     * @details Splits a = a0 + a1 B^m and b = b0 + b1 B^m and uses the three half-size products
+     * a0 b0, a1 b1 and (a0 - a1)(b0 - b1), so that a0 b1 + a1 b0 = a0 b0 + a1 b1 - (a0 - a1)(b0 - b1).
+     * When a and b are the same pointer only |a0 - a1| is computed and all products are squares.
+     */
+    inline void mul_karatsuba(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t *scratch)
+    {
+        const bool square = a == b;
+        count_algorithm(square ? bigint_stats::algorithm::sqr_karatsuba : bigint_stats::algorithm::mul_karatsuba);
+        const size_t m = (n + 1) / 2, h = n - m;
+        limb_t *da = scratch, *db = scratch + m, *t = scratch + 2 * m, *next = scratch + 4 * m;
+        bool negative = abs_diff(da, a, m, a + m, h);
+        if (!square)
+        {
+            negative ^= abs_diff(db, b, m, b + m, h);
+        }
+        else
+        {
+            negative = false;
+        }
+        if (parallel_enabled(n))
+        {
+            parallel_invoke({[&]
+                             { mul_n_task(r, a, b, m); },
+                             [&]
+                             { mul_n_task(r + 2 * m, a + m, square ? a + m : b + m, h); },
+                             [&]
+                             { mul_n_task(t, da, square ? da : db, m); }});
+        }
+        else
+        {
+            mul_n(r, a, b, m, next);
+            mul_n(r + 2 * m, a + m, square ? a + m : b + m, h, next);
+            mul_n(t, da, square ? da : db, m, next);
+        }
+        /* u = a0 b0 + a1 b1 -/+ |a0 - a1| |b0 - b1|, reusing the scratch of the recursive calls. */
+        limb_t *u = next;
+        copy(r, r + 2 * m, u);
+        u[2 * m] = 0;
+        add_at(u, 2 * m + 1, 0, r + 2 * m, 2 * h);
+        if (negative)
+        {
+            u[2 * m] += add_n(u, u, t, 2 * m);
+        }
+        else
+        {
+            u[2 * m] -= sub_n(u, u, t, 2 * m);
+        }
+        add_at(r, 2 * n, m, u, 2 * m + 1);
+    }
+    /**
+     * @brief Evaluates the three-way split of a at the points 1, -1 and -2 for Toom-3.
+     *
+     * @details The values are written as two's complement numbers of width k + 2 limbs in
+     * p1, pm1 and pm2; tmp must have room for 3 (k + 2) limbs.
+     */
+    inline void toom3_evaluate(limb_t *p1, limb_t *pm1, limb_t *pm2, const limb_t *a, size_t k, size_t s, limb_t *tmp)
+    {
+        const size_t e = k + 2;
+        limb_t *a0 = tmp, *a1 = tmp + e, *a2 = tmp + 2 * e;
+        fill(tmp, tmp + 3 * e, 0);
+        copy(a, a + k, a0);
+        copy(a + k, a + 2 * k, a1);
+        copy(a + 2 * k, a + 2 * k + s, a2);
+        add_n(pm1, a0, a2, e);
+        add_n(p1, pm1, a1, e);
+        sub_n(pm1, pm1, a1, e);
+        add_n(pm2, pm1, a2, e);
+        lshift(pm2, pm2, e, 1);
+        sub_n(pm2, pm2, a0, e);
+    }
+    /**
+     * @brief Multiplies two two's complement Toom-3 evaluations into a two's complement product.
+     *
+     * @details The operands are replaced by their absolute values, multiplied as unsigned
+     * numbers of k + 1 limbs and the sign is applied to the 2k + 2 limb product. A null scratch
+     * allocates the scratch space.
+     */
+    inline void toom3_pointwise(limb_t *v, limb_t *p, limb_t *q, size_t k, limb_t *scratch)
+    {
+        limb_vector own_scratch;
+        if (scratch == nullptr)
+        {
+            own_scratch.resize(mul_n_scratch_size(k + 1, p == q));
+            scratch = own_scratch.data();
+        }
+        const size_t e = k + 2;
+        bool negative = p[e - 1] >> 63;
+        if (negative)
+        {
+            negate_n(p, e);
+        }
+        if (q != p)
+        {
+            bool q_negative = q[e - 1] >> 63;
+            if (q_negative)
+            {
+                negate_n(q, e);
+            }
+            negative ^= q_negative;
+        }
+        else
+        {
+            negative = false;
+        }
+        mul_n(v, p, q, k + 1, scratch);
+        if (negative)
+        {
+            negate_n(v, 2 * k + 2);
+        }
+    }
+    /**
+     * @brief Toom-Cook 3-way multiplication of two n-limb numbers, n >= 5.
+     *
+     * @details Splits each operand into three pieces of k limbs, evaluates the resulting
+     * polynomials at 0, 1, -1, -2 and infinity, multiplies pointwise (five products of about n/3
+     * limbs instead of nine) and interpolates with Bodrato's sequence. The interpolation is done
+     * in two's complement, so the intermediate negative values need no special handling.
+     */
+    inline void mul_toom3(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t *scratch)
+    {
+        const bool square = a == b;
+        count_algorithm(square ? bigint_stats::algorithm::sqr_toom3 : bigint_stats::algorithm::mul_toom3);
+        const size_t k = (n + 2) / 3, s = n - 2 * k;
+        const size_t e = k + 2, w = 2 * k + 2;
+        limb_t *p1 = scratch, *pm1 = p1 + e, *pm2 = pm1 + e;
+        limb_t *q1 = pm2 + e, *qm1 = q1 + e, *qm2 = qm1 + e;
+        limb_t *v1 = qm2 + e, *vm1 = v1 + w, *vm2 = vm1 + w, *v0 = vm2 + w, *vinf = v0 + w;
+        limb_t *next = vinf + w;
+        /* The evaluation temporaries live in the product area, which is not in use yet. */
+        toom3_evaluate(p1, pm1, pm2, a, k, s, v1);
+        if (square)
+        {
+            q1 = p1, qm1 = pm1, qm2 = pm2;
+        }
+        else
+        {
+            toom3_evaluate(q1, qm1, qm2, b, k, s, v1);
+        }
+        if (parallel_enabled(n))
+        {
+            parallel_invoke({[&]
+                             { toom3_pointwise(v1, p1, q1, k, nullptr); },
+                             [&]
+                             { toom3_pointwise(vm1, pm1, qm1, k, nullptr); },
+                             [&]
+                             { toom3_pointwise(vm2, pm2, qm2, k, nullptr); },
+                             [&]
+                             { mul_n_task(r, a, b, k); },
+                             [&]
+                             { mul_n_task(r + 4 * k, a + 2 * k, b + 2 * k, s); }});
+        }
+        else
+        {
+            toom3_pointwise(v1, p1, q1, k, next);
+            toom3_pointwise(vm1, pm1, qm1, k, next);
+            toom3_pointwise(vm2, pm2, qm2, k, next);
+            mul_n(r, a, b, k, next);
+            mul_n(r + 4 * k, a + 2 * k, b + 2 * k, s, next);
+        }
+        fill(v0, v0 + 2 * w, 0);
+        copy(r, r + 2 * k, v0);
+        copy(r + 4 * k, r + 4 * k + 2 * s, vinf);
+        fill(r + 2 * k, r + 4 * k, 0);
+        /* Interpolation; r1, r2 and r3 end up in v1, vm1 and vm2. */
+        limb_t *r3 = vm2, *r1 = v1, *r2 = vm1;
+        sub_n(r3, vm2, v1, w);
+        divexact_by3(r3, r3, w);
+        sub_n(r1, v1, vm1, w);
+        limb_t sign = r1[w - 1] & (1ULL << 63);
+        rshift(r1, r1, w, 1);
+        r1[w - 1] |= sign;
+        sub_n(r2, vm1, v0, w);
+        sub_n(r3, r2, r3, w);
+        sign = r3[w - 1] & (1ULL << 63);
+        rshift(r3, r3, w, 1);
+        r3[w - 1] |= sign;
+        add_n(r3, r3, vinf, w);
+        add_n(r3, r3, vinf, w);
+        add_n(r2, r2, r1, w);
+        sub_n(r2, r2, vinf, w);
+        sub_n(r1, r1, r3, w);
+        add_at(r, 2 * n, k, r1, w);
+        add_at(r, 2 * n, 2 * k, r2, w);
+        add_at(r, 2 * n, 3 * k, r3, w);
+    }
+    /**
+     * @brief Multiplies two n-limb numbers, choosing the algorithm from the thresholds.
+     *
+     * @details Passing the same pointer for a and b selects the squaring variant of every
+     * algorithm. r must have 2n limbs and must not overlap a or b; scratch must have at least
+     * mul_n_scratch_size(n, a == b) limbs.
+     */
+    inline void mul_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t *scratch)
+    {
+        const bool square = a == b;
+        size_t karatsuba = max<size_t>(square ? tuning.sqr_karatsuba : tuning.mul_karatsuba, 2);
+        size_t toom3 = max<size_t>(square ? tuning.sqr_toom3 : tuning.mul_toom3, 5);
+        if (n >= (square ? tuning.sqr_ntt : tuning.mul_ntt))
+        {
+            mul_ntt(r, a, n, b, n);
+        }
+        else if (n < karatsuba && n < toom3)
+        {
+            if (square)
+            {
+                sqr_basecase(r, a, n);
+            }
+            else
+            {
+                mul_basecase(r, a, n, b, n);
+            }
+        }
+        else if (n < toom3)
+        {
+            mul_karatsuba(r, a, b, n, scratch);
+        }
+        else
+        {
+            mul_toom3(r, a, b, n, scratch);
+        }
+    }
+    /**
+     * @brief Returns the number of scratch limbs mul needs for operands of an >= bn limbs.
+     */
+    inline size_t mul_scratch_size(size_t an, size_t bn)
+    {
+        if ((bn < tuning.mul_karatsuba && bn < tuning.mul_toom3) || bn >= tuning.mul_ntt)
+        {
+            return 0;
+        }
+        if (an == bn)
+        {
+            return mul_n_scratch_size(bn, false);
+        }
+        size_t rest = an % bn;
+        size_t tail = rest == 0 ? 0 : mul_scratch_size(bn, rest);
+        return 2 * bn + max(mul_n_scratch_size(bn, false), tail);
+    }
+    /**
+     * @brief Multiplies a by b, where an >= bn >= 1, using caller-provided scratch space.
+     *
+     * @details Unbalanced operands are cut into bn-limb pieces of a, each multiplied by b with
+     * the balanced algorithms and accumulated into r. r must have an + bn limbs and must not
+     * overlap a or b; scratch must have mul_scratch_size(an, bn) limbs.
+     */
+    inline void mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, limb_t *scratch)
+    {
+        if (bn < tuning.mul_karatsuba && bn < tuning.mul_toom3)
+        {
+            mul_basecase(r, a, an, b, bn);
+            return;
+        }
+        if (an == bn)
+        {
+            mul_n(r, a, b, bn, scratch);
+            return;
+        }
+        if (bn >= tuning.mul_ntt)
+        {
+            mul_ntt(r, a, an, b, bn);
+            return;
+        }
+        limb_t *t = scratch, *next = scratch + 2 * bn;
+        mul_n(r, a, b, bn, next);
+        for (size_t offset = bn; offset < an; offset += bn)
+        {
+            size_t len = min(bn, an - offset);
+            if (len == bn)
+            {
+                mul_n(t, a + offset, b, bn, next);
+            }
+            else
+            {
+                mul(t, b, bn, a + offset, len, next);
+            }
+            copy(t + bn, t + bn + len, r + offset + bn);
+            add_at(r, an + bn, offset, t, bn);
+        }
+    }
+    /**
+     * @brief Multiplies a by b, where an >= bn >= 1, allocating the scratch space it needs.
+     *
+     * @details When a and b are the same number the squaring algorithms are used.
+     */
+    inline void mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        size_t size = a == b && an == bn ? mul_n_scratch_size(an, true) : mul_scratch_size(an, bn);
+        limb_vector scratch(size);
+        if (a == b && an == bn)
+        {
+            mul_n(r, a, a, an, scratch.data());
+        }
+        else
+        {
+            mul(r, a, an, b, bn, scratch.data());
+        }
+    }
+    /**
+     * @brief Schoolbook division (Knuth's algorithm D) of the nn-limb number n by the normalized
+     * dn-limb number d, nn >= dn >= 2.
+     *
+     * @details Each quotient limb is estimated from the top two limbs of the partial remainder
+     * and the top limb of d, refined with the second limb of d, which leaves it at most one too
+     * large, and corrected by adding d back when the subtraction goes negative. The nn - dn
+     * low quotient limbs are stored in q and the remainder replaces n[0..dn).
+     *
+     * @return The top quotient limb, 1 if the top dn limbs of n were not smaller than d and 0
+     * otherwise.
+     */
+    inline limb_t divrem_basecase(limb_t *q, limb_t *n, size_t nn, const limb_t *d, size_t dn)
+    {
+        count_algorithm(bigint_stats::algorithm::div_basecase);
+        limb_t qh = cmp_n(n + nn - dn, d, dn) >= 0;
+        if (qh)
+        {
+            sub_n(n + nn - dn, n + nn - dn, d, dn);
+        }
+        const limb_t d1 = d[dn - 1], d0 = d[dn - 2], v = reciprocal(d1);
+        for (size_t i = nn - dn; i-- > 0;)
+        {
+            limb_t n2 = n[i + dn], n1 = n[i + dn - 1], n0 = n[i + dn - 2];
+            limb_t qhat, rhat;
+            bool rhat_overflow = false;
+            if (n2 >= d1)
+            {
+                qhat = ~(limb_t)0;
+                rhat = n1 + d1;
+                rhat_overflow = rhat < n1;
+            }
+            else
+            {
+                qhat = div2by1(rhat, n2, n1, d1, v);
+            }
+            while (!rhat_overflow && (dlimb_t)qhat * d0 > (((dlimb_t)rhat << 64) | n0))
+            {
+                qhat--;
+                rhat += d1;
+                rhat_overflow = rhat < d1;
+            }
+            limb_t borrow = submul_1(n + i, d, dn, qhat);
+            if (n2 < borrow)
+            {
+                qhat--;
+                add_n(n + i, n + i, d, dn);
+            }
+            n[i + dn] = 0;
+            q[i] = qhat;
+        }
+        return qh;
+    }
+    /**
+     * @brief Divides the (dn + k)-limb window n by the normalized dn-limb number d, k <= dn,
+     * with Burnikel and Ziegler's recursion.
+     *
+     * @details When k < dn, the top 2k limbs of n are divided by the top k limbs of d, which
+     * costs a k-limb division instead of a dn-limb one, and the quotient, which can only be too
+     * large, is corrected by subtracting its product with the low dn - k limbs of d. When
+     * k == dn the quotient is computed in two halves of the previous kind. The cost is a small
+     * multiple of the one of a dn-limb multiplication. The k low quotient limbs are stored in
+     * q and the remainder replaces n[0..dn).
+     *
+     * @return The top quotient limb, as divrem_basecase.
+     */
+    inline limb_t divrem_window(limb_t *q, limb_t *n, const limb_t *d, size_t dn, size_t k)
+    {
+        const size_t threshold = max<size_t>(tuning.div_bz, 2);
+        if (k < threshold || dn < threshold)
+        {
+            return divrem_basecase(q, n, dn + k, d, dn);
+        }
+        count_algorithm(bigint_stats::algorithm::div_bz);
+        if (k == dn)
+        {
+            const size_t lo = k / 2, hi = k - lo;
+            limb_t qh = divrem_window(q + lo, n + lo, d, dn, hi);
+            divrem_window(q, n, d, dn, lo);
+            return qh;
+        }
+        limb_t qh = divrem_window(q, n + dn - k, d + dn - k, k, k);
+        limb_vector t(dn);
+        if (k >= dn - k)
+        {
+            mul(t.data(), q, k, d, dn - k);
+        }
+        else
+        {
+            mul(t.data(), d, dn - k, q, k);
+        }
+        limb_t borrow = sub_n(n, n, t.data(), dn);
+        if (qh)
+        {
+            borrow += sub_n(n + k, n + k, d, dn - k);
+        }
+        while (borrow != 0)
+        {
+            qh -= sub_1(q, q, k, 1);
+            borrow -= add_n(n, n, d, dn);
+        }
+        return qh;
+    }
+    /**
+     * @brief Computes q = a / d and r = a % d for an an-limb a and a normalized-size dn-limb d,
+     * with an >= dn >= 1 and d[dn - 1] != 0.
+     *
+     * @details Single-limb divisors use divrem_1. Otherwise both numbers are shifted so that
+     * the top bit of d is set, and the quotient is produced a block of dn limbs at a time,
+     * from the most significant block down, each block with divrem_window. q must have
+     * an - dn + 1 limbs and r must have dn limbs; neither may overlap the inputs.
+     */
+    inline void divrem(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *d, size_t dn)
+    {
+        if (dn == 1)
+        {
+            count_algorithm(bigint_stats::algorithm::divrem_1);
+            r[0] = divrem_1(q, a, an, d[0]);
+            return;
+        }
+        const unsigned shift = (unsigned)__builtin_clzll(d[dn - 1]);
+        limb_vector dp(d, d + dn), np(an + 1);
+        if (shift != 0)
+        {
+            lshift(dp.data(), d, dn, shift);
+            np[an] = lshift(np.data(), a, an, shift);
+        }
+        else
+        {
+            copy(a, a + an, np.begin());
+        }
+        /* The extra top limb of np is smaller than the top limb of dp, so every block of the
+           quotient fits in its limbs and the top quotient limbs returned are zero. */
+        const size_t qn = an + 1 - dn;
+        size_t k = qn % dn == 0 ? dn : qn % dn;
+        for (size_t i = qn; i > 0; k = dn)
+        {
+            i -= k;
+            divrem_window(q + i, np.data() + i, dp.data(), dn, k);
+        }
+        if (shift != 0)
+        {
+            rshift(r, np.data(), dn, shift);
+        }
+        else
+        {
+            copy(np.begin(), np.begin() + (ptrdiff_t)dn, r);
+        }
+    }
+    /**
+     * @brief Returns 5^(Digits 2^k) as a normalized limb vector.
+     *
+     * @details The decimal conversions split numbers at 10^(19 2^k) = 5^(19 2^k) 2^(19 2^k);
+     * the power of two is a plain shift, so only the power of five is stored, which makes the
+     * multiplications and divisions by it about 30% smaller. The powers are built lazily by
+     * repeated squaring and kept for the rest of the program, so every conversion after the
+     * first one of a given size reuses them. The cache is shared by all threads; a deque is used
+     * so that references to the powers already built stay valid while other threads extend it.
+     * decimal_bigint, whose limbs hold 18 digits, keeps its own powers with Digits = 18.
+     */
+    template <size_t Digits = decimal_base_digits>
+    inline const vector<limb_t> &five_power(size_t k)
+    {
+        static_assert(Digits >= 1 && Digits <= 27, "5^Digits must fit in a limb");
+        static deque<vector<limb_t>> powers;
+        static mutex powers_mutex;
+        lock_guard<mutex> lock(powers_mutex);
+        if (powers.empty())
+        {
+            limb_t five = 1;
+            for (size_t i = 0; i < Digits; i++)
+            {
+                five *= 5;
+            }
+            powers.push_back({five});
+        }
+        while (powers.size() <= k)
+        {
+            const vector<limb_t> &last = powers.back();
+            vector<limb_t> square(2 * last.size());
+            mul(square.data(), last.data(), last.size(), last.data(), last.size());
+            square.resize(normalized_size(square.data(), square.size()));
+            powers.push_back(move(square));
+        }
+        return powers[k];
+    }
+    /**
+     * @brief Returns true if the len characters at s are all decimal digits.
+     *
+     * @details Eight characters are checked at a time: a byte is a digit when its high nibble is
+     * 3 and adding 6 to it does not carry into the high nibble. The result is accumulated
+     * without branching on each character.
+     */
+    inline bool all_digits(const char *s, size_t len)
+    {
+        const uint64_t high = 0xF0F0F0F0F0F0F0F0ULL, zeros = 0x3030303030303030ULL;
+        const uint64_t sixes = 0x0606060606060606ULL;
+        uint64_t bad = 0;
+        size_t i = 0;
+        for (; i + 8 <= len; i += 8)
+        {
+            uint64_t chunk;
+            memcpy(&chunk, s + i, 8);
+            bad |= (chunk & high) ^ zeros;
+            bad |= ((chunk + sixes) & high) ^ zeros;
+        }
+        for (; i < len; i++)
+        {
+            bad |= (uint64_t)((unsigned char)(s[i] - '0') > 9);
+        }
+        return bad == 0;
+    }
+    /**
+     * @brief Returns the value of the len <= 19 decimal digits at s.
+     *
+     * @details Eight digits at a time are combined inside a single limb with three
+     * multiplications (SWAR), instead of one multiplication per digit.
+     */
+    inline limb_t parse_digits(const char *s, size_t len)
+    {
+        limb_t value = 0;
+        size_t i = 0;
+        if constexpr (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        {
+            for (; i + 8 <= len; i += 8)
+            {
+                uint64_t chunk;
+                memcpy(&chunk, s + i, 8);
+                chunk -= 0x3030303030303030ULL;
+                chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+                chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+                chunk = (chunk * 10000 + (chunk >> 32)) & 0xFFFFFFFFULL;
+                value = value * 100000000 + chunk;
+            }
+        }
+        for (; i < len; i++)
+        {
+            value = value * 10 + (limb_t)(s[i] - '0');
+        }
+        return value;
+    }
+    /**
+     * @brief Converts len decimal digits into limbs, 19 digits (one limb) at a time.
+     *
+     * @details Quadratic: for each 19-digit chunk the whole number is multiplied by 10^19.
+     */
+    inline void parse_decimal_basecase(limb_vector &out, const char *s, size_t len)
+    {
+        count_algorithm(bigint_stats::algorithm::parse_basecase);
+        out.clear();
+        out.reserve(len / decimal_base_digits + 2);
+        /* The first chunk takes the leftover digits so that every following chunk has exactly 19. */
+        size_t chunk = len % decimal_base_digits;
+        if (chunk == 0)
+        {
+            chunk = decimal_base_digits;
+        }
+        for (size_t i = 0; i < len; i += chunk, chunk = decimal_base_digits)
+        {
+            limb_t value = parse_digits(s + i, chunk);
+            limb_t carry = mul_1(out.data(), out.data(), out.size(), decimal_base);
+            carry += add_1(out.data(), out.data(), out.size(), value);
+            if (carry != 0)
+            {
+                out.push_back(carry);
+            }
+        }
+    }
+    /**
+     * @brief Computes out = high 10^D + low as (high 5^D) 2^D + low, where five is 5^D, for
+     * normalized high and low with low < 10^D. out must not be high or low.
+     */
+    inline void combine_power(limb_vector &out, const limb_vector &high, const limb_vector &low,
+                              const vector<limb_t> &five, size_t low_digits)
+    {
+        const size_t limb_shift = low_digits / 64;
+        const unsigned bit_shift = low_digits % 64;
+        limb_vector product(high.size() + five.size());
+        if (!high.empty())
+        {
+            if (high.size() >= five.size())
+            {
+                mul(product.data(), high.data(), high.size(), five.data(), five.size());
+            }
+            else
+            {
+                mul(product.data(), five.data(), five.size(), high.data(), high.size());
+            }
+        }
+        out.assign(limb_shift + product.size() + 1, 0);
+        if (bit_shift != 0)
+        {
+            out.back() = lshift(out.data() + limb_shift, product.data(), product.size(), bit_shift);
+        }
+        else
+        {
+            copy(product.begin(), product.end(), out.begin() + (ptrdiff_t)limb_shift);
+        }
+        add_at(out.data(), out.size(), 0, low.data(), low.size());
+        out.resize(normalized_size(out.data(), out.size()));
+    }
+    /**
+     * @brief Computes out = high 10^(19 2^k) + low with combine_power, for normalized high and
+     * low with low < 10^(19 2^k). out must not be high or low.
+     */
+    inline void combine_decimal(limb_vector &out, const limb_vector &high, const limb_vector &low, size_t k)
+    {
+        combine_power(out, high, low, five_power(k), decimal_base_digits << k);
+    }
+    /**
+     * @brief Converts len decimal digits into a normalized limb vector.
+     *
+     * @details Divide and conquer: the low 19 2^k digits, for the largest k that leaves some
+     * high digits, and the high digits are converted recursively and combined with
+     * combine_decimal, so the cost is dominated by a few large multiplications.
+     */
+    inline void parse_decimal(limb_vector &out, const char *s, size_t len)
+    {
+        if (len <= tuning.conversion_dc * decimal_base_digits)
+        {
+            parse_decimal_basecase(out, s, len);
+            out.resize(normalized_size(out.data(), out.size()));
+            return;
+        }
+        size_t k = 0;
+        while (decimal_base_digits << (k + 1) < len)
+        {
+            k++;
+        }
+        count_algorithm(bigint_stats::algorithm::parse_dc);
+        const size_t low_digits = decimal_base_digits << k;
+        limb_vector high, low;
+        if (parallel_enabled(len / 19))
+        {
+            parallel_invoke({[&]
+                             { parse_decimal(high, s, len - low_digits); },
+                             [&]
+                             { parse_decimal(low, s + len - low_digits, low_digits); }});
+        }
+        else
+        {
+            parse_decimal(high, s, len - low_digits);
+            parse_decimal(low, s + len - low_digits, low_digits);
+        }
+        combine_decimal(out, high, low, k);
+    }
+    /**
+     * @brief Writes the n-limb number a as exactly width decimal digits, padding with zeros on
+     * the left, by repeated division by 10^19. Quadratic; a is clobbered.
+     */
+    inline void print_decimal_basecase(char *out, size_t width, limb_t *a, size_t n)
+    {
+        count_algorithm(bigint_stats::algorithm::print_basecase);
+        char *end = out + width;
+        n = normalized_size(a, n);
+        while (n > 0)
+        {
+            limb_t chunk = divrem_1(a, a, n, decimal_base);
+            n = normalized_size(a, n);
+            for (size_t j = 0; j < decimal_base_digits && end > out; j++)
+            {
+                *--end = (char)('0' + chunk % 10);
+                chunk /= 10;
+            }
+        }
+        fill(out, end, '0');
+    }
+    /**
+     * @brief Splits the n-limb number a as a = q 10^D + r with 0 <= r < 10^D, where five is
+     * 5^D and n must be larger than D / 64.
+     *
+     * @details a >> D divided by 5^D gives q and the high part of r, the low D bits of a being
+     * the rest of r. q and r are not normalized.
+     */
+    inline void split_power(limb_vector &q, limb_vector &r, const limb_t *a, size_t n, const vector<limb_t> &five,
+                            size_t low_digits)
+    {
+        const size_t limb_shift = low_digits / 64;
+        const unsigned bit_shift = low_digits % 64;
+        limb_vector high(n - limb_shift);
+        if (bit_shift != 0)
+        {
+            rshift(high.data(), a + limb_shift, high.size(), bit_shift);
+        }
+        else
+        {
+            copy(a + limb_shift, a + n, high.begin());
+        }
+        size_t hn = normalized_size(high.data(), high.size());
+        q.clear();
+        r.assign(limb_shift + five.size() + 1, 0);
+        if (hn >= five.size())
+        {
+            q.resize(hn - five.size() + 1);
+            limb_vector r5(five.size());
+            divrem(q.data(), r5.data(), high.data(), hn, five.data(), five.size());
+            high = move(r5);
+        }
+        if (bit_shift != 0)
+        {
+            r.back() = lshift(r.data() + limb_shift, high.data(), min(high.size(), five.size()), bit_shift);
+            r[limb_shift] |= a[limb_shift] & ((1ULL << bit_shift) - 1);
+        }
+        else
+        {
+            copy(high.begin(), high.begin() + (ptrdiff_t)min(high.size(), five.size()), r.begin() + (ptrdiff_t)limb_shift);
+        }
+        copy(a, a + limb_shift, r.begin());
+    }
+    /**
+     * @brief Splits the n-limb number a as a = q 10^D + r with D = 19 2^k and 0 <= r < 10^D,
+     * with split_power and the cached 5^D, where n must be larger than D / 64.
+     */
+    inline void split_decimal(limb_vector &q, limb_vector &r, const limb_t *a, size_t n, size_t k)
+    {
+        split_power(q, r, a, n, five_power(k), decimal_base_digits << k);
+    }
+    /* Level k of the first split of an n-limb number by print_decimal: 19 2^k digits are
+       between a quarter and half of the digits of a. */
+    inline size_t print_split_level(size_t n)
+    {
+        size_t k = 0;
+        while ((size_t)4 << k <= n)
+        {
+            k++;
+        }
+        return k;
+    }
+    /**
+     * @brief Writes the n-limb number a as exactly width decimal digits, padding with zeros on
+     * the left.
+     *
+     * @details Divide and conquer: with D = 19 2^k digits, between a quarter and half of the
+     * digits of a, a = q 10^D + r is obtained with split_decimal. The low D digits come from r
+     * and the others from q, both converted recursively. The cost is a small multiple of one
+     * division of the size of a.
+     */
+    inline void print_decimal(char *out, size_t width, const limb_t *a, size_t n)
+    {
+        n = normalized_size(a, n);
+        if (n < max<size_t>(tuning.conversion_dc, 4))
+        {
+            limb_vector copy_of_a(a, a + n);
+            print_decimal_basecase(out, width, copy_of_a.data(), n);
+            return;
+        }
+        count_algorithm(bigint_stats::algorithm::print_dc);
+        const size_t k = print_split_level(n);
+        const size_t low_digits = decimal_base_digits << k;
+        limb_vector q, r;
+        split_decimal(q, r, a, n, k);
+        if (parallel_enabled(n))
+        {
+            parallel_invoke({[&]
+                             { print_decimal(out + width - low_digits, low_digits, r.data(), r.size()); },
+                             [&]
+                             { print_decimal(out, width - low_digits, q.data(), q.size()); }});
+        }
+        else
+        {
+            print_decimal(out + width - low_digits, low_digits, r.data(), r.size());
+            print_decimal(out, width - low_digits, q.data(), q.size());
+        }
+    }
+}
+
+inline const char *bigint_stats::name(operation op)
+{
+    static const char *const names[operation_count] = {"from_string", "to_string", "compare", "add", "sub",
+                                                       "mul", "addmul", "div", "pow", "powmod", "mulmod",
+                                                       "gcd", "root", "batch", "shift", "bitwise",
+                                                       "product", "prime"};
+    return (size_t)op < operation_count ? names[(size_t)op] : "unknown";
+}
+inline const char *bigint_stats::name(algorithm a)
+{
+    static const char *const names[algorithm_count] = {"mul_basecase", "sqr_basecase", "mul_karatsuba",
+                                                       "sqr_karatsuba", "mul_toom3", "sqr_toom3", "mul_ntt",
+                                                       "sqr_ntt", "divrem_1", "div_basecase", "div_bz",
+                                                       "parse_basecase", "parse_dc", "print_basecase",
+                                                       "print_dc", "gcd_lehmer", "gcd_hgcd", "sqrtrem",
+                                                       "reduce_barrett", "reduce_montgomery"};
+    return (size_t)a < algorithm_count ? names[(size_t)a] : "unknown";
+}
+inline bigint_stats bigint_stats::snapshot()
+{
+    bigint_stats total;
+#ifdef BIGINT_INSTRUMENTATION
+    bigint_detail::stats_registry &r = bigint_detail::registry();
+    lock_guard<mutex> guard(r.lock);
+    total = r.retired;
+    for (const bigint_detail::thread_stats *t : r.threads)
+    {
+        t->add_to(total);
+    }
+    /* Counters only grow, so subtracting the baseline in unsigned arithmetic is exact. */
+    for (size_t i = 0; i < operation_count; i++)
+    {
+        total.calls[i] -= r.baseline.calls[i];
+        for (size_t b = 0; b < size_buckets; b++)
+        {
+            total.sizes[i][b] -= r.baseline.sizes[i][b];
+        }
+    }
+    for (size_t i = 0; i < algorithm_count; i++)
+    {
+        total.dispatches[i] -= r.baseline.dispatches[i];
+    }
+    total.allocations -= r.baseline.allocations;
+    total.deallocations -= r.baseline.deallocations;
+    total.bytes_allocated -= r.baseline.bytes_allocated;
+    total.bytes_deallocated -= r.baseline.bytes_deallocated;
+    total.normalizations -= r.baseline.normalizations;
+    total.limbs_stripped -= r.baseline.limbs_stripped;
+#endif
+    return total;
+}
+inline void bigint_stats::reset()
+{
+#ifdef BIGINT_INSTRUMENTATION
+    bigint_detail::stats_registry &r = bigint_detail::registry();
+    lock_guard<mutex> guard(r.lock);
+    bigint_stats total = r.retired;
+    for (const bigint_detail::thread_stats *t : r.threads)
+    {
+        t->add_to(total);
+    }
+    r.baseline = total;
+#endif
+}
+inline void bigint_stats::set_timing_callback([[maybe_unused]] timing_callback callback)
+{
+#ifdef BIGINT_INSTRUMENTATION
+    bigint_detail::stats_registry &r = bigint_detail::registry();
+    lock_guard<mutex> guard(r.lock);
+    if (!callback)
+    {
+        r.callback.store(nullptr, memory_order_release);
+        return;
+    }
+    r.callbacks.push_back(make_unique<timing_callback>(move(callback)));
+    r.callback.store(r.callbacks.back().get(), memory_order_release);
+#endif
+}
+
+/**
+ * @brief Installs a memory resource for the limb buffers allocated by the calling thread.
+ *
+ * @details While the scope is alive every limb buffer allocated by the thread, for the values
+ * of bigint objects as well as for the scratch space of multiplication, division and
+ * conversion, comes from the given resource. Scopes nest; the previous resource is restored
+ * when the scope ends. Outside of any scope pmr::get_default_resource() is used, so
+ * pmr::set_default_resource() changes the allocator of the whole program. Each buffer is
+ * returned to the resource it came from, so bigint objects can be freely mixed.
+ */
+class bigint_memory_scope
+{
+public:
+    explicit bigint_memory_scope(pmr::memory_resource *resource) : previous(bigint_detail::scoped_resource)
+    {
+        bigint_detail::scoped_resource = resource;
+    }
+    ~bigint_memory_scope()
+    {
+        bigint_detail::scoped_resource = previous;
+    }
+    bigint_memory_scope(const bigint_memory_scope &) = delete;
+    bigint_memory_scope &operator=(const bigint_memory_scope &) = delete;
+
+private:
+    pmr::memory_resource *previous;
+};
+
+/**
+ * @brief Arena for a batch of computations on one thread, freed all at once.
+ *
+ * @details Limb buffers are carved one after the other from large blocks, and freeing one does
+ * nothing: all the memory goes away with the arena. The arena is installed on the thread that
+ * creates it for its whole lifetime, like a bigint_memory_scope. Every bigint that got a buffer
+ * from the arena must be destroyed before it; a result that must survive the batch is copied
+ * into an object created inside a bigint_memory_scope of another resource.
+ */
+class bigint_arena
+{
+public:
+    /**
+     * @brief Creates the arena and installs it on the calling thread.
+     *
+     * @param initial_size Size in bytes of the first block; each further block is larger.
+     */
+    explicit bigint_arena(size_t initial_size = 64 * 1024) : blocks(initial_size), scope(&blocks) {}
+    /**
+     * @brief The memory resource of the arena, to install it again with a bigint_memory_scope.
+     */
+    pmr::memory_resource *resource()
+    {
+        return &blocks;
+    }
+
+private:
+    pmr::monotonic_buffer_resource blocks;
+    bigint_memory_scope scope;
+};
+
+/**
+ * @brief Memory resource that keeps freed limb buffers in per-thread lists by size class.
+ *
+ * @details Requests are rounded up to a power of two between 32 bytes and 1 MB, and a freed
+ * buffer goes to the list of its size class of the freeing thread, from where the next request
+ * of that class on the thread takes it, without locking and without going back to malloc.
+ * Each list keeps at most max_cached buffers, and the lists are emptied when their thread
+ * exits. Larger requests go straight to the global heap. All the instances share the same
+ * per-thread lists, so any instance can free a buffer allocated by another one; installing it
+ * with pmr::set_default_resource() makes every bigint use it.
+ */
+class bigint_pool_resource : public pmr::memory_resource
+{
+public:
+    static constexpr size_t min_block = 32;
+    static constexpr size_t size_classes = 16;
+    static constexpr size_t max_cached = 64;
+
+private:
+    struct cache
+    {
+        vector<void *> free_blocks[size_classes];
+        ~cache()
+        {
+            for (size_t c = 0; c < size_classes; c++)
+            {
+                for (void *block : free_blocks[c])
+                {
+                    pmr::new_delete_resource()->deallocate(block, min_block << c, alignof(max_align_t));
+                }
+            }
+            destroyed = true;
+        }
+        static inline thread_local bool destroyed = false;
+    };
+    /* The lists of the calling thread, or null while the thread is being torn down. */
+    static cache *local_cache()
+    {
+        if (cache::destroyed)
+        {
+            return nullptr;
+        }
+        thread_local cache lists;
+        return &lists;
+    }
+    static size_t size_class(size_t bytes)
+    {
+        size_t c = 0;
+        while ((min_block << c) < bytes)
+        {
+            c++;
+        }
+        return c;
+    }
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        const size_t c = size_class(bytes);
+        if (c >= size_classes || alignment > alignof(max_align_t))
+        {
+            return pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        cache *lists = local_cache();
+        if (lists != nullptr && !lists->free_blocks[c].empty())
+        {
+            void *block = lists->free_blocks[c].back();
+            lists->free_blocks[c].pop_back();
+            return block;
+        }
+        return pmr::new_delete_resource()->allocate(min_block << c, alignof(max_align_t));
+    }
+    void do_deallocate(void *block, size_t bytes, size_t alignment) override
+    {
+        const size_t c = size_class(bytes);
+        if (c >= size_classes || alignment > alignof(max_align_t))
+        {
+            pmr::new_delete_resource()->deallocate(block, bytes, alignment);
+            return;
+        }
+        cache *lists = local_cache();
+        if (lists != nullptr && lists->free_blocks[c].size() < max_cached)
+        {
+            lists->free_blocks[c].push_back(block);
+            return;
+        }
+        pmr::new_delete_resource()->deallocate(block, min_block << c, alignof(max_align_t));
+    }
+    bool do_is_equal(const pmr::memory_resource &other) const noexcept override
+    {
+        return dynamic_cast<const bigint_pool_resource *>(&other) != nullptr;
+    }
+};
+
+/**
+ * @brief Work-stealing thread pool implementing bigint_executor.
+ *
+ * @details Every worker thread has its own queue of tasks. The tasks a worker submits, which
+ * are the subproblems of the task it is running, go to the back of its own queue and it takes
+ * its next task from there, so it keeps working on the data it just touched. A worker whose
+ * queue is empty steals from the front of the queue of another worker, where the oldest and
+ * largest tasks are. Tasks submitted by other threads are spread over the queues in turn.
+ */
+class bigint_thread_pool : public bigint_executor
+{
+public:
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threads Number of worker threads; 0 uses one per hardware thread.
+     */
+    explicit bigint_thread_pool(size_t threads = 0)
+    {
+        if (threads == 0)
+        {
+            threads = max<size_t>(thread::hardware_concurrency(), 1);
+        }
+        for (size_t i = 0; i < threads; i++)
+        {
+            queues.push_back(make_unique<worker_queue>());
+        }
+        for (size_t i = 0; i < threads; i++)
+        {
+            workers.emplace_back([this, i]
+                                 { work(i); });
+        }
+    }
+    bigint_thread_pool(const bigint_thread_pool &) = delete;
+    bigint_thread_pool &operator=(const bigint_thread_pool &) = delete;
+    /**
+     * @brief Stops the worker threads once the queued tasks have run.
+     */
+    ~bigint_thread_pool()
+    {
+        {
+            lock_guard<mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread &worker : workers)
+        {
+            worker.join();
+        }
+    }
+    void submit(function<void()> task) override
+    {
+        size_t index = current_pool == this ? current_index : next_queue.fetch_add(1) % queues.size();
+        {
+            lock_guard<mutex> lock(queues[index]->lock);
+            queues[index]->tasks.push_back(move(task));
+        }
+        {
+            lock_guard<mutex> lock(sleep_mutex);
+            queued++;
+        }
+        wake.notify_one();
+    }
+    size_t concurrency() const override
+    {
+        return workers.size();
+    }
+
+private:
+    struct worker_queue
+    {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+    vector<unique_ptr<worker_queue>> queues;
+    vector<thread> workers;
+    atomic<size_t> next_queue{0};
+    /* Number of tasks in the queues, and the stop flag; the idle workers sleep on wake. */
+    mutex sleep_mutex;
+    condition_variable wake;
+    size_t queued = 0;
+    bool stopping = false;
+    /* The pool and the index of the worker running on this thread, if it is one. */
+    static inline thread_local bigint_thread_pool *current_pool = nullptr;
+    static inline thread_local size_t current_index = 0;
+
+    /* Takes the newest task of queue index, or else the oldest task of another queue. */
+    bool take(size_t index, function<void()> &task)
+    {
+        for (size_t i = 0; i < queues.size(); i++)
+        {
+            worker_queue &queue = *queues[(index + i) % queues.size()];
+            lock_guard<mutex> lock(queue.lock);
+            if (!queue.tasks.empty())
+            {
+                if (i == 0)
+                {
+                    task = move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                }
+                else
+                {
+                    task = move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+    void work(size_t index)
+    {
+        current_pool = this;
+        current_index = index;
+        for (;;)
+        {
+            {
+                unique_lock<mutex> lock(sleep_mutex);
+                wake.wait(lock, [this]
+                          { return stopping || queued > 0; });
+                if (queued == 0)
+                {
+                    return;
+                }
+                queued--;
+            }
+            /* A task was counted, so some queue holds one until it is taken. */
+            function<void()> task;
+            while (!take(index, task))
+            {
+                this_thread::yield();
+            }
+            task();
+        }
+    }
+};
+
+/**
+ * @brief Runs the large multiplications and conversions of the calling thread in parallel.
+ *
+ * @details While the scope is alive, multiplications, squarings and decimal conversions of at
+ * least bigint::thresholds().parallel limbs started by the thread split their independent
+ * subproblems (the products of Karatsuba and Toom-3, the transforms and butterflies of the
+ * NTT, the halves of the conversions) into tasks for the executor. The results are exactly
+ * those of the sequential algorithms, whatever the number of threads. Scopes nest; the
+ * previous executor is restored when the scope ends. The tasks that run on other threads
+ * allocate from the memory resource of those threads, not from a bigint_memory_scope or
+ * bigint_arena of the calling thread.
+ */
+class bigint_parallel_scope
+{
+public:
+    /**
+     * @brief Uses an existing executor, which must outlive the scope.
+     */
+    explicit bigint_parallel_scope(bigint_executor &executor) : previous(bigint_detail::scoped_executor)
+    {
+        bigint_detail::scoped_executor = &executor;
+    }
+    /**
+     * @brief Uses a bigint_thread_pool of its own with the given number of threads, 0 for one
+     * per hardware thread.
+     */
+    explicit bigint_parallel_scope(size_t threads)
+        : pool(make_unique<bigint_thread_pool>(threads)), previous(bigint_detail::scoped_executor)
+    {
+        bigint_detail::scoped_executor = pool.get();
+    }
+    bigint_parallel_scope(const bigint_parallel_scope &) = delete;
+    bigint_parallel_scope &operator=(const bigint_parallel_scope &) = delete;
+    ~bigint_parallel_scope()
+    {
+        bigint_detail::scoped_executor = previous;
+    }
+
+private:
+    unique_ptr<bigint_thread_pool> pool;
+    bigint_executor *previous;
+};
+
+/**
+ * @brief Arithmetic on caller-owned arrays of limbs, for code that keeps its numbers in its own
+ * containers.
+ *
+ * @details These are the kernels used by bigint, without the objects: a number is a span of
+ * 64-bit limbs, least significant first, and every result is written into a span given by the
+ * caller, of which only the first limbs are written. Nothing is allocated, except by mul and
+ * sqr above the NTT thresholds, whose transforms need buffers of their own, and by the
+ * parallel multiplications under a bigint_parallel_scope; both use the resource of the
+ * current bigint_memory_scope. Operands need not be normalized. Sizes are checked, and an
+ * invalid_argument is thrown when a span is too short; overlaps are not checked. An output
+ * may be the same span as an input only where the function says so, and must not otherwise
+ * overlap one. The results can be wrapped in a bigint_view, once normalized_size has dropped
+ * their most significant zero limbs.
+ */
+namespace bigint_mpn
+{
+    using limb_t = bigint_detail::limb_t;
+
+    /**
+     * @brief Throws an invalid_argument if a span is shorter than the function needs.
+     */
+    inline void check_size(bool fits)
+    {
+        if (!fits)
+        {
+            throw invalid_argument("limb span too short");
+        }
+    }
+    /**
+     * @brief Returns the number of limbs of a once its most significant zero limbs are dropped.
+     */
+    inline size_t normalized_size(span<const limb_t> a)
+    {
+        return bigint_detail::normalized_size(a.data(), a.size());
+    }
+    /**
+     * @brief Compares two numbers of the same number of limbs.
+     *
+     * @return A negative value if a < b, zero if a == b and a positive value if a > b.
+     */
+    inline int cmp(span<const limb_t> a, span<const limb_t> b)
+    {
+        check_size(a.size() == b.size());
+        return bigint_detail::cmp_n(a.data(), b.data(), a.size());
+    }
+    /**
+     * @brief Computes r = a + b, where a and b have the same number n of limbs, into the first
+     * n limbs of r. r may be a or b.
+     *
+     * @return The carry out of the most significant limb (0 or 1).
+     */
+    inline limb_t add_n(span<limb_t> r, span<const limb_t> a, span<const limb_t> b)
+    {
+        check_size(a.size() == b.size() && r.size() >= a.size());
+        return bigint_detail::add_n(r.data(), a.data(), b.data(), a.size());
+    }
+    /**
+     * @brief Computes r = a - b, where a and b have the same number n of limbs, into the first
+     * n limbs of r. r may be a or b.
+     *
+     * @return The borrow out of the most significant limb (0 or 1); it is 1 when a < b, and r
+     * then holds a - b + 2^(64 n).
+     */
+    inline limb_t sub_n(span<limb_t> r, span<const limb_t> a, span<const limb_t> b)
+    {
+        check_size(a.size() == b.size() && r.size() >= a.size());
+        return bigint_detail::sub_n(r.data(), a.data(), b.data(), a.size());
+    }
+    /**
+     * @brief Computes r = a + b, where b is a single limb. r may be a.
+     *
+     * @return The carry out of the most significant limb of a (0 or 1).
+     */
+    inline limb_t add_1(span<limb_t> r, span<const limb_t> a, limb_t b)
+    {
+        check_size(r.size() >= a.size());
+        return bigint_detail::add_1(r.data(), a.data(), a.size(), b);
+    }
+    /**
+     * @brief Computes r = a - b, where b is a single limb. r may be a.
+     *
+     * @return The borrow out of the most significant limb of a (0 or 1).
+     */
+    inline limb_t sub_1(span<limb_t> r, span<const limb_t> a, limb_t b)
+    {
+        check_size(r.size() >= a.size());
+        return bigint_detail::sub_1(r.data(), a.data(), a.size(), b);
+    }
+    /**
+     * @brief Computes r = a * b, where b is a single limb, into the first a.size() limbs of r.
+     * r may be a.
+     *
+     * @return The most significant limb of the product, which does not fit in r.
+     */
+    inline limb_t mul_1(span<limb_t> r, span<const limb_t> a, limb_t b)
+    {
+        check_size(r.size() >= a.size());
+        return bigint_detail::mul_1(r.data(), a.data(), a.size(), b);
+    }
+    /**
+     * @brief Computes r = r + a * b on the first a.size() limbs of r, where b is a single limb.
+     * r must not overlap a.
+     *
+     * @return The limb carried out of the most significant limb of r.
+     */
+    inline limb_t addmul_1(span<limb_t> r, span<const limb_t> a, limb_t b)
+    {
+        check_size(r.size() >= a.size());
+        return bigint_detail::addmul_1(r.data(), a.data(), a.size(), b);
+    }
+    /**
+     * @brief Computes r = r - a * b on the first a.size() limbs of r, where b is a single limb.
+     * r must not overlap a.
+     *
+     * @return The limb borrowed from beyond the most significant limb of r.
+     */
+    inline limb_t submul_1(span<limb_t> r, span<const limb_t> a, limb_t b)
+    {
+        check_size(r.size() >= a.size());
+        return bigint_detail::submul_1(r.data(), a.data(), a.size(), b);
+    }
+    /**
+     * @brief Shifts a left by 0 <= count < 64 bits into the first a.size() limbs of r. r may be
+     * a.
+     *
+     * @return The bits shifted out of the most significant limb, in the low bits of a limb.
+     */
+    inline limb_t lshift(span<limb_t> r, span<const limb_t> a, unsigned count)
+    {
+        check_size(r.size() >= a.size() && count < 64);
+        if (count == 0)
+        {
+            copy(a.begin(), a.end(), r.begin());
+            return 0;
+        }
+        return bigint_detail::lshift(r.data(), a.data(), a.size(), count);
+    }
+    /**
+     * @brief Shifts a right by 0 <= count < 64 bits into the first a.size() limbs of r. r may be
+     * a.
+     *
+     * @return The bits shifted out of the least significant limb, in the high bits of a limb.
+     */
+    inline limb_t rshift(span<limb_t> r, span<const limb_t> a, unsigned count)
+    {
+        check_size(r.size() >= a.size() && count < 64);
+        if (count == 0)
+        {
+            copy(a.begin(), a.end(), r.begin());
+            return 0;
+        }
+        return bigint_detail::rshift(r.data(), a.data(), a.size(), count);
+    }
+    /**
+     * @brief Divides a by the single limb d, storing the quotient in the first a.size() limbs
+     * of q. q may be a. A domain_error is thrown if d is zero.
+     *
+     * @return The remainder.
+     */
+    inline limb_t divrem_1(span<limb_t> q, span<const limb_t> a, limb_t d)
+    {
+        check_size(q.size() >= a.size());
+        if (d == 0)
+        {
+            throw domain_error("division by zero");
+        }
+        return bigint_detail::divrem_1(q.data(), a.data(), a.size(), d);
+    }
+    /**
+     * @brief Returns the number of scratch limbs that mul needs for operands of an and bn
+     * limbs, in either order.
+     *
+     * @details The size follows the recursion of the multiplication algorithms at the current
+     * thresholds, so it must be computed again after they change. Nothing is allocated.
+     */
+    inline size_t mul_scratch_size(size_t an, size_t bn)
+    {
+        if (an < bn)
+        {
+            swap(an, bn);
+        }
+        if (bn == 0)
+        {
+            return 0;
+        }
+        if (an == bn)
+        {
+            /* The same span twice goes through the squaring algorithms, whose thresholds differ. */
+            return max(bigint_detail::mul_n_scratch_size(an, false), bigint_detail::mul_n_scratch_size(an, true));
+        }
+        return bigint_detail::mul_scratch_size(an, bn);
+    }
+    /**
+     * @brief Returns the number of scratch limbs that sqr needs for an operand of n limbs.
+     */
+    inline size_t sqr_scratch_size(size_t n)
+    {
+        return n == 0 ? 0 : bigint_detail::mul_n_scratch_size(n, true);
+    }
+    /**
+     * @brief Computes the product of a and b into the first a.size() + b.size() limbs of r.
+     *
+     * @details The algorithm is chosen by the size of the smaller operand, as for bigint. r must
+     * not overlap a, b or scratch, and scratch must have at least
+     * mul_scratch_size(a.size(), b.size()) limbs. When a and b are the same span the squaring
+     * algorithms are used.
+     */
+    inline void mul(span<limb_t> r, span<const limb_t> a, span<const limb_t> b, span<limb_t> scratch)
+    {
+        check_size(r.size() >= a.size() + b.size());
+        check_size(scratch.size() >= mul_scratch_size(a.size(), b.size()));
+        if (a.size() < b.size())
+        {
+            swap(a, b);
+        }
+        if (b.empty())
+        {
+            fill(r.begin(), r.begin() + (ptrdiff_t)a.size(), 0);
+            return;
+        }
+        if (a.data() == b.data() && a.size() == b.size())
+        {
+            bigint_detail::mul_n(r.data(), a.data(), a.data(), a.size(), scratch.data());
+            return;
+        }
+        bigint_detail::mul(r.data(), a.data(), a.size(), b.data(), b.size(), scratch.data());
+    }
+    /**
+     * @brief Computes the square of a into the first 2 a.size() limbs of r.
+     *
+     * @details r must not overlap a or scratch, and scratch must have at least
+     * sqr_scratch_size(a.size()) limbs.
+     */
+    inline void sqr(span<limb_t> r, span<const limb_t> a, span<limb_t> scratch)
+    {
+        check_size(r.size() >= 2 * a.size());
+        check_size(scratch.size() >= sqr_scratch_size(a.size()));
+        if (!a.empty())
+        {
+            bigint_detail::mul_n(r.data(), a.data(), a.data(), a.size(), scratch.data());
+        }
+    }
+}
+
+/* Opt-in expression templates, defined after the class. */
+namespace bigint_expr
+{
+    template <class E>
+    struct expression;
+    struct evaluator;
+}
+class bigint_modulus;
+class bigint_batch;
+class decimal_bigint;
+namespace bigint_detail
+{
+    struct number_theory;
+}
+/**
+ * @brief Overflow policy of fixed_bigint: results are reduced modulo 2^Bits, like the
+ * arithmetic of unsigned machine integers.
+ */
+struct fixed_wrap
+{
+};
+/**
+ * @brief Overflow policy of fixed_bigint: an operation whose exact result does not fit throws an
+ * overflow_error, and a conversion of a value that does not fit throws an out_of_range.
+ */
+struct fixed_checked
+{
+};
+template <size_t Bits, bool Signed = false, class Overflow = fixed_wrap>
+class fixed_bigint;
+class bigint_view;
+class bigint_parser;
+
+/**
+ * @brief A class representing arbitrary-precision integers (bigint).
+ *
+ * The `bigint` class allows the representation and manipulation of integers with
+ * arbitrary precision. It supports various arithmetic operations, including
+ * addition, subtraction, and multiplication, as well as comparison operations.
+ * Additionally, it includes utility functions for handling large integers.
+ *
+ * @note The implementation ensures proper handling of negative integers and
+ *       performs input validation to ensure the integrity of the stored data.
+ *
+ * @details The integer is stored in sign-magnitude form: a sign flag and a vector of 64-bit
+ *          limbs holding the magnitude, least significant limb first. Decimal strings are only
+ *          produced or consumed by `set_string`, `get_string` and `operator<<`.
+ *          The class provides a set of constructors and overloaded operators to
+ *          facilitate the creation and manipulation of bigint instances.
+ *          Operations like addition, subtraction, and multiplication are implemented
+ *          as friend functions to allow seamless usage with other bigint instances.
+ */
+class bigint
+{
+
+public:
+    /**
+     * @brief Default constructor initializing the bigint to 0.
+     */
+    bigint() {}
+    /**
+     * @brief Constructor initializing the bigint with a 64-bit integer.
+     *
+     * @param a The 64-bit integer to initialize the bigint with.
+     */
+    bigint(const int64_t x_)
+    {
+        *this = x_;
+    }
+    /**
+     * @brief Set function that stores the value of a given integer passed as string to the private
+     * member of the bigint object.
+     *
+     * @param s The string to initialize the bigint with.
+     *
+     * @note The implementation ensures proper handling of negative integers and
+     * performs input validation to ensure the integrity of the stored data. If string with an
+     * invalid integer is give, an invalid_argument error is thrown.
+     */
+    void set_string(const string &x_);
+    /**
+     * @brief Get function that returns the decimal representation of the bigint object.
+     *
+     * @return A string with the integer in base 10, with a leading '-' if it is negative.
+     */
+    string get_string() const;
+    /**
+     * @brief Constructor initializing the bigint with a string.
+     *
+     * @param a The string to initialize the bigint with.
+     * @note The implementation ensures proper handling of negative integers and
+     * performs input validation to ensure the integrity of the stored data. If string with an
+     * invalid integer is give, an invalid_argument error is thrown.
+     */
+    bigint(const string &x_)
+    {
+        set_string(x_);
+    }
+    /**
+     * @brief Copy constructor creating a new bigint object from another bigint.
+     *
+     * @param other The bigint object to copy.
+     */
+    bigint(const bigint &other) : limbs(other.limbs), negative(other.negative) {}
+    /**
+     * @brief Move constructor taking over the limbs of another bigint.
+     *
+     * @param other The bigint object to move from. It is left equal to zero.
+     */
+    bigint(bigint &&other) noexcept : limbs(move(other.limbs)), negative(other.negative)
+    {
+        other.negative = false;
+    }
+    /**
+     * @brief Assignment operator for bigint objects.
+     *
+     * @param a The bigint object to assign.
+     *
+     * @return Reference to the assigned bigint object.
+     */
+    bigint &operator=(const bigint &a);
+    /**
+     * @brief Move assignment operator for bigint objects.
+     *
+     * @param a The bigint object to move from. It is left equal to zero.
+     *
+     * @return Reference to the assigned bigint object.
+     */
+    bigint &operator=(bigint &&a) noexcept;
+    /**
+     * @brief Constructor evaluating an expression template.
+     *
+     * @param e The expression, built with bigint_expr::lazy.
+     *
+     * @details The result buffer is sized once for the whole expression and products are
+     * accumulated with addmul and submul, without temporaries. The constructor is explicit so
+     * that the operators of bigint are never chosen for expression operands.
+     */
+    template <class E>
+    explicit bigint(const bigint_expr::expression<E> &e);
+    /**
+     * @brief Assignment operator evaluating an expression template.
+     *
+     * @param e The expression, built with bigint_expr::lazy. It may refer to this object.
+     *
+     * @return Reference to the assigned bigint object.
+     */
+    template <class E>
+    bigint &operator=(const bigint_expr::expression<E> &e);
+    /**
+     * @brief Addition assignment operator accumulating an expression template.
+     *
+     * @param e The expression, built with bigint_expr::lazy. It may refer to this object.
+     *
+     * @return Reference to the modified bigint object.
+     */
+    template <class E>
+    bigint &operator+=(const bigint_expr::expression<E> &e);
+    /**
+     * @brief Subtraction assignment operator accumulating an expression template.
+     *
+     * @param e The expression, built with bigint_expr::lazy. It may refer to this object.
+     *
+     * @return Reference to the modified bigint object.
+     */
+    template <class E>
+    bigint &operator-=(const bigint_expr::expression<E> &e);
+    /**
+     * @brief Overloaded assignment operator..
+     *
+     * @param s The string that contains the integer to assign.
+     *
+     * @return Reference to the assigned bigint object.
+     */
+    bigint &operator=(const string &s);
+    /**
+     * @brief Assignment operator for bigint objects.
+     *
+     * @param i  The 64-bit integer to assign.
+     *
+     * @return Reference to the assigned bigint object.
+     */
+    bigint &operator=(const int64_t &i);
+    /**
+     * @brief Equality comparison operator for bigint objects.
+     *
+     * @param lhs The left-hand-side bigint object to compare.
+     *
+     * @param rhs The right-hand-side bigint object to compare.
+     *
+     * @details The objects are equal if they have the same sign and the same limbs.
+     *
+     * @return A boolean object, true if the objects are equal, false if the objects are not.
+     */
+    friend bool operator==(const bigint &lhs, const bigint &rhs);
+    /**
+     * @brief Less-than comparison operator for bigint objects.
+     *
+     * @param lhs The left-hand-side bigint object to compare.
+     *
+     * @param rhs The right-hand-side bigint object to compare.
+     *
+     * @details lhs is said to be less than rhs if the integer it represents is less than the integer
+     * rhs represents
+     *
+     * @return A boolean object, true if lhs is less than rhs, false otherwise
+     */
+    friend bool operator<(const bigint &lhs, const bigint &rhs);
+    /**
+     * @brief Addition assignment operator for bigint objects.
+     *
+     * @param x The left bigint.
+     *
+     * @param y The right side bigint.
+     *
+     * @details y may be the same object as x.
+     *
+     * @return Reference to the modified left-hand side bigint.
+     */
+    friend bigint &operator+=(bigint &x, const bigint &y);
+    /**
+     * @brief Unsigned addition operation for bigint instances.
+     *
+     * @param x The left-hand side bigint.
+     *
+     * @param y The right-hand side bigint.
+     *
+     * @details This function adds the magnitudes of the two integers limb by limb, propagating the
+     * carry from one limb to the next, and stores the result in the magnitude of x. The sign of x is
+     * left untouched and y is not modified. This function is used on other basic functions of the
+     * class such as +=,+,*=,* to optimize calculations and increase readability.
+     */
+    friend void unsigned_sum(bigint &x, const bigint &y);
+    /**
+     * @brief Unsigned subtraction operation for bigint instances.
+     *
+     * @param x The left bigint.
+     *
+     * @param y The right bigint.
+     *
+     * @details This function subtracts the magnitudes of the two integers limb by limb,
+     * propagating the borrow, and stores the signed result |x|-|y| in x. y is not modified.
+     * This function is used on other basic functions of the class such as -=,- to increase readability.
+     */
+    friend void unsigned_subtraction(bigint &x, const bigint &y);
+    /**
+     * @brief Subtraction assignment operator for bigint objects.
+     *
+     * @param x The left-hand side bigint.
+     *
+     * @param y The right-hand side bigint.
+     *
+     * @details y may be the same object as x.
+     *
+     * @return Reference to the modified left-hand side bigint.
+     */
+    friend bigint &operator-=(bigint &x, const bigint &y);
+    /**
+     * @brief Multiplication assignment operator for bigint objects.
+     *
+     * @param x The left-hand side bigint.
+     *
+     * @param y The right-hand side bigint.
+     *
+     * @details y may be the same object as x, in which case x is squared.
+     *
+     * @return Reference to the modified left-hand side bigint.
+     */
+    friend bigint &operator*=(bigint &x, const bigint &y);
+    /**
+     * @brief Fused multiply-add for bigint objects.
+     *
+     * @param x The bigint where the result is accumulated.
+     *
+     * @param a The first factor.
+     *
+     * @param b The second factor.
+     *
+     * @details Computes x += a * b without creating a bigint for the product. A single-limb
+     * factor is multiplied and added in the same pass over x. a and b may be the same object
+     * as x.
+     */
+    friend void addmul(bigint &x, const bigint &a, const bigint &b);
+    /**
+     * @brief Fused multiply-subtract for bigint objects.
+     *
+     * @param x The bigint where the result is accumulated.
+     *
+     * @param a The first factor.
+     *
+     * @param b The second factor.
+     *
+     * @details Computes x -= a * b, in the same way as addmul.
+     */
+    friend void submul(bigint &x, const bigint &a, const bigint &b);
+    /**
+     * @brief Unsigned division operation for bigint instances.
+     *
+     * @param x The dividend.
+     *
+     * @param y The divisor, which must not be zero.
+     *
+     * @param q The bigint where the quotient |x| / |y| is stored.
+     *
+     * @param r The bigint where the remainder |x| % |y| is stored.
+     *
+     * @details This function divides the magnitudes of the two integers. Divisors of a single
+     * limb use a division by an invariant integer, small divisors use Knuth's schoolbook
+     * algorithm D and large ones the recursive algorithm of Burnikel and Ziegler, whose cost
+     * tracks the cost of multiplication. q and r may be the same objects as x or y.
+     */
+    friend void unsigned_division(const bigint &x, const bigint &y, bigint &q, bigint &r);
+    /**
+     * @brief Division assignment operator for bigint objects.
+     *
+     * @param x The left-hand side bigint.
+     *
+     * @param y The right-hand side bigint.
+     *
+     * @details The quotient is truncated toward zero, as for the built-in integers. A
+     * domain_error is thrown if y is zero.
+     *
+     * @return Reference to the modified left-hand side bigint.
+     */
+    friend bigint &operator/=(bigint &x, const bigint &y);
+    /**
+     * @brief Modulo assignment operator for bigint objects.
+     *
+     * @param x The left-hand side bigint.
+     *
+     * @param y The right-hand side bigint.
+     *
+     * @details The remainder has the sign of x, so that x == (x / y) * y + x % y, as for the
+     * built-in integers. A domain_error is thrown if y is zero.
+     *
+     * @return Reference to the modified left-hand side bigint.
+     */
+    friend bigint &operator%=(bigint &x, const bigint &y);
+    /**
+     * @brief Computes the quotient and the remainder of a division at once.
+     *
+     * @param x The dividend.
+     *
+     * @param y The divisor.
+     *
+     * @details Same rounding as the operators / and %, at the cost of a single division.
+     *
+     * @return A pair with the quotient x / y and the remainder x % y.
+     */
+    friend pair<bigint, bigint> divmod(const bigint &x, const bigint &y);
+    /**
+     * @brief Raises a bigint to a power.
+     *
+     * @param base The base.
+     *
+     * @param exponent The exponent. pow(x, 0) is 1 for every x, including 0.
+     *
+     * @details Left-to-right binary exponentiation: one squaring per bit of the exponent and one
+     * multiplication by the base per set bit, so the cost is dominated by the last squaring.
+     *
+     * @return base raised to exponent.
+     */
+    friend bigint pow(const bigint &base, uint64_t exponent);
+    /**
+     * @brief Integer square root.
+     *
+     * @param x A non-negative bigint. A domain_error is thrown if x is negative.
+     *
+     * @return The largest integer whose square is not greater than x.
+     */
+    friend bigint isqrt(const bigint &x);
+    /**
+     * @brief Integer k-th root.
+     *
+     * @param x The radicand, which may be negative only if k is odd; a domain_error is thrown
+     * otherwise, and also if k is 0.
+     *
+     * @param k The index of the root.
+     *
+     * @details The root of the top bits of x is computed recursively at half the precision, and
+     * one Newton step x' = ((k-1)x + n / x^(k-1)) / k doubles the number of correct bits. The last
+     * step is at full size, so the cost is a few multiplications of the size of x.
+     *
+     * @return The k-th root of x rounded toward zero.
+     */
+    friend bigint iroot(const bigint &x, uint64_t k);
+    /**
+     * @brief Greatest common divisor.
+     *
+     * @details Lehmer's algorithm: the quotients of the Euclidean algorithm are computed from the
+     * top 64 bits of the operands as long as Jebelean's condition guarantees they are right, and
+     * then applied to the whole numbers at once. Above the gcd_hgcd threshold the half-gcd
+     * reduces the operands to half their size with recursive calls on their top halves, so the
+     * cost is O(M(n) log n) for a multiplication cost of M(n).
+     *
+     * @return The non-negative greatest common divisor of x and y; gcd(0, 0) is 0.
+     */
+    friend bigint gcd(const bigint &x, const bigint &y);
+    /**
+     * @brief Extended greatest common divisor.
+     *
+     * @details Same algorithm as gcd, also keeping the product of the quotient matrices. The
+     * cofactors are the smallest ones: |s| <= |y| / (2g) and |t| <= |x| / (2g) unless one of the
+     * operands divides the other.
+     *
+     * @return A tuple (g, s, t) with g = gcd(x, y) and s x + t y = g.
+     */
+    friend tuple<bigint, bigint, bigint> xgcd(const bigint &x, const bigint &y);
+    /**
+     * @brief Access to the crossover points between the multiplication and division algorithms.
+     *
+     * @details The returned reference can be modified to change the thresholds for the whole
+     * program. It should not be modified while other threads are multiplying or dividing.
+     *
+     * @return Reference to the thresholds used by every multiplication.
+     */
+    static bigint_thresholds &thresholds();
+    /**
+     * @brief Measures the crossover points between the multiplication and division algorithms
+     * on the host machine and installs them.
+     *
+     * @details For each pair of neighbouring algorithms the operand size is increased until one
+     * level of the faster algorithm beats the slower one on random operands. Tuning takes about a
+     * second, so it is meant to be run once at startup, or by a separate tool that prints the
+     * values to hard-code them.
+     *
+     * @return The thresholds that were measured and installed.
+     */
+    static bigint_thresholds tune_thresholds();
+    /**
+     * @brief A function that eliminates the most significant zero limbs of a bigint object.
+     * This is useful cause after a subtraction the high limbs of the result may be zero, this
+     * function then drops them so that every value has a unique representation.
+     * @param a A reference to a bigint object
+     * @return The same bigint object
+     */
+    bigint &erase_left_zeros();
+    /**
+     * @brief Output stream operator for bigint objects.
+     *
+     * @param os The output stream.
+     * @param a The bigint to be output.
+     * @return Reference to the output stream.
+     */
+    friend ostream &operator<<(ostream &out, const bigint &a);
+    /**
+     * @brief Writes values in the binary format of bigint.
+     *
+     * @param out The output stream, which should be opened in binary mode.
+     * @param values The values to write.
+     * @param index Whether to write the table of record offsets that bigint_archive uses for
+     * random access.
+     *
+     * @details The format is little-endian on every platform. A 24-byte header holds the magic
+     * bytes "BIGINTS", a zero byte, the format version (32 bits), the flags (32 bits, bit 0 set if
+     * there is an index) and the number of values (64 bits). The index, if present, follows with
+     * the byte offset of every record from the start of the header, and then come the records:
+     * a 64-bit word holding twice the number of limbs plus one if the value is negative,
+     * followed by the limbs of the magnitude, least significant first. Every field is a multiple
+     * of 8 bytes, so the limbs of a mapped file are aligned and can be used in place.
+     */
+    friend void write_binary(ostream &out, const vector<bigint> &values, bool index);
+    /**
+     * @brief Writes a single value in the binary format of bigint, as an array of one value.
+     */
+    friend void write_binary(ostream &out, const bigint &x);
+    /**
+     * @brief Reads values written by write_binary, with or without an index.
+     *
+     * @details An invalid_argument is thrown if the data is not in the format, uses a newer
+     * version or ends early.
+     */
+    friend void read_binary(istream &in, vector<bigint> &values);
+    /**
+     * @brief Reads a single value written by write_binary.
+     *
+     * @details An invalid_argument is thrown if the data does not hold exactly one value.
+     */
+    friend void read_binary(istream &in, bigint &x);
+    /**
+     * @brief Negation operator for bigint objects.
+     *
+     * @param a A copy of the bigint object
+     *
+     * @return The copy of the bigint object but with the opposite sign.
+     */
+    friend bigint operator-(bigint a);
+    /**
+     * @brief Summation operation for bigint instances.
+     *
+     * @param x The left-hand side bigint.
+     *
+     * @param y The right-hand side bigint.
+     *
+     * @details The result is built in a new buffer with room for the carry, so adding more
+     * operands of similar size to the temporary, as in a + b + c, does not reallocate it.
+     *
+     * @return A new bigint with the sum x+y.
+     */
+    friend bigint operator+(const bigint &x, const bigint &y);
+    /**
+     * @brief Subtraction operation for bigint instances.
+     *
+     * @param x The left-hand side bigint.
+     *
+     * @param y The right-hand side bigint.
+     *
+     * @details The result is built in a new buffer with room for the borrow, like the one of
+     * operator+.
+     *
+     * @return A new bigint with the difference x-y.
+     */
+    friend bigint operator-(const bigint &x, const bigint &y);
+    /**
+     * @brief Left shift assignment operator for bigint objects.
+     *
+     * @param x The bigint to shift.
+     *
+     * @param count The number of bits.
+     *
+     * @details Computes x * 2^count by moving the limbs in place, keeping the sign of x.
+     *
+     * @return Reference to the modified bigint.
+     */
+    friend bigint &operator<<=(bigint &x, uint64_t count);
+    /**
+     * @brief Right shift assignment operator for bigint objects.
+     *
+     * @param x The bigint to shift.
+     *
+     * @param count The number of bits.
+     *
+     * @details Arithmetic shift, as on the two's complement form of x: the result is x / 2^count
+     * rounded toward minus infinity, so -1 >> 1 is -1. The division operator, which rounds toward
+     * zero, gives -1 / 2 == 0.
+     *
+     * @return Reference to the modified bigint.
+     */
+    friend bigint &operator>>=(bigint &x, uint64_t count);
+    /**
+     * @brief Left shift operation for bigint instances, x * 2^count.
+     *
+     * @details The result is built in a new buffer of the right size; a temporary operand is
+     * shifted in place and moved out instead.
+     */
+    friend bigint operator<<(const bigint &x, uint64_t count);
+    friend bigint operator<<(bigint &&x, uint64_t count);
+    /**
+     * @brief Right shift operation for bigint instances, x / 2^count rounded toward minus
+     * infinity, built like the result of operator<<.
+     */
+    friend bigint operator>>(const bigint &x, uint64_t count);
+    friend bigint operator>>(bigint &&x, uint64_t count);
+    /**
+     * @brief Bitwise AND of bigint objects.
+     *
+     * @param x The left-hand side bigint.
+     *
+     * @param y The right-hand side bigint.
+     *
+     * @details The operators &, |, ^ and ~ act on the two's complement forms of their operands,
+     * which are infinite strings of bits extending the sign, as for the built-in signed integers:
+     * -1 has every bit set and x & -1 == x. Their cost is linear in the size of the operands, and
+     * when neither operand is negative the magnitudes are combined directly.
+     *
+     * @return A new bigint with the result.
+     */
+    friend bigint operator&(const bigint &x, const bigint &y);
+    /**
+     * @brief Bitwise OR of bigint objects, on their two's complement forms.
+     */
+    friend bigint operator|(const bigint &x, const bigint &y);
+    /**
+     * @brief Bitwise exclusive OR of bigint objects, on their two's complement forms.
+     */
+    friend bigint operator^(const bigint &x, const bigint &y);
+    /**
+     * @brief Bitwise complement of a bigint, -x - 1.
+     */
+    friend bigint operator~(bigint x);
+    /**
+     * @brief Bitwise AND assignment operator, done in place when neither operand is negative.
+     */
+    friend bigint &operator&=(bigint &x, const bigint &y);
+    /**
+     * @brief Bitwise OR assignment operator, done in place when neither operand is negative.
+     */
+    friend bigint &operator|=(bigint &x, const bigint &y);
+    /**
+     * @brief Bitwise exclusive OR assignment operator, done in place when neither operand is
+     * negative.
+     */
+    friend bigint &operator^=(bigint &x, const bigint &y);
+    /**
+     * @brief Returns the number of bits of the magnitude, 0 for zero.
+     *
+     * @details For x != 0 this is the exponent k such that 2^(k-1) <= |x| < 2^k.
+     */
+    uint64_t bit_length() const;
+    /**
+     * @brief Returns the number of bits set in the magnitude.
+     */
+    uint64_t popcount() const;
+    /**
+     * @brief Returns the number of zero bits below the least significant set bit, which is the
+     * same for x and -x, so that x is a multiple of 2^count_trailing_zeros(). A domain_error is
+     * thrown if x is zero.
+     */
+    uint64_t count_trailing_zeros() const;
+    /**
+     * @brief Returns bit i of the two's complement form of the bigint.
+     *
+     * @details The bits of a negative number above its magnitude are all set.
+     */
+    bool test_bit(uint64_t i) const;
+    /**
+     * @brief Sets bit i of the two's complement form of the bigint.
+     *
+     * @details For a non-negative number the limb is changed in place, after growing the
+     * magnitude if needed. Setting a clear bit of a negative number adds 2^i to it.
+     */
+    void set_bit(uint64_t i);
+    /**
+     * @brief Clears bit i of the two's complement form of the bigint.
+     *
+     * @details Clearing a set bit of a negative number subtracts 2^i from it, so clearing a bit
+     * above its magnitude makes it more negative.
+     */
+    void clear_bit(uint64_t i);
+
+private:
+    /* Magnitude, least significant limb first, without most significant zero limbs. */
+    bigint_detail::limb_vector limbs;
+    /* Sign flag, never set when the magnitude is zero. */
+    bool negative = false;
+
+    friend struct bigint_expr::evaluator;
+    friend class bigint_modulus;
+    friend class bigint_batch;
+    friend struct bigint_detail::number_theory;
+    template <size_t Bits, bool Signed, class Overflow>
+    friend class fixed_bigint;
+    friend class bigint_view;
+    friend class bigint_parser;
+    friend class decimal_bigint;
+
+    /* x += a * b, or x -= a * b if subtract is set; shared by addmul and submul. */
+    void add_product(const bigint &a, const bigint &b, bool subtract);
+    /* Applies a bitwise operation to the two's complement forms of x and y, computing the low n
+       limbs; shared by the operators &, | and ^. */
+    template <class Op>
+    static bigint bitwise(const bigint &x, const bigint &y, size_t n, Op op);
+    /* r = x * 2^count and r = x / 2^count rounded toward minus infinity; r may be x. */
+    static void shift_left(bigint &r, const bigint &x, uint64_t count);
+    static void shift_right(bigint &r, const bigint &x, uint64_t count);
+
+    /* True when the magnitude fits in one limb; the value then fits in a signed 128-bit integer
+       and the sum, difference or product of two such values can be computed natively. */
+    bool is_small() const
+    {
+        return limbs.size() <= 1;
+    }
+    bigint_detail::signed_dlimb_t small_value() const
+    {
+        bigint_detail::signed_dlimb_t magnitude = limbs.empty() ? 0 : limbs[0];
+        return negative ? -magnitude : magnitude;
+    }
+    /* Stores a value whose magnitude is below 2^127, without leaving the inline storage. */
+    void set_small(bigint_detail::signed_dlimb_t value)
+    {
+        negative = value < 0;
+        bigint_detail::dlimb_t magnitude = negative ? 0 - (bigint_detail::dlimb_t)value : (bigint_detail::dlimb_t)value;
+        limbs.resize((magnitude >> 64) != 0 ? 2 : magnitude != 0 ? 1 : 0);
+        if (!limbs.empty())
+        {
+            limbs[0] = (uint64_t)magnitude;
+        }
+        if (limbs.size() == 2)
+        {
+            limbs[1] = (uint64_t)(magnitude >> 64);
+        }
+    }
+};
+inline bigint &bigint::erase_left_zeros()
+{
+    const size_t n = bigint_detail::normalized_size(limbs.data(), limbs.size());
+    bigint_detail::count_normalization(limbs.size() - n);
+    limbs.resize(n);
+    if (limbs.empty())
+    {
+        negative = false;
+    }
+    return *this;
+};
+inline bigint_thresholds &bigint::thresholds()
+{
+    return bigint_detail::tuning;
+}
+inline bigint_thresholds bigint::tune_thresholds()
+{
+    using namespace bigint_detail;
+    mt19937_64 random(12345);
+    vector<limb_t> a(2048), b(2048), r(4096), scratch;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        a[i] = random();
+        b[i] = random();
+    }
+    /* Best of three runs of as many calls of operation(n) as fit in about a millisecond. */
+    auto time_per_call = [&](size_t n, const function<void(size_t)> &operation)
+    {
+        double best = 1e30;
+        for (int run = 0; run < 3; run++)
+        {
+            size_t calls = 0;
+            auto start = chrono::steady_clock::now();
+            chrono::duration<double> elapsed{};
+            do
+            {
+                operation(n);
+                calls++;
+                elapsed = chrono::steady_clock::now() - start;
+            } while (elapsed.count() < 1e-3);
+            best = min(best, elapsed.count() / (double)calls);
+        }
+        return best;
+    };
+    /* Smallest size at which a threshold of n (one level of the faster algorithm) beats a
+       disabled threshold, confirmed on two consecutive sizes. */
+    auto crossover = [&](size_t &threshold, size_t from, size_t to, const function<void(size_t)> &operation)
+    {
+        size_t candidate = to;
+        bool previous = false;
+        for (size_t n = from; n <= to; n += n / 8 + 1)
+        {
+            threshold = SIZE_MAX;
+            double slow = time_per_call(n, operation);
+            threshold = n;
+            double fast = time_per_call(n, operation);
+            if (fast < slow && previous)
+            {
+                break;
+            }
+            previous = fast < slow;
+            candidate = previous ? n : to;
+        }
+        threshold = candidate;
+    };
+    auto multiply = [&](size_t n)
+    {
+        scratch.resize(mul_n_scratch_size(n, false));
+        mul_n(r.data(), a.data(), b.data(), n, scratch.data());
+    };
+    auto square = [&](size_t n)
+    {
+        scratch.resize(mul_n_scratch_size(n, true));
+        mul_n(r.data(), a.data(), a.data(), n, scratch.data());
+    };
+    /* One level of Burnikel-Ziegler with a threshold of n happens for a 2n-limb divisor. */
+    auto divide = [&](size_t n)
+    {
+        copy(b.begin(), b.begin() + (ptrdiff_t)(4 * n), r.begin());
+        a[2 * n - 1] |= 1ULL << 63;
+        r[4 * n - 1] = 0;
+        divrem_window(scratch.data(), r.data(), a.data(), 2 * n, 2 * n);
+    };
+    tuning.mul_toom3 = tuning.sqr_toom3 = tuning.mul_ntt = tuning.sqr_ntt = SIZE_MAX;
+    crossover(tuning.mul_karatsuba, 4, 256, multiply);
+    crossover(tuning.sqr_karatsuba, 4, 256, square);
+    crossover(tuning.mul_toom3, max<size_t>(tuning.mul_karatsuba, 16), 1024, multiply);
+    crossover(tuning.sqr_toom3, max<size_t>(tuning.sqr_karatsuba, 16), 1024, square);
+    a.resize(1 << 15);
+    b.resize(1 << 15);
+    r.resize(1 << 16);
+    scratch.resize(1 << 10);
+    for (size_t i = 2048; i < a.size(); i++)
+    {
+        a[i] = random();
+        b[i] = random();
+    }
+    crossover(tuning.div_bz, 4, 256, divide);
+    crossover(tuning.mul_ntt, max<size_t>(tuning.mul_toom3, 256), 1 << 15, multiply);
+    crossover(tuning.sqr_ntt, max<size_t>(tuning.sqr_toom3, 256), 1 << 15, square);
+    return tuning;
+}
+inline void bigint::set_string(const string &x_)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::from_string, (x_.size() + decimal_base_digits - 1) / decimal_base_digits);
+    size_t start = (!x_.empty() && x_[0] == '-') ? 1 : 0;
+    if (start == x_.size() || !all_digits(x_.data() + start, x_.size() - start))
+    {
+        throw invalid_argument("invalid integer");
+    }
+    parse_decimal(limbs, x_.data() + start, x_.size() - start);
+    negative = start == 1;
+    erase_left_zeros();
+}
+inline string bigint::get_string() const
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::to_string, limbs.size());
+    if (limbs.empty())
+    {
+        return "0";
+    }
+    /* A limb holds less than 20 decimal digits; the leading zeros of the padding are dropped. */
+    const size_t width = limbs.size() * 20;
+    string out(width + 1, '-');
+    print_decimal(&out[1], width, limbs.data(), limbs.size());
+    size_t first = out.find_first_not_of('0', 1);
+    if (negative)
+    {
+        out.erase(1, first - 1);
+    }
+    else
+    {
+        out.erase(0, first);
+    }
+    return out;
+}
+inline bigint &bigint::operator=(const bigint &y)
+{
+    limbs = y.limbs;
+    negative = y.negative;
+    return *this;
+}
+inline bigint &bigint::operator=(bigint &&y) noexcept
+{
+    limbs = move(y.limbs);
+    negative = y.negative;
+    if (this != &y)
+    {
+        y.negative = false;
+    }
+    return *this;
+}
+inline bigint &bigint::operator=(const string &s)
+{
+    set_string(s);
+    return *this;
+}
+inline bigint &bigint::operator=(const int64_t &i)
+{
+    limbs.clear();
+    /* Negating in unsigned arithmetic keeps INT64_MIN representable. */
+    uint64_t magnitude = i < 0 ? 0 - (uint64_t)i : (uint64_t)i;
+    if (magnitude != 0)
+    {
+        limbs.push_back(magnitude);
+    }
+    negative = i < 0;
+    return *this;
+}
+
+inline bool operator==(const bigint &lhs, const bigint &rhs)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::compare, max(lhs.limbs.size(), rhs.limbs.size()));
+    if (lhs.negative != rhs.negative || lhs.limbs.size() != rhs.limbs.size())
+    {
+        return false;
+    }
+    return bigint_detail::cmp_n(lhs.limbs.data(), rhs.limbs.data(), lhs.limbs.size()) == 0;
+}
+/**
+ * @brief Inequality comparison operator for bigint instances.
+ *
+ * @details Checks whether two bigint instances are not equal.
+ *
+ * @param x The left-hand side bigint.
+ * @param y The right-hand side bigint.
+ * @return True if the bigints are not equal, false otherwise.
+ */
+inline bool operator!=(const bigint &lhs, const bigint &rhs)
+{
+    return !(lhs == rhs);
+}
+
+inline bool operator<(const bigint &x, const bigint &y)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::compare, max(x.limbs.size(), y.limbs.size()));
+    if (x.is_small() && y.is_small())
+    {
+        return x.small_value() < y.small_value();
+    }
+    if (x.negative != y.negative)
+    {
+        return x.negative;
+    }
+    int c = bigint_detail::cmp(x.limbs.data(), x.limbs.size(), y.limbs.data(), y.limbs.size());
+    /* For two negative numbers the one with the larger magnitude is the smaller one. */
+    return x.negative ? c > 0 : c < 0;
+}
+/**
+ * @brief Bigger-than comparison operator for bigint objects.
+ *
+ * @param lhs The left-hand-side bigint object to compare.
+ *
+ * @param rhs The right-hand-side bigint object to compare.
+ *
+ * @details lhs is said to be greater than rhs if the integer it represents is bigger than the integer
+ * rhs represents
+ *
+ * @return A boolean object, true if lhs is bigger than rhs, false otherwise
+ */
+inline bool operator>(const bigint &lhs, const bigint &rhs)
+{
+    return rhs < lhs;
+};
+/**
+ * @brief Less or equal to comparison operator for bigint objects.
+ *
+ * @param lhs The left-hand-side bigint object to compare.
+ *
+ * @param rhs The right-hand-side bigint object to compare.
+ *
+ * @details the function uses the pre-defined less than operator.
+ *
+ * @return A boolean object, true if lhs is les or equal to rhs, false otherwise
+ */
+inline bool operator<=(const bigint &lhs, const bigint &rhs)
+{
+    return !(rhs < lhs);
+}
+/**
+ * @brief Bigger or equal to comparison operator for bigint objects.
+ *
+ * @param lhs The left-hand-side bigint object to compare.
+ *
+ * @param rhs The right-hand-side bigint object to compare.
+ *
+ * @details the function uses the pre-defined less than operator.
+ *
+ * @return A boolean object, true if lhs is les or equal to rhs, false otherwise
+ */
+inline bool operator>=(const bigint &lhs, const bigint &rhs)
+{
+    return !(lhs < rhs);
+};
+
+inline bigint operator-(bigint x)
+{
+    x.negative = !x.negative && !x.limbs.empty();
+    return x;
+}
+
+inline void unsigned_sum(bigint &x, const bigint &y) /*Sum of the magnitudes of two numbers*/
+{
+    using namespace bigint_detail;
+    const size_t yn = y.limbs.size();
+    const size_t n = max(x.limbs.size(), yn);
+    /* x is padded with zero limbs up to the size of the result, y is read in place (after the
+       resize, in case it is x itself). A limb is only added for a final carry, so a buffer with
+       one spare limb absorbs a chain of additions of operands of the same size. */
+    x.limbs.resize(n, 0);
+    limb_t *xp = x.limbs.data();
+    const limb_t *yp = y.limbs.data();
+    limb_t carry = add_n(xp, xp, yp, yn);
+    carry = add_1(xp + yn, xp + yn, n - yn, carry);
+    if (carry != 0)
+    {
+        x.limbs.push_back(carry);
+    }
+}
+
+inline void unsigned_subtraction(bigint &x, const bigint &y) /*Difference of the magnitudes of two numbers*/
+{
+    using namespace bigint_detail;
+    const size_t xn = x.limbs.size();
+    const size_t yn = y.limbs.size();
+    if (cmp(x.limbs.data(), xn, y.limbs.data(), yn) >= 0)
+    {
+        limb_t *xp = x.limbs.data();
+        limb_t borrow = sub_n(xp, xp, y.limbs.data(), yn);
+        sub_1(xp + yn, xp + yn, xn - yn, borrow);
+        x.negative = false;
+    }
+    else
+    {
+        x.limbs.resize(yn, 0);
+        limb_t *xp = x.limbs.data();
+        sub_n(xp, y.limbs.data(), xp, yn);
+        x.negative = true;
+    }
+    x.erase_left_zeros();
+}
+
+inline bigint &operator+=(bigint &x, const bigint &y)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::add, max(x.limbs.size(), y.limbs.size()));
+    if (x.is_small() && y.is_small())
+    {
+        x.set_small(x.small_value() + y.small_value());
+    }
+    else if (x.negative == y.negative)
+    {
+        unsigned_sum(x, y);
+    }
+    else
+    {
+        bool negative = x.negative;
+        unsigned_subtraction(x, y);
+        if (negative)
+        {
+            x.negative = !x.negative && !x.limbs.empty();
+        }
+    }
+    return x;
+}
+inline bigint operator+(const bigint &x, const bigint &y)
+{
+    bigint result;
+    result.limbs.reserve(max(x.limbs.size(), y.limbs.size()) + 1);
+    result = x;
+    result += y;
+    return result;
+}
+/**
+ * @brief Summation operation for bigint instances whose left-hand side is a temporary.
+ *
+ * @param x The left-hand side bigint, whose buffer is reused for the result.
+ *
+ * @param y The right-hand side bigint.
+ *
+ * @details This function computes x += y in place and moves x out, so a chain a + b + c + d
+ * allocates a single buffer.
+ */
+inline bigint operator+(bigint &&x, const bigint &y)
+{
+    x += y;
+    return move(x);
+}
+/**
+ * @brief Summation operation for bigint instances whose right-hand side is a temporary.
+ *
+ * @param x The left-hand side bigint.
+ *
+ * @param y The right-hand side bigint, whose buffer is reused for the result.
+ */
+inline bigint operator+(const bigint &x, bigint &&y)
+{
+    y += x;
+    return move(y);
+}
+/**
+ * @brief Summation operation for two temporary bigint instances.
+ *
+ * @param x The left-hand side bigint, whose buffer is reused for the result.
+ *
+ * @param y The right-hand side bigint.
+ */
+inline bigint operator+(bigint &&x, bigint &&y)
+{
+    x += y;
+    return move(x);
+}
+
+inline bigint &operator-=(bigint &x, const bigint &y)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::sub, max(x.limbs.size(), y.limbs.size()));
+    if (x.is_small() && y.is_small())
+    {
+        x.set_small(x.small_value() - y.small_value());
+    }
+    else if (x.negative != y.negative)
+    {
+        unsigned_sum(x, y);
+    }
+    else
+    {
+        bool negative = x.negative;
+        unsigned_subtraction(x, y);
+        if (negative)
+        {
+            x.negative = !x.negative && !x.limbs.empty();
+        }
+    }
+    return x;
+}
+inline bigint operator-(const bigint &x, const bigint &y)
+{
+    bigint result;
+    result.limbs.reserve(max(x.limbs.size(), y.limbs.size()) + 1);
+    result = x;
+    result -= y;
+    return result;
+}
+/**
+ * @brief Subtraction operation for bigint instances whose left-hand side is a temporary.
+ *
+ * @param x The left-hand side bigint, whose buffer is reused for the result.
+ *
+ * @param y The right-hand side bigint.
+ */
+inline bigint operator-(bigint &&x, const bigint &y)
+{
+    x -= y;
+    return move(x);
+}
+/**
+ * @brief Subtraction operation for bigint instances whose right-hand side is a temporary.
+ *
+ * @param x The left-hand side bigint.
+ *
+ * @param y The right-hand side bigint, whose buffer is reused for the result.
+ *
+ * @details x - y is computed as -(y - x) in the buffer of y.
+ */
+inline bigint operator-(const bigint &x, bigint &&y)
+{
+    y -= x;
+    return -move(y);
+}
+/**
+ * @brief Subtraction operation for two temporary bigint instances.
+ *
+ * @param x The left-hand side bigint, whose buffer is reused for the result.
+ *
+ * @param y The right-hand side bigint.
+ */
+inline bigint operator-(bigint &&x, bigint &&y)
+{
+    x -= y;
+    return move(x);
+}
+inline ostream &operator<<(ostream &out, const bigint &x)
+{
+    out << x.get_string();
+    return out;
+};
+
+inline bigint &operator*=(bigint &x, const bigint &y)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::mul, max(x.limbs.size(), y.limbs.size()));
+    if (x.limbs.empty() || y.limbs.empty())
+    {
+        x = 0;
+        return x;
+    }
+    bool negative = x.negative != y.negative;
+    if (x.is_small() && y.is_small())
+    {
+        dlimb_t product = (dlimb_t)x.limbs[0] * y.limbs[0];
+        x.limbs.resize((product >> 64) != 0 ? 2 : 1);
+        x.limbs[0] = (limb_t)product;
+        if (x.limbs.size() == 2)
+        {
+            x.limbs[1] = (limb_t)(product >> 64);
+        }
+        x.negative = negative;
+        return x;
+    }
+    /* A factor that is a power of two turns the product into a shift. */
+    uint64_t exponent;
+    if (power_of_two(y.limbs.data(), y.limbs.size(), exponent))
+    {
+        x.negative = negative;
+        x <<= exponent;
+        return x;
+    }
+    if (power_of_two(x.limbs.data(), x.limbs.size(), exponent))
+    {
+        bigint::shift_left(x, y, exponent);
+        x.negative = negative;
+        return x;
+    }
+    limb_vector result(x.limbs.size() + y.limbs.size());
+    if (&x == &y)
+    {
+        mul(result.data(), x.limbs.data(), x.limbs.size(), x.limbs.data(), x.limbs.size());
+    }
+    else if (x.limbs.size() >= y.limbs.size())
+    {
+        mul(result.data(), x.limbs.data(), x.limbs.size(), y.limbs.data(), y.limbs.size());
+    }
+    else
+    {
+        mul(result.data(), y.limbs.data(), y.limbs.size(), x.limbs.data(), x.limbs.size());
+    }
+    x.limbs = move(result);
+    x.negative = negative;
+    x.erase_left_zeros();
+    return x;
+}
+/**
+ * @brief Multiplication operation for bigint instances.
+ *
+ * @param x The left-hand side bigint.
+ *
+ * @param y The right-hand side bigint.
+ *
+ * @details This function computes the multiplication x*y and returns a new bigint with the result
+ * of the multiplication. This function uses the pre-defined *= and operator.
+ */
+inline bigint operator*(const bigint &x, const bigint &y)
+{
+    bigint result = x;
+    result *= y;
+    return result;
+}
+/**
+ * @brief Multiplication operation for bigint instances whose left-hand side is a temporary.
+ *
+ * @param x The left-hand side bigint, which is multiplied in place and moved out.
+ *
+ * @param y The right-hand side bigint.
+ */
+inline bigint operator*(bigint &&x, const bigint &y)
+{
+    x *= y;
+    return move(x);
+}
+/**
+ * @brief Multiplication operation for bigint instances whose right-hand side is a temporary.
+ *
+ * @param x The left-hand side bigint.
+ *
+ * @param y The right-hand side bigint, which is multiplied in place and moved out.
+ */
+inline bigint operator*(const bigint &x, bigint &&y)
+{
+    y *= x;
+    return move(y);
+}
+/**
+ * @brief Multiplication operation for two temporary bigint instances.
+ *
+ * @param x The left-hand side bigint, which is multiplied in place and moved out.
+ *
+ * @param y The right-hand side bigint.
+ */
+inline bigint operator*(bigint &&x, bigint &&y)
+{
+    x *= y;
+    return move(x);
+}
+
+inline void bigint::add_product(const bigint &a, const bigint &b, bool subtract)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::addmul, max(a.limbs.size(), b.limbs.size()));
+    if (a.limbs.empty() || b.limbs.empty())
+    {
+        return;
+    }
+    const bool product_negative = (a.negative != b.negative) != subtract;
+    if (is_small() && a.is_small() && b.is_small())
+    {
+        dlimb_t product = (dlimb_t)a.limbs[0] * b.limbs[0];
+        if ((product >> 126) == 0)
+        {
+            signed_dlimb_t p = (signed_dlimb_t)product;
+            set_small(small_value() + (product_negative ? -p : p));
+            return;
+        }
+    }
+    const bigint *u = &a, *v = &b;
+    if (u->limbs.size() < v->limbs.size())
+    {
+        swap(u, v);
+    }
+    const size_t un = u->limbs.size(), vn = v->limbs.size(), xn = limbs.size();
+    if (vn == 1 && this != u)
+    {
+        const limb_t v0 = v->limbs[0];
+        if (limbs.empty() || negative == product_negative)
+        {
+            const size_t n = max(xn, un);
+            limbs.resize(n, 0);
+            limb_t *xp = limbs.data();
+            limb_t carry = addmul_1(xp, u->limbs.data(), un, v0);
+            carry = add_1(xp + un, xp + un, n - un, carry);
+            if (carry != 0)
+            {
+                limbs.push_back(carry);
+            }
+            negative = product_negative;
+            return;
+        }
+        /* |u| v0 < B^(un+1), so with two more limbs x keeps its sign and the borrow stops. */
+        if (xn >= un + 2)
+        {
+            limb_t *xp = limbs.data();
+            limb_t borrow = submul_1(xp, u->limbs.data(), un, v0);
+            sub_1(xp + un, xp + un, xn - un, borrow);
+            erase_left_zeros();
+            return;
+        }
+    }
+    /* Small products go to a per-thread buffer that is reused from one call to the next. It
+       outlives any arena, so it always comes from the global heap. Products of more than a few
+       Karatsuba thresholds, whose multiplication allocates scratch space anyway, go to a
+       temporary instead, so that one large call does not pin its memory for the life of the
+       thread. */
+    thread_local limb_vector cached_product;
+    limb_vector temporary_product;
+    limb_vector *product = &temporary_product;
+    if (un + vn <= 4 * tuning.mul_karatsuba)
+    {
+        product = &cached_product;
+        if (product->capacity() < un + vn)
+        {
+            bigint_memory_scope heap(pmr::new_delete_resource());
+            product->reserve(un + vn);
+        }
+    }
+    product->resize(un + vn);
+    mul(product->data(), u->limbs.data(), un, v->limbs.data(), vn);
+    const size_t pn = normalized_size(product->data(), un + vn);
+    const limb_t *pp = product->data();
+    if (limbs.empty() || negative == product_negative)
+    {
+        const size_t n = max(xn, pn);
+        limbs.resize(n, 0);
+        limb_t *xp = limbs.data();
+        const size_t m = min(xn, pn);
+        limb_t carry = add_n(xp, xp, pp, m);
+        if (pn > xn)
+        {
+            carry = add_1(xp + m, pp + m, n - m, carry);
+        }
+        else
+        {
+            carry = add_1(xp + m, xp + m, n - m, carry);
+        }
+        if (carry != 0)
+        {
+            limbs.push_back(carry);
+        }
+        negative = product_negative;
+    }
+    else if (cmp(limbs.data(), xn, pp, pn) >= 0)
+    {
+        limb_t *xp = limbs.data();
+        limb_t borrow = sub_n(xp, xp, pp, pn);
+        sub_1(xp + pn, xp + pn, xn - pn, borrow);
+        erase_left_zeros();
+    }
+    else
+    {
+        limbs.resize(pn, 0);
+        limb_t *xp = limbs.data();
+        limb_t borrow = sub_n(xp, pp, xp, xn);
+        sub_1(xp + xn, pp + xn, pn - xn, borrow);
+        negative = product_negative;
+        erase_left_zeros();
+    }
+}
+
+inline void addmul(bigint &x, const bigint &a, const bigint &b)
+{
+    x.add_product(a, b, false);
+}
+
+inline void submul(bigint &x, const bigint &a, const bigint &b)
+{
+    x.add_product(a, b, true);
+}
+
+inline void unsigned_division(const bigint &x, const bigint &y, bigint &q, bigint &r)
+{
+    using namespace bigint_detail;
+    const size_t xn = x.limbs.size(), yn = y.limbs.size();
+    if (yn == 0)
+    {
+        throw domain_error("division by zero");
+    }
+    if (cmp(x.limbs.data(), xn, y.limbs.data(), yn) < 0)
+    {
+        r = x;
+        r.negative = false;
+        q = 0;
+        return;
+    }
+    uint64_t exponent;
+    if (power_of_two(y.limbs.data(), yn, exponent))
+    {
+        /* The remainder is the low bits of x and the quotient the others. */
+        const size_t q_limbs = (size_t)(exponent / 64);
+        const unsigned bits = (unsigned)(exponent % 64);
+        limb_vector low(x.limbs.data(), x.limbs.data() + q_limbs + (bits != 0 ? 1 : 0));
+        if (bits != 0)
+        {
+            low.back() &= ((limb_t)1 << bits) - 1;
+        }
+        /* The shift rounds a negative number toward minus infinity, so only the magnitude of
+           one is shifted. */
+        if (x.negative)
+        {
+            q = x;
+            q.negative = false;
+            q >>= exponent;
+        }
+        else
+        {
+            bigint::shift_right(q, x, exponent);
+        }
+        r.limbs = move(low);
+        r.negative = false;
+        r.erase_left_zeros();
+        return;
+    }
+    if (xn == 1)
+    {
+        limb_t a = x.limbs[0], d = y.limbs[0];
+        q.limbs.assign(1, a / d);
+        q.negative = false;
+        r.limbs.assign(1, a % d);
+        r.negative = false;
+        q.erase_left_zeros();
+        r.erase_left_zeros();
+        return;
+    }
+    limb_vector quotient(xn - yn + 1), remainder(yn);
+    divrem(quotient.data(), remainder.data(), x.limbs.data(), xn, y.limbs.data(), yn);
+    q.limbs = move(quotient);
+    q.negative = false;
+    q.erase_left_zeros();
+    r.limbs = move(remainder);
+    r.negative = false;
+    r.erase_left_zeros();
+}
+
+inline pair<bigint, bigint> divmod(const bigint &x, const bigint &y)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::div, x.limbs.size());
+    pair<bigint, bigint> result;
+    bigint &q = result.first, &r = result.second;
+    unsigned_division(x, y, q, r);
+    q.negative = !q.limbs.empty() && x.negative != y.negative;
+    r.negative = !r.limbs.empty() && x.negative;
+    return result;
+}
+
+inline bigint &operator/=(bigint &x, const bigint &y)
+{
+    x = divmod(x, y).first;
+    return x;
+}
+/**
+ * @brief Division operation for bigint instances.
+ *
+ * @param x The left-hand side bigint.
+ *
+ * @param y The right-hand side bigint.
+ *
+ * @details This function computes the quotient x/y, truncated toward zero, and returns a new
+ * bigint with the result. This function uses divmod.
+ */
+inline bigint operator/(const bigint &x, const bigint &y)
+{
+    return divmod(x, y).first;
+}
+
+inline bigint &operator%=(bigint &x, const bigint &y)
+{
+    x = divmod(x, y).second;
+    return x;
+}
+/**
+ * @brief Modulo operation for bigint instances.
+ *
+ * @param x The left-hand side bigint.
+ *
+ * @param y The right-hand side bigint.
+ *
+ * @details This function computes the remainder x%y, which has the sign of x, and returns a
+ * new bigint with the result. This function uses divmod.
+ */
+inline bigint operator%(const bigint &x, const bigint &y)
+{
+    return divmod(x, y).second;
+}
+
+inline void bigint::shift_left(bigint &r, const bigint &x, uint64_t count)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::shift, x.limbs.size());
+    const size_t n = x.limbs.size();
+    if (n == 0 || count == 0)
+    {
+        r = x;
+        return;
+    }
+    const size_t q = (size_t)(count / 64);
+    const unsigned bits = (unsigned)(count % 64);
+    r.limbs.resize(n + q + 1);
+    const limb_t *in = x.limbs.data();
+    limb_t *out = r.limbs.data();
+    /* From the most significant limb down, so that in place every limb is read before it is
+       overwritten. */
+    if (bits != 0)
+    {
+        out[n + q] = in[n - 1] >> (64 - bits);
+        for (size_t i = n - 1; i > 0; i--)
+        {
+            out[i + q] = (in[i] << bits) | (in[i - 1] >> (64 - bits));
+        }
+        out[q] = in[0] << bits;
+    }
+    else
+    {
+        out[n + q] = 0;
+        move_backward(in, in + n, out + n + q);
+    }
+    fill(out, out + q, 0);
+    r.negative = x.negative;
+    r.erase_left_zeros();
+}
+
+inline void bigint::shift_right(bigint &r, const bigint &x, uint64_t count)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::shift, x.limbs.size());
+    const size_t n = x.limbs.size();
+    if (n == 0 || count == 0)
+    {
+        r = x;
+        return;
+    }
+    if (count / 64 >= n)
+    {
+        r = x.negative ? -1 : 0;
+        return;
+    }
+    const size_t q = (size_t)(count / 64), m = n - q;
+    const unsigned bits = (unsigned)(count % 64);
+    const bool negative = x.negative;
+    /* Rounding toward minus infinity: the magnitude of a negative number is rounded up when
+       a set bit is shifted out. */
+    const bool round_up = negative && (normalized_size(x.limbs.data(), q) != 0 ||
+                                       (bits != 0 && (x.limbs[q] << (64 - bits)) != 0));
+    if (&r != &x)
+    {
+        r.limbs.resize(m);
+    }
+    const limb_t *in = x.limbs.data() + q;
+    limb_t *out = r.limbs.data();
+    /* From the least significant limb up, so that in place every limb is read before it is
+       overwritten. */
+    if (bits != 0)
+    {
+        for (size_t i = 0; i + 1 < m; i++)
+        {
+            out[i] = (in[i] >> bits) | (in[i + 1] << (64 - bits));
+        }
+        out[m - 1] = in[m - 1] >> bits;
+    }
+    else
+    {
+        copy(in, in + m, out);
+    }
+    r.limbs.resize(m);
+    if (round_up && add_1(out, out, m, 1) != 0)
+    {
+        r.limbs.push_back(1);
+    }
+    r.negative = negative;
+    r.erase_left_zeros();
+}
+
+inline bigint &operator<<=(bigint &x, uint64_t count)
+{
+    bigint::shift_left(x, x, count);
+    return x;
+}
+
+inline bigint &operator>>=(bigint &x, uint64_t count)
+{
+    bigint::shift_right(x, x, count);
+    return x;
+}
+
+inline bigint operator<<(const bigint &x, uint64_t count)
+{
+    bigint result;
+    bigint::shift_left(result, x, count);
+    return result;
+}
+
+inline bigint operator<<(bigint &&x, uint64_t count)
+{
+    x <<= count;
+    return move(x);
+}
+
+inline bigint operator>>(const bigint &x, uint64_t count)
+{
+    bigint result;
+    bigint::shift_right(result, x, count);
+    return result;
+}
+
+inline bigint operator>>(bigint &&x, uint64_t count)
+{
+    x >>= count;
+    return move(x);
+}
+
+template <class Op>
+inline bigint bigint::bitwise(const bigint &x, const bigint &y, size_t n, Op op)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::bitwise, max(x.limbs.size(), y.limbs.size()));
+    bigint result;
+    if (x.is_small() && y.is_small())
+    {
+        /* The native two's complement operation on the 128-bit values. */
+        result.set_small(op(x.small_value(), y.small_value()));
+        return result;
+    }
+    result.limbs.resize(n + 1);
+    result.negative = bitwise_n(result.limbs.data(), n, x.limbs.data(), x.limbs.size(), x.negative,
+                                y.limbs.data(), y.limbs.size(), y.negative, op);
+    result.erase_left_zeros();
+    return result;
+}
+
+inline bigint operator&(const bigint &x, const bigint &y)
+{
+    const size_t xn = x.limbs.size(), yn = y.limbs.size();
+    /* The bits of a non-negative operand above its magnitude are clear, and so are the ones of
+       the result. */
+    const size_t n = !x.negative ? (!y.negative ? min(xn, yn) : xn) : (!y.negative ? yn : max(xn, yn));
+    return bigint::bitwise(x, y, n, [](auto a, auto b) { return a & b; });
+}
+
+inline bigint operator|(const bigint &x, const bigint &y)
+{
+    return bigint::bitwise(x, y, max(x.limbs.size(), y.limbs.size()), [](auto a, auto b) { return a | b; });
+}
+
+inline bigint operator^(const bigint &x, const bigint &y)
+{
+    return bigint::bitwise(x, y, max(x.limbs.size(), y.limbs.size()), [](auto a, auto b) { return a ^ b; });
+}
+
+inline bigint operator~(bigint x)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::bitwise, x.limbs.size());
+    /* ~x == -x - 1: the magnitude of a negative number decreases by one, and the one of a
+       non-negative number increases by one as it becomes negative. */
+    if (x.negative)
+    {
+        sub_1(x.limbs.data(), x.limbs.data(), x.limbs.size(), 1);
+        x.negative = false;
+    }
+    else
+    {
+        if (add_1(x.limbs.data(), x.limbs.data(), x.limbs.size(), 1) != 0)
+        {
+            x.limbs.push_back(1);
+        }
+        x.negative = true;
+    }
+    x.erase_left_zeros();
+    return x;
+}
+
+inline bigint &operator&=(bigint &x, const bigint &y)
+{
+    if (x.negative || y.negative)
+    {
+        x = x & y;
+        return x;
+    }
+    bigint_detail::operation_scope scope(bigint_stats::operation::bitwise, max(x.limbs.size(), y.limbs.size()));
+    const size_t n = min(x.limbs.size(), y.limbs.size());
+    x.limbs.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        x.limbs[i] &= y.limbs[i];
+    }
+    x.erase_left_zeros();
+    return x;
+}
+
+inline bigint &operator|=(bigint &x, const bigint &y)
+{
+    if (x.negative || y.negative)
+    {
+        x = x | y;
+        return x;
+    }
+    bigint_detail::operation_scope scope(bigint_stats::operation::bitwise, max(x.limbs.size(), y.limbs.size()));
+    const size_t yn = y.limbs.size();
+    if (x.limbs.size() < yn)
+    {
+        x.limbs.resize(yn);
+    }
+    for (size_t i = 0; i < yn; i++)
+    {
+        x.limbs[i] |= y.limbs[i];
+    }
+    return x;
+}
+
+inline bigint &operator^=(bigint &x, const bigint &y)
+{
+    if (x.negative || y.negative)
+    {
+        x = x ^ y;
+        return x;
+    }
+    bigint_detail::operation_scope scope(bigint_stats::operation::bitwise, max(x.limbs.size(), y.limbs.size()));
+    const size_t yn = y.limbs.size();
+    if (x.limbs.size() < yn)
+    {
+        x.limbs.resize(yn);
+    }
+    for (size_t i = 0; i < yn; i++)
+    {
+        x.limbs[i] ^= y.limbs[i];
+    }
+    x.erase_left_zeros();
+    return x;
+}
+
+inline uint64_t bigint::bit_length() const
+{
+    const size_t n = limbs.size();
+    return n == 0 ? 0 : 64 * (uint64_t)(n - 1) + (uint64_t)bit_width(limbs[n - 1]);
+}
+
+inline uint64_t bigint::popcount() const
+{
+    uint64_t count = 0;
+    for (size_t i = 0; i < limbs.size(); i++)
+    {
+        count += (uint64_t)std::popcount(limbs[i]);
+    }
+    return count;
+}
+
+inline uint64_t bigint::count_trailing_zeros() const
+{
+    if (limbs.empty())
+    {
+        throw domain_error("count_trailing_zeros of zero");
+    }
+    size_t i = 0;
+    while (limbs[i] == 0)
+    {
+        i++;
+    }
+    return 64 * (uint64_t)i + (uint64_t)countr_zero(limbs[i]);
+}
+
+inline bool bigint::test_bit(uint64_t i) const
+{
+    const size_t n = limbs.size();
+    const bool magnitude_bit = i / 64 < n && ((limbs[(size_t)(i / 64)] >> (i % 64)) & 1) != 0;
+    if (!negative)
+    {
+        return magnitude_bit;
+    }
+    /* -m == ~(m - 1): below the lowest set bit of m both are clear, at that bit both are set, and
+       above it the bits of -m are the complements of the ones of m. */
+    const uint64_t lowest = count_trailing_zeros();
+    return i < lowest ? false : i == lowest ? true : !magnitude_bit;
+}
+
+inline void bigint::set_bit(uint64_t i)
+{
+    if (negative)
+    {
+        if (!test_bit(i))
+        {
+            bigint power;
+            power.set_bit(i);
+            *this += power;
+        }
+        return;
+    }
+    const size_t limb = (size_t)(i / 64);
+    if (limb >= limbs.size())
+    {
+        limbs.resize(limb + 1);
+    }
+    limbs[limb] |= (bigint_detail::limb_t)1 << (i % 64);
+}
+
+inline void bigint::clear_bit(uint64_t i)
+{
+    if (negative)
+    {
+        if (test_bit(i))
+        {
+            bigint power;
+            power.set_bit(i);
+            *this -= power;
+        }
+        return;
+    }
+    const size_t limb = (size_t)(i / 64);
+    if (limb < limbs.size())
+    {
+        limbs[limb] &= ~((bigint_detail::limb_t)1 << (i % 64));
+        erase_left_zeros();
+    }
+}
+
+/**
+ * @brief Arithmetic modulo a fixed positive integer m.
+ *
+ * @details The constants that depend on m are computed once, when the context is built, so it
+ * should be kept and reused for all the operations with the same modulus. Single products are
+ * reduced with Barrett's method, which replaces the division by m with two multiplications by
+ * a precomputed reciprocal and works for any m. Exponentiation with an odd modulus works in
+ * Montgomery form, where a reduction is a single pass of addmul_1 over the low half of the
+ * product; with an even modulus, for which Montgomery form does not exist, it uses Barrett.
+ * Every result is in the range [0, m), whatever the sign of the arguments.
+ */
+class bigint_modulus
+{
+public:
+    /**
+     * @brief Builds the context for the modulus m.
+     *
+     * @param m The modulus. A domain_error is thrown if it is not positive.
+     */
+    explicit bigint_modulus(const bigint &m);
+    /**
+     * @brief Returns the modulus.
+     */
+    const bigint &modulus() const
+    {
+        return m;
+    }
+    /**
+     * @brief Returns true if exponentiation uses Montgomery form, that is, if the modulus is odd.
+     */
+    bool uses_montgomery() const
+    {
+        return montgomery;
+    }
+    /**
+     * @brief Returns x mod m, in the range [0, m).
+     */
+    bigint reduce(const bigint &x) const;
+    /**
+     * @brief Returns a * b mod m.
+     */
+    bigint mulmod(const bigint &a, const bigint &b) const;
+    /**
+     * @brief Returns a * a mod m, using squaring for the product.
+     */
+    bigint sqrmod(const bigint &a) const;
+    /**
+     * @brief Returns base^exponent mod m.
+     *
+     * @param base The base, which may be negative or larger than m.
+     *
+     * @param exponent The exponent. A domain_error is thrown if it is negative.
+     *
+     * @details Sliding-window exponentiation: the odd powers base^1, base^3, ...,
+     * base^(2^k - 1) are precomputed, and the exponent is scanned from the most significant bit
+     * with one squaring per bit and one multiplication per window of up to k bits starting and
+     * ending with a one. The window size k grows with the size of the exponent.
+     */
+    bigint powmod(const bigint &base, const bigint &exponent) const;
+
+private:
+    using limb_t = bigint_detail::limb_t;
+
+    bigint m;
+    size_t n;
+    /* floor(B^(2n) / m), n + 1 limbs, for Barrett reduction. */
+    bigint_detail::limb_vector mu;
+    /* Montgomery constants, for an odd m: -m^-1 mod B and R^2 mod m with R = B^n. */
+    bool montgomery;
+    limb_t m_inv = 0;
+    bigint_detail::limb_vector r2;
+
+    /* Scratch space for one reduction of either kind. */
+    size_t reduction_scratch_size() const
+    {
+        return 5 * n + 4;
+    }
+    void barrett(limb_t *r, const limb_t *x, limb_t *scratch) const;
+    void redc(limb_t *r, limb_t *t) const;
+    void residue(limb_t *r, const limb_t *x, size_t xn, bool negative, limb_t *padded, limb_t *scratch) const;
+    void residue(limb_t *r, const bigint &x) const;
+    bigint to_bigint(const limb_t *r) const;
+
+    friend void mulmod(bigint_batch &r, const bigint_batch &a, const bigint_batch &b, const bigint_modulus &m);
+};
+
+inline bigint_modulus::bigint_modulus(const bigint &m_) : m(m_), n(m_.limbs.size())
+{
+    using namespace bigint_detail;
+    if (m.negative || m.limbs.empty())
+    {
+        throw domain_error("modulus must be positive");
+    }
+    /* B^(2n) = mu m + (R^2 mod m), both constants from one division. */
+    limb_vector power(2 * n + 1), quotient(n + 2);
+    power[2 * n] = 1;
+    r2.resize(n);
+    divrem(quotient.data(), r2.data(), power.data(), 2 * n + 1, m.limbs.data(), n);
+    mu.assign(quotient.data(), quotient.data() + n + 1);
+    if (quotient[n + 1] != 0)
+    {
+        /* m = B^(n-1), whose mu = B^(n+1) needs one more limb. B^(n+1) - 1 makes the quotient
+           estimate at most one unit smaller, which the final correction absorbs. */
+        fill(mu.data(), mu.data() + n + 1, ~(limb_t)0);
+    }
+    montgomery = (m.limbs[0] & 1) != 0;
+    if (montgomery)
+    {
+        /* Newton iteration doubles the number of correct low bits of the inverse each step. */
+        limb_t inverse = m.limbs[0];
+        for (int i = 0; i < 5; i++)
+        {
+            inverse *= 2 - m.limbs[0] * inverse;
+        }
+        m_inv = 0 - inverse;
+    }
+}
+/* r = x mod m for a 2n-limb x < B^(2n), with the quotient estimated as
+   floor(floor(x / B^(n-1)) mu / B^(n+1)), which is at most three units too small. */
+inline void bigint_modulus::barrett(limb_t *r, const limb_t *x, limb_t *scratch) const
+{
+    using namespace bigint_detail;
+    count_algorithm(bigint_stats::algorithm::reduce_barrett);
+    const limb_t *mp = m.limbs.data();
+    limb_t *q2 = scratch, *qm = scratch + 2 * n + 2;
+    mul(q2, x + n - 1, n + 1, mu.data(), n + 1);
+    const limb_t *q3 = q2 + n + 1;
+    const size_t q3n = normalized_size(q3, n + 1);
+    /* Only the low n + 1 limbs of x - q3 m are needed, since the result is below 4m. */
+    limb_t *rp = qm + 2 * n + 1;
+    fill(qm, qm + 2 * n + 1, 0);
+    if (q3n > 0)
+    {
+        if (q3n >= n)
+        {
+            mul(qm, q3, q3n, mp, n);
+        }
+        else
+        {
+            mul(qm, mp, n, q3, q3n);
+        }
+    }
+    sub_n(rp, x, qm, n + 1);
+    while (rp[n] != 0 || cmp_n(rp, mp, n) >= 0)
+    {
+        rp[n] -= sub_n(rp, rp, mp, n);
+    }
+    copy(rp, rp + n, r);
+}
+/* r = t R^-1 mod m for a 2n-limb t < m R, clobbering t. Each step adds the multiple of m that
+   clears the lowest limb of t, and keeps the carry of that step in the limb it cleared. */
+inline void bigint_modulus::redc(limb_t *r, limb_t *t) const
+{
+    using namespace bigint_detail;
+    count_algorithm(bigint_stats::algorithm::reduce_montgomery);
+    const limb_t *mp = m.limbs.data();
+    for (size_t i = 0; i < n; i++)
+    {
+        limb_t q = t[i] * m_inv;
+        t[i] = addmul_1(t + i, mp, n, q);
+    }
+    limb_t carry = add_n(r, t + n, t, n);
+    if (carry != 0 || cmp_n(r, mp, n) >= 0)
+    {
+        sub_n(r, r, mp, n);
+    }
+}
+/* r = x mod m as n limbs, for the xn-limb magnitude x taken as negative if negative is set.
+   padded and scratch are work space of 2n and reduction_scratch_size() limbs. */
+inline void bigint_modulus::residue(limb_t *r, const limb_t *x, size_t xn, bool negative, limb_t *padded, limb_t *scratch) const
+{
+    using namespace bigint_detail;
+    xn = normalized_size(x, xn);
+    if (xn <= 2 * n)
+    {
+        copy(x, x + xn, padded);
+        fill(padded + xn, padded + 2 * n, 0);
+        barrett(r, padded, scratch);
+    }
+    else
+    {
+        limb_vector quotient(xn - n + 1);
+        divrem(quotient.data(), r, x, xn, m.limbs.data(), n);
+    }
+    if (negative && normalized_size(r, n) != 0)
+    {
+        sub_n(r, m.limbs.data(), r, n);
+    }
+}
+/* r = x mod m as n limbs. */
+inline void bigint_modulus::residue(limb_t *r, const bigint &x) const
+{
+    bigint_detail::limb_vector padded(2 * n), scratch(reduction_scratch_size());
+    residue(r, x.limbs.data(), x.limbs.size(), x.negative, padded.data(), scratch.data());
+}
+inline bigint bigint_modulus::to_bigint(const limb_t *r) const
+{
+    bigint result;
+    result.limbs.assign(r, r + n);
+    result.erase_left_zeros();
+    return result;
+}
+
+inline bigint bigint_modulus::reduce(const bigint &x) const
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::mulmod, x.limbs.size());
+    bigint_detail::limb_vector r(n);
+    residue(r.data(), x);
+    return to_bigint(r.data());
+}
+
+inline bigint bigint_modulus::mulmod(const bigint &a, const bigint &b) const
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::mulmod, n);
+    limb_vector ra(n), rb(n), product(2 * n), scratch(reduction_scratch_size());
+    residue(ra.data(), a);
+    residue(rb.data(), b);
+    mul(product.data(), ra.data(), n, rb.data(), n);
+    barrett(ra.data(), product.data(), scratch.data());
+    return to_bigint(ra.data());
+}
+
+inline bigint bigint_modulus::sqrmod(const bigint &a) const
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::mulmod, n);
+    limb_vector ra(n), product(2 * n), scratch(reduction_scratch_size());
+    residue(ra.data(), a);
+    mul(product.data(), ra.data(), n, ra.data(), n);
+    barrett(ra.data(), product.data(), scratch.data());
+    return to_bigint(ra.data());
+}
+
+inline bigint bigint_modulus::powmod(const bigint &base, const bigint &exponent) const
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::powmod, n);
+    if (exponent.negative)
+    {
+        throw domain_error("negative exponent");
+    }
+    if (exponent.limbs.empty())
+    {
+        return reduce(1);
+    }
+    const limb_t *e = exponent.limbs.data();
+    const size_t bits = 64 * exponent.limbs.size() - (size_t)__builtin_clzll(exponent.limbs.back());
+    auto bit = [&](size_t i)
+    {
+        return (e[i / 64] >> (i % 64)) & 1;
+    };
+    /* Window sizes from 1 to 7 bits, at the exponent sizes where the saved multiplications
+       start to pay for a table twice as large. */
+    static const size_t window_limits[] = {7, 25, 81, 241, 673, 1793};
+    size_t k = 1;
+    for (size_t limit : window_limits)
+    {
+        k += bits > limit;
+    }
+
+    limb_vector product(2 * n), scratch(max(mul_n_scratch_size(n, false), mul_n_scratch_size(n, true)));
+    limb_vector reduction(reduction_scratch_size());
+    /* r = a b, in Montgomery form or not, all operands being n-limb residues. */
+    auto multiply = [&](limb_t *r, const limb_t *a, const limb_t *b)
+    {
+        mul_n(product.data(), a, b, n, scratch.data());
+        if (montgomery)
+        {
+            redc(r, product.data());
+        }
+        else
+        {
+            barrett(r, product.data(), reduction.data());
+        }
+    };
+
+    /* Odd powers base^(2i + 1) for i < 2^(k-1). */
+    limb_vector table(n << (k - 1)), square(n);
+    residue(table.data(), base);
+    if (montgomery)
+    {
+        multiply(table.data(), table.data(), r2.data());
+    }
+    if (k > 1)
+    {
+        multiply(square.data(), table.data(), table.data());
+        for (size_t i = 1; i < ((size_t)1 << (k - 1)); i++)
+        {
+            multiply(table.data() + i * n, table.data() + (i - 1) * n, square.data());
+        }
+    }
+
+    limb_vector result(n);
+    bool started = false;
+    for (size_t i = bits; i-- > 0;)
+    {
+        if (bit(i) == 0)
+        {
+            multiply(result.data(), result.data(), result.data());
+            continue;
+        }
+        /* The longest window of at most k bits that starts at bit i and ends with a one. */
+        size_t j = i + 1 >= k ? i + 1 - k : 0;
+        while (bit(j) == 0)
+        {
+            j++;
+        }
+        size_t window = 0;
+        for (size_t b = i + 1; b-- > j;)
+        {
+            window = window << 1 | bit(b);
+        }
+        const limb_t *power = table.data() + (window >> 1) * n;
+        if (started)
+        {
+            for (size_t s = i + 1; s-- > j;)
+            {
+                multiply(result.data(), result.data(), result.data());
+            }
+            multiply(result.data(), result.data(), power);
+        }
+        else
+        {
+            copy(power, power + n, result.data());
+            started = true;
+        }
+        i = j;
+    }
+    if (montgomery)
+    {
+        fill(product.data(), product.data() + 2 * n, 0);
+        copy(result.data(), result.data() + n, product.data());
+        redc(result.data(), product.data());
+    }
+    return to_bigint(result.data());
+}
+
+/**
+ * @brief Computes base^exponent mod modulus.
+ *
+ * @details Convenience wrapper building a bigint_modulus for a single exponentiation; a
+ * context should be kept instead when the same modulus is used repeatedly.
+ *
+ * @return The result, in the range [0, modulus).
+ */
+inline bigint powmod(const bigint &base, const bigint &exponent, const bigint &modulus)
+{
+    return bigint_modulus(modulus).powmod(base, exponent);
+}
+
+/**
+ * @brief Number-theoretic algorithms working on bigint magnitudes.
+ */
+namespace bigint_detail
+{
+    struct number_theory
+    {
+        /* A 2x2 matrix of cofactors, with determinant det = 1 or -1. */
+        struct matrix
+        {
+            bigint m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+            int det = 1;
+
+            bool is_identity() const
+            {
+                return m01 == 0 && m10 == 0 && m00 == 1 && m11 == 1;
+            }
+        };
+        /* Temporaries reused by the steps of one computation. */
+        struct workspace
+        {
+            bigint t0, t1, t2, t3;
+        };
+
+        static bigint bigint_from_limb(limb_t value)
+        {
+            bigint result;
+            result.set_small(value);
+            return result;
+        }
+        static size_t bit_length(const bigint &x)
+        {
+            return x.limbs.empty() ? 0 : 64 * x.limbs.size() - (size_t)__builtin_clzll(x.limbs.back());
+        }
+        /* floor(|x| / 2^shift) mod 2^64. */
+        static limb_t bits_from(const bigint &x, size_t shift)
+        {
+            const size_t i = shift / 64, offset = shift % 64;
+            if (i >= x.limbs.size())
+            {
+                return 0;
+            }
+            limb_t value = x.limbs[i] >> offset;
+            if (offset != 0 && i + 1 < x.limbs.size())
+            {
+                value |= x.limbs[i + 1] << (64 - offset);
+            }
+            return value;
+        }
+        /* floor(|x| / 2^shift), with the sign of x. */
+        static bigint shift_right(const bigint &x, size_t shift)
+        {
+            bigint result;
+            const size_t skip = shift / 64;
+            if (skip >= x.limbs.size())
+            {
+                return result;
+            }
+            const size_t n = x.limbs.size() - skip;
+            result.limbs.resize(n);
+            if (shift % 64 != 0)
+            {
+                rshift(result.limbs.data(), x.limbs.data() + skip, n, (unsigned)(shift % 64));
+            }
+            else
+            {
+                copy(x.limbs.data() + skip, x.limbs.data() + x.limbs.size(), result.limbs.data());
+            }
+            result.negative = x.negative;
+            result.erase_left_zeros();
+            return result;
+        }
+        /* x 2^shift. */
+        static bigint shift_left(const bigint &x, size_t shift)
+        {
+            bigint result;
+            if (x.limbs.empty())
+            {
+                return result;
+            }
+            const size_t skip = shift / 64, n = x.limbs.size();
+            result.limbs.resize(skip + n + 1);
+            if (shift % 64 != 0)
+            {
+                result.limbs[skip + n] = lshift(result.limbs.data() + skip, x.limbs.data(), n, (unsigned)(shift % 64));
+            }
+            else
+            {
+                copy(x.limbs.data(), x.limbs.data() + n, result.limbs.data() + skip);
+            }
+            result.negative = x.negative;
+            result.erase_left_zeros();
+            return result;
+        }
+
+        /* |x| mod 2^bits. */
+        static bigint low_bits(const bigint &x, size_t bits)
+        {
+            bigint result;
+            const size_t n = min(x.limbs.size(), (bits + 63) / 64);
+            result.limbs.assign(x.limbs.data(), x.limbs.data() + n);
+            if (n == (bits + 63) / 64 && bits % 64 != 0)
+            {
+                result.limbs[n - 1] &= ((limb_t)1 << (bits % 64)) - 1;
+            }
+            result.erase_left_zeros();
+            return result;
+        }
+
+        /* Square root s and remainder r = a - s^2 of 2^(n-2) <= a < 2^n, for an even n, with
+           Zimmermann's Karatsuba square root: the root of the top half of a, computed
+           recursively, gives the top half of s, and the bottom half is the quotient of a division
+           by it. There is a division of half the size and a squaring of a quarter of the size
+           per level, instead of a division at full size as in Newton's iteration. */
+        static void sqrtrem(bigint &s, bigint &r, const bigint &a, size_t n)
+        {
+            count_algorithm(bigint_stats::algorithm::sqrtrem);
+            if (n <= 64)
+            {
+                const limb_t value = a.limbs.empty() ? 0 : a.limbs[0];
+                limb_t root = (limb_t)sqrt((double)value);
+                while ((dlimb_t)root * root > value)
+                {
+                    root--;
+                }
+                while ((dlimb_t)(root + 1) * (root + 1) <= value)
+                {
+                    root++;
+                }
+                s = bigint_from_limb(root);
+                r = bigint_from_limb(value - root * root);
+                return;
+            }
+            const size_t k = n / 4;
+            bigint top_root, top_remainder;
+            sqrtrem(top_root, top_remainder, shift_right(a, 2 * k), n - 2 * k);
+            const bigint low = low_bits(a, 2 * k);
+            auto [q, u] = divmod(shift_left(top_remainder, k) + shift_right(low, k), shift_left(top_root, 1));
+            s = shift_left(top_root, k) + q;
+            r = shift_left(u, k) + low_bits(low, k);
+            submul(r, q, q);
+            while (r.negative)
+            {
+                r += s;
+                s -= 1;
+                r += s;
+            }
+        }
+        /* floor(x^(1/k)) for x > 0 and k >= 2. */
+        static bigint root(const bigint &x, uint64_t k)
+        {
+            const size_t bits = bit_length(x);
+            if (k == 2)
+            {
+                bigint s, r;
+                sqrtrem(s, r, x, bits + (bits & 1));
+                return s;
+            }
+            if (k >= bits)
+            {
+                return 1;
+            }
+            const size_t root_bits = (bits - 1) / k + 1;
+            if (root_bits <= 32)
+            {
+                /* A root below 2^32 computed in double precision from the top 53 bits of x is off
+                   by at most one. */
+                const size_t shift = bits > 53 ? bits - 53 : 0;
+                const double top = (double)bits_from(x, shift);
+                bigint r = (int64_t)exp2((log2(top) + (double)shift) / (double)k);
+                while (pow(r, k) > x)
+                {
+                    r -= 1;
+                }
+                while (pow(r + 1, k) <= x)
+                {
+                    r += 1;
+                }
+                return r;
+            }
+            /* The root of the top bits of x, scaled back, is above the root of x by less than
+               2^(shift+1); with this shift one Newton step brings the error below one. */
+            const size_t log_k = 64 - (size_t)__builtin_clzll(k);
+            const size_t shift = (root_bits - 3 - log_k) / 2;
+            bigint r = shift_left(root(shift_right(x, shift * k), k) + 1, shift);
+            bigint power = pow(r, k - 1);
+            r *= bigint((int64_t)(k - 1));
+            r += x / power;
+            r /= bigint((int64_t)k);
+            /* Newton's iteration started above the root stays above its integer part. */
+            while (pow(r, k) > x)
+            {
+                r -= 1;
+            }
+            return r;
+        }
+
+        static limb_t gcd_1(limb_t u, limb_t v)
+        {
+            if (u == 0 || v == 0)
+            {
+                return u | v;
+            }
+            const int shift = __builtin_ctzll(u | v);
+            u >>= __builtin_ctzll(u);
+            do
+            {
+                v >>= __builtin_ctzll(v);
+                if (u > v)
+                {
+                    swap(u, v);
+                }
+                v -= u;
+            } while (v != 0);
+            return u << shift;
+        }
+        /* r = x a + y b for single-limb cofactors x and y; r must not be a or b. */
+        static void combine(bigint &r, const bigint &a, int64_t x, const bigint &b, int64_t y)
+        {
+            bool a_negative = a.negative != (x < 0), b_negative = b.negative != (y < 0);
+            if (x == 0)
+            {
+                a_negative = b_negative;
+            }
+            else if (y == 0)
+            {
+                b_negative = a_negative;
+            }
+            const size_t an = a.limbs.size(), bn = b.limbs.size(), n = max(an, bn) + 1;
+            r.limbs.resize(n);
+            limb_t *rp = r.limbs.data();
+            rp[an] = mul_1(rp, a.limbs.data(), an, x < 0 ? 0 - (limb_t)x : (limb_t)x);
+            fill(rp + an + 1, rp + n, 0);
+            const limb_t cy = y < 0 ? 0 - (limb_t)y : (limb_t)y;
+            r.negative = a_negative;
+            if (a_negative == b_negative)
+            {
+                limb_t carry = addmul_1(rp, b.limbs.data(), bn, cy);
+                add_1(rp + bn, rp + bn, n - bn, carry);
+            }
+            else if (sub_1(rp + bn, rp + bn, n - bn, submul_1(rp, b.limbs.data(), bn, cy)) != 0)
+            {
+                negate_n(rp, n);
+                r.negative = !a_negative;
+            }
+            r.erase_left_zeros();
+        }
+        /* Makes a and b non-negative with a >= b, changing the signs and the order of the
+           columns of m so that it still maps the new pair to the original one. */
+        static void normalize(bigint &a, bigint &b, matrix *m)
+        {
+            if (a.negative)
+            {
+                a.negative = false;
+                if (m != nullptr)
+                {
+                    m->m00 = -move(m->m00);
+                    m->m10 = -move(m->m10);
+                    m->det = -m->det;
+                }
+            }
+            if (b.negative)
+            {
+                b.negative = false;
+                if (m != nullptr)
+                {
+                    m->m01 = -move(m->m01);
+                    m->m11 = -move(m->m11);
+                    m->det = -m->det;
+                }
+            }
+            if (a < b)
+            {
+                swap(a, b);
+                if (m != nullptr)
+                {
+                    swap(m->m00, m->m01);
+                    swap(m->m10, m->m11);
+                    m->det = -m->det;
+                }
+            }
+        }
+        /* Replaces (a; b) by m^-1 (a; b) = det (m11 a - m01 b; m00 b - m10 a). */
+        static void apply_inverse(bigint &a, bigint &b, matrix &m, workspace &w)
+        {
+            w.t0 = m.m11 * a;
+            submul(w.t0, m.m01, b);
+            w.t1 = m.m00 * b;
+            submul(w.t1, m.m10, a);
+            if (m.det < 0)
+            {
+                w.t0 = -move(w.t0);
+                w.t1 = -move(w.t1);
+            }
+            swap(a, w.t0);
+            swap(b, w.t1);
+            normalize(a, b, &m);
+        }
+        /* m = m n. */
+        static void multiply(matrix &m, const matrix &n, workspace &w)
+        {
+            w.t0 = m.m00 * n.m00;
+            addmul(w.t0, m.m01, n.m10);
+            w.t1 = m.m00 * n.m01;
+            addmul(w.t1, m.m01, n.m11);
+            w.t2 = m.m10 * n.m00;
+            addmul(w.t2, m.m11, n.m10);
+            w.t3 = m.m10 * n.m01;
+            addmul(w.t3, m.m11, n.m11);
+            swap(m.m00, w.t0);
+            swap(m.m01, w.t1);
+            swap(m.m10, w.t2);
+            swap(m.m11, w.t3);
+            m.det *= n.det;
+        }
+
+        /* The steps below replace (a, b), with a >= b > 0, by (b, a mod b) one or more times and
+           multiply m, if given, by the matrix of each step, so that m always maps the current
+           pair to the original one. A bound s > 0 forbids the steps that would make b < 2^s. */
+
+        /* A single step with a full division. Returns false if it was forbidden. */
+        static bool division_step(bigint &a, bigint &b, size_t s, matrix *m, workspace &w)
+        {
+            unsigned_division(a, b, w.t0, w.t1);
+            if (s > 0 && bit_length(w.t1) <= s)
+            {
+                return false;
+            }
+            swap(a, b);
+            swap(b, w.t1);
+            if (m != nullptr)
+            {
+                /* (a; b) = (q 1; 1 0) (b; a mod b). */
+                w.t2 = m->m00 * w.t0;
+                w.t2 += m->m01;
+                swap(m->m01, m->m00);
+                swap(m->m00, w.t2);
+                w.t2 = m->m10 * w.t0;
+                w.t2 += m->m11;
+                swap(m->m11, m->m10);
+                swap(m->m10, w.t2);
+                m->det = -m->det;
+            }
+            return true;
+        }
+        /* As many steps as can be determined from the top 128 bits of a and b, with cofactors
+           below 2^62. Returns false if none could. */
+        static bool lehmer_step(bigint &a, bigint &b, size_t s, matrix *m, workspace &w)
+        {
+            count_algorithm(bigint_stats::algorithm::gcd_lehmer);
+            const size_t bits = bit_length(a);
+            const size_t shift = bits > 128 ? bits - 128 : 0;
+            dlimb_t r0 = (dlimb_t)bits_from(a, shift + 64) << 64 | bits_from(a, shift);
+            dlimb_t r1 = (dlimb_t)bits_from(b, shift + 64) << 64 | bits_from(b, shift);
+            if (r1 == 0)
+            {
+                return false;
+            }
+            /* The remainders of the whole numbers, divided by 2^shift, differ from r by less
+               than the largest cofactor c, so r - c >= bound keeps them at least 2^s. */
+            dlimb_t bound = 1;
+            if (s > shift)
+            {
+                bound = s - shift >= 128 ? ~(dlimb_t)0 : (dlimb_t)1 << (s - shift);
+            }
+            int64_t x0 = 1, y0 = 0, x1 = 0, y1 = 1;
+            limb_t c1 = 1;
+            size_t steps = 0;
+            while (r1 != 0)
+            {
+                /* Most quotients are 1, which saves a division. */
+                dlimb_t q = 1;
+                if (r0 - r1 >= r1)
+                {
+                    q = (r0 >> 64) == 0 ? (limb_t)r0 / (limb_t)r1 : r0 / r1;
+                }
+                if (q > ((limb_t)1 << 61) / (c1 + 1))
+                {
+                    break;
+                }
+                const dlimb_t r2 = r0 - q * r1;
+                const int64_t x2 = x0 - (int64_t)q * x1, y2 = y0 - (int64_t)q * y1;
+                const limb_t c2 = (limb_t)max(abs(x2), abs(y2));
+                if (shift != 0)
+                {
+                    /* Jebelean's condition: the quotients so far are those of the whole
+                       numbers if r2 >= |c2| and r1 - r2 >= |c2 - c1| for both cofactors. */
+                    const limb_t d = (limb_t)max(abs(x2 - x1), abs(y2 - y1));
+                    if (r2 < c2 || r1 - r2 < d || r2 - c2 < bound)
+                    {
+                        break;
+                    }
+                }
+                else if (r2 < bound)
+                {
+                    break;
+                }
+                r0 = r1;
+                r1 = r2;
+                x0 = x1;
+                y0 = y1;
+                x1 = x2;
+                y1 = y2;
+                c1 = c2;
+                steps++;
+            }
+            if (steps == 0)
+            {
+                return false;
+            }
+            combine(w.t0, a, x0, b, y0);
+            combine(w.t1, a, x1, b, y1);
+            swap(a, w.t0);
+            swap(b, w.t1);
+            if (m != nullptr)
+            {
+                /* (a'; b') = C (a; b) with det C = (-1)^steps, so m becomes m C^-1, where
+                   C^-1 = det C (y1 -y0; -x1 x0). */
+                const int64_t sign = steps % 2 == 0 ? 1 : -1;
+                combine(w.t0, m->m00, sign * y1, m->m01, -sign * x1);
+                combine(w.t1, m->m00, -sign * y0, m->m01, sign * x0);
+                combine(w.t2, m->m10, sign * y1, m->m11, -sign * x1);
+                combine(w.t3, m->m10, -sign * y0, m->m11, sign * x0);
+                swap(m->m00, w.t0);
+                swap(m->m01, w.t1);
+                swap(m->m10, w.t2);
+                swap(m->m11, w.t3);
+                m->det *= (int)sign;
+            }
+            normalize(a, b, m);
+            return true;
+        }
+        /* Half-gcd: makes all the steps allowed by the bound s > 0. While the part of a above s
+           is long, the first steps are found by recursive calls on the top halves of a and b,
+           whose matrices are then applied to the whole numbers with a few multiplications. The
+           recursive calls stop before the top halves fall below the square root of their size,
+           so their quotients are also those of the whole numbers. */
+        static void hgcd(bigint &a, bigint &b, size_t s, matrix *m, workspace &w)
+        {
+            count_algorithm(bigint_stats::algorithm::gcd_hgcd);
+            const size_t recursion = 32 * tuning.gcd_hgcd;
+            size_t n = bit_length(a);
+            if (n > s + recursion && bit_length(b) > s)
+            {
+                /* Reduce the top n - s bits to half their length. */
+                bigint ah = shift_right(a, s), bh = shift_right(b, s);
+                matrix m1;
+                hgcd(ah, bh, (n - s) / 2 + 1, &m1, w);
+                if (!m1.is_identity())
+                {
+                    apply_inverse(a, b, m1, w);
+                    if (m != nullptr)
+                    {
+                        multiply(*m, m1, w);
+                    }
+                }
+            }
+            /* A step in between makes sure the second call starts from a pair that can still
+               be reduced. */
+            if (bit_length(b) <= s || (!lehmer_step(a, b, s, m, w) && !division_step(a, b, s, m, w)))
+            {
+                return;
+            }
+            n = bit_length(a);
+            if (n > s + recursion && bit_length(b) > s)
+            {
+                /* The n - s bits left to remove are half of the top 2 (n - s) bits. */
+                const size_t p = 2 * s > n ? 2 * s - n : 0;
+                bigint ah = shift_right(a, p), bh = shift_right(b, p);
+                matrix m1;
+                hgcd(ah, bh, (n - p) / 2 + 1, &m1, w);
+                if (!m1.is_identity())
+                {
+                    apply_inverse(a, b, m1, w);
+                    if (m != nullptr)
+                    {
+                        multiply(*m, m1, w);
+                    }
+                }
+            }
+            while (bit_length(b) > s)
+            {
+                if (!lehmer_step(a, b, s, m, w) && !division_step(a, b, s, m, w))
+                {
+                    break;
+                }
+            }
+        }
+        /* gcd(a, b) for a >= b >= 0, leaving in m, if given, the matrix with (a; b) = m (g; 0). */
+        static bigint gcd(bigint a, bigint b, matrix *m)
+        {
+            workspace w;
+            while (!b.limbs.empty())
+            {
+                if (m == nullptr && a.limbs.size() == 1)
+                {
+                    return bigint_from_limb(gcd_1(a.limbs[0], b.limbs[0]));
+                }
+                if (b.limbs.size() >= tuning.gcd_hgcd)
+                {
+                    hgcd(a, b, bit_length(a) / 2, m, w);
+                    division_step(a, b, 0, m, w);
+                }
+                else if (!lehmer_step(a, b, 0, m, w))
+                {
+                    division_step(a, b, 0, m, w);
+                }
+            }
+            return a;
+        }
+
+        /* Products of many factors. */
+
+        /* Collects factors of at most 64 bits, multiplying them together as long as the product
+           fits in a limb, so that a product tree over the words has fewer leaves. */
+        struct word_product
+        {
+            vector<limb_t> words;
+            limb_t word = 1;
+
+            void push(limb_t factor)
+            {
+                const dlimb_t p = (dlimb_t)word * factor;
+                if ((p >> 64) != 0)
+                {
+                    words.push_back(word);
+                    word = factor;
+                }
+                else
+                {
+                    word = (limb_t)p;
+                }
+            }
+            bigint finish()
+            {
+                if (word != 1 || words.empty())
+                {
+                    words.push_back(word);
+                }
+                return product(words.data(), words.size());
+            }
+        };
+        /* Product of n >= 1 single-limb factors. Ranges of a few factors are multiplied one limb
+           at a time and the others split in halves, so that most of the work is in the few large
+           balanced products at the top of the tree, which run in parallel when they are large
+           enough. */
+        static bigint product(const limb_t *f, size_t n)
+        {
+            if (n <= 32)
+            {
+                bigint result;
+                result.limbs.resize(n);
+                result.limbs[0] = f[0];
+                for (size_t i = 1; i < n; i++)
+                {
+                    result.limbs[i] = mul_1(result.limbs.data(), result.limbs.data(), i, f[i]);
+                }
+                result.erase_left_zeros();
+                return result;
+            }
+            const size_t half = n / 2;
+            bigint low, high;
+            parallel_pair(n, [&]
+                          { low = product(f, half); },
+                          [&]
+                          { high = product(f + half, n - half); });
+            low *= high;
+            return low;
+        }
+        /* Product of the n >= 1 values v, which it consumes. end[i] is the total number of limbs
+           of v[0..i], so that every range is split where its limbs are halved. */
+        static bigint product(bigint *v, const size_t *end, size_t n)
+        {
+            if (n == 1)
+            {
+                return move(v[0]);
+            }
+            const size_t before = end[0] - v[0].limbs.size(), total = end[n - 1] - before;
+            const size_t half = min((size_t)(lower_bound(end, end + n, before + total / 2) - end) + 1, n - 1);
+            bigint low, high;
+            parallel_pair(total, [&]
+                          { low = product(v, end, half); },
+                          [&]
+                          { high = product(v + half, end + half, n - half); });
+            low *= high;
+            return low;
+        }
+        /* Runs both functions, in parallel if an operation on n limbs should be. */
+        template <class F, class G>
+        static void parallel_pair(size_t n, const F &f, const G &g)
+        {
+            if (parallel_enabled(n))
+            {
+                parallel_invoke({f, g});
+            }
+            else
+            {
+                f();
+                g();
+            }
+        }
+        /* Calls f(p) for every prime p <= n, in increasing order. The odd numbers are sieved a
+           segment at a time, so the memory used is about sqrt(n) words whatever n. */
+        template <class F>
+        static void for_each_prime(uint64_t n, const F &f)
+        {
+            if (n < 2)
+            {
+                return;
+            }
+            f(2);
+            uint64_t root = (uint64_t)sqrt((double)n);
+            while (root * root > n)
+            {
+                root--;
+            }
+            while ((root + 1) * (root + 1) <= n)
+            {
+                root++;
+            }
+            /* Odd primes up to sqrt(n), and for each the next odd multiple to cross out. */
+            vector<uint64_t> base, next;
+            {
+                vector<bool> composite(root / 2 + 1);
+                for (uint64_t p = 3; p <= root; p += 2)
+                {
+                    if (!composite[p / 2])
+                    {
+                        base.push_back(p);
+                        next.push_back(p * p);
+                        for (uint64_t m = p * p; m <= root; m += 2 * p)
+                        {
+                            composite[m / 2] = true;
+                        }
+                    }
+                }
+            }
+            /* A segment holds 2^15 odd numbers, one byte each, which stays in the L1 cache. */
+            const uint64_t segment = (uint64_t)1 << 15;
+            vector<uint8_t> prime(segment);
+            for (uint64_t low = 3; low <= n; low += 2 * segment)
+            {
+                const uint64_t count = min(segment, (n - low) / 2 + 1);
+                fill(prime.begin(), prime.begin() + (ptrdiff_t)count, 1);
+                const uint64_t high = low + 2 * (count - 1);
+                for (size_t j = 0; j < base.size(); j++)
+                {
+                    uint64_t m = next[j];
+                    for (; m <= high; m += 2 * base[j])
+                    {
+                        prime[(m - low) / 2] = 0;
+                    }
+                    next[j] = m;
+                }
+                for (uint64_t i = 0; i < count; i++)
+                {
+                    if (prime[i])
+                    {
+                        f(low + 2 * i);
+                    }
+                }
+            }
+        }
+        /* The odd part of the swinging factorial n! / floor(n/2)!^2: the exponent of an odd
+           prime p in it is the number of odd values among floor(n / p^i), i >= 1. */
+        static bigint odd_swing(uint64_t n)
+        {
+            word_product factors;
+            for_each_prime(n, [&](uint64_t p)
+                           {
+                               if (p == 2)
+                               {
+                                   return;
+                               }
+                               for (uint64_t q = n / p; q > 0; q /= p)
+                               {
+                                   if (q & 1)
+                                   {
+                                       factors.push(p);
+                                   }
+                               } });
+            return factors.finish();
+        }
+        /* The odd part of n!, which is the odd part of floor(n/2)!, squared, times the odd part
+           of the swinging factorial (Luschny's prime swing algorithm). */
+        static bigint odd_factorial(uint64_t n)
+        {
+            if (n <= 20)
+            {
+                limb_t result = 1;
+                for (limb_t i = 3; i <= n; i++)
+                {
+                    result *= i >> countr_zero(i);
+                }
+                return bigint_from_limb(result);
+            }
+            bigint half, swing;
+            /* About n log2(n) bits in the result. */
+            parallel_pair((size_t)(n / 64 * (uint64_t)bit_width(n)), [&]
+                          { half = odd_factorial(n / 2); },
+                          [&]
+                          { swing = odd_swing(n); });
+            half *= half;
+            half *= swing;
+            return half;
+        }
+
+        /* The odd primes below 2^20, sieved on first use and shared by all threads. */
+        static const vector<uint32_t> &small_primes()
+        {
+            static const vector<uint32_t> primes = []
+            {
+                vector<uint32_t> result;
+                for_each_prime(((uint64_t)1 << 20) - 1, [&](uint64_t p)
+                               {
+                                   if (p != 2)
+                                   {
+                                       result.push_back((uint32_t)p);
+                                   } });
+                return result;
+            }();
+            return primes;
+        }
+        /* Stores |x| mod p[i] in r[i] for the count primes at p. The primes are taken in groups
+           whose product fits in a limb, so x is divided once per group instead of once per prime. */
+        static void residues(const bigint &x, const uint32_t *p, size_t count, uint32_t *r)
+        {
+            limb_vector quotient(x.limbs.size());
+            for (size_t i = 0; i < count;)
+            {
+                limb_t group = p[i];
+                size_t end = i + 1;
+                while (end < count && group <= ~(limb_t)0 / p[end])
+                {
+                    group *= p[end++];
+                }
+                const limb_t rem = divrem_1(quotient.data(), x.limbs.data(), x.limbs.size(), group);
+                for (; i < end; i++)
+                {
+                    r[i] = (uint32_t)(rem % p[i]);
+                }
+            }
+        }
+        /* A number of bits random bits, uniformly distributed, with every limb drawn from g. */
+        template <class URBG>
+        static bigint random_bits(uint64_t bits, URBG &g)
+        {
+            uniform_int_distribution<limb_t> limb;
+            bigint result;
+            result.limbs.resize((size_t)((bits + 63) / 64));
+            for (limb_t &l : result.limbs)
+            {
+                l = limb(g);
+            }
+            if (bits % 64 != 0)
+            {
+                result.limbs.back() &= ((limb_t)1 << (bits % 64)) - 1;
+            }
+            result.erase_left_zeros();
+            return result;
+        }
+        /* Jacobi symbol (a / n) of two words, for an odd n. */
+        static int jacobi(limb_t a, limb_t n)
+        {
+            int result = 1;
+            for (a %= n; a != 0; a %= n)
+            {
+                const int twos = countr_zero(a);
+                a >>= twos;
+                /* (2 / n) is -1 when n is 3 or 5 mod 8. */
+                if ((twos & 1) != 0 && ((n & 7) == 3 || (n & 7) == 5))
+                {
+                    result = -result;
+                }
+                /* Quadratic reciprocity: (a / n) = -(n / a) when both are 3 mod 4. */
+                if ((a & 3) == 3 && (n & 3) == 3)
+                {
+                    result = -result;
+                }
+                swap(a, n);
+            }
+            return n == 1 ? result : 0;
+        }
+        /* Jacobi symbol (a / n) of a word and an odd n > 0, reduced to words with the rules
+           for -1 and 2 and with quadratic reciprocity, which turns (a / n) into (n mod a / a). */
+        static int jacobi(int64_t a, const bigint &n)
+        {
+            const limb_t low = n.limbs[0];
+            int result = 1;
+            if (a < 0 && (low & 3) == 3)
+            {
+                result = -result;
+            }
+            limb_t m = a < 0 ? 0 - (limb_t)a : (limb_t)a;
+            if (m == 0)
+            {
+                return n == 1 ? 1 : 0;
+            }
+            const int twos = countr_zero(m);
+            m >>= twos;
+            if ((twos & 1) != 0 && ((low & 7) == 3 || (low & 7) == 5))
+            {
+                result = -result;
+            }
+            if ((m & 3) == 3 && (low & 3) == 3)
+            {
+                result = -result;
+            }
+            limb_vector quotient(n.limbs.size());
+            return result * jacobi(divrem_1(quotient.data(), n.limbs.data(), n.limbs.size(), m), m);
+        }
+        /* Strong probable-prime test of the odd n > 3 to the base a, where n - 1 = d 2^s:
+           a^d is 1, or a^(d 2^r) is n - 1 for some r < s. */
+        static bool strong_probable_prime(const bigint_modulus &ctx, const bigint &d, uint64_t s, const bigint &a)
+        {
+            const bigint n_minus_1 = ctx.modulus() - 1;
+            bigint x = ctx.powmod(a, d);
+            if (x == 1 || x == n_minus_1)
+            {
+                return true;
+            }
+            for (uint64_t r = 1; r < s; r++)
+            {
+                x = ctx.sqrmod(x);
+                if (x == n_minus_1)
+                {
+                    return true;
+                }
+                if (x == 1)
+                {
+                    return false;
+                }
+            }
+            return false;
+        }
+        /* Strong Lucas probable-prime test of the odd n > 3, with the parameters of Selfridge's
+           method A: D is the first of 5, -7, 9, -11, ... with (D / n) = -1, P = 1 and
+           Q = (1 - D) / 4. With n + 1 = d 2^s, n passes if U_d = 0 or V_(d 2^r) = 0 for some
+           r < s, all modulo n. A square has no such D, so it is ruled out first. */
+        static bool strong_lucas_probable_prime(const bigint &n)
+        {
+            const bigint root = isqrt(n);
+            if (root * root == n)
+            {
+                return false;
+            }
+            int64_t D = 5;
+            for (;; D = D > 0 ? -D - 2 : -D + 2)
+            {
+                const int j = jacobi(D, n);
+                if (j == -1)
+                {
+                    break;
+                }
+                /* |D| shares a factor with n. */
+                if (j == 0 && n != (D > 0 ? D : -D))
+                {
+                    return false;
+                }
+            }
+            const bigint_modulus ctx(n);
+            const bigint q = ctx.reduce((1 - D) / 4), dd = ctx.reduce(D);
+            /* x / 2 mod n for x in [0, n), with n odd. */
+            auto half = [&](bigint x)
+            {
+                if (x.test_bit(0))
+                {
+                    x += n;
+                }
+                return x >>= 1;
+            };
+            /* x mod n for x in [0, 2n). */
+            auto reduce_once = [&](bigint x)
+            {
+                if (x >= n)
+                {
+                    x -= n;
+                }
+                return x;
+            };
+            const bigint n_plus_1 = n + 1;
+            const uint64_t s = n_plus_1.count_trailing_zeros();
+            const bigint d = n_plus_1 >> s;
+            /* U_k, V_k and Q^k for the prefix k of the bits of d, starting from k = 1 with
+               U_1 = 1 and V_1 = P = 1, and doubling with U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k,
+               then adding one with U_(k+1) = (P U_k + V_k) / 2 and V_(k+1) = (D U_k + P V_k) / 2. */
+            bigint u = 1, v = 1, qk = q;
+            for (uint64_t i = d.bit_length() - 1; i-- > 0;)
+            {
+                u = ctx.mulmod(u, v);
+                v = ctx.reduce(ctx.sqrmod(v) - 2 * qk);
+                qk = ctx.sqrmod(qk);
+                if (d.test_bit(i))
+                {
+                    bigint next_u = half(reduce_once(u + v));
+                    v = half(ctx.reduce(ctx.mulmod(dd, u) + v));
+                    u = move(next_u);
+                    qk = ctx.mulmod(qk, q);
+                }
+            }
+            if (u == 0)
+            {
+                return true;
+            }
+            for (uint64_t r = 0; r < s; r++)
+            {
+                if (v == 0)
+                {
+                    return true;
+                }
+                v = ctx.reduce(ctx.sqrmod(v) - 2 * qk);
+                qk = ctx.sqrmod(qk);
+            }
+            return false;
+        }
+        /* The Baillie-PSW test of an odd n > 2^20: a strong probable-prime test to the base 2
+           and a strong Lucas test. */
+        static bool baillie_psw(const bigint &n)
+        {
+            const bigint n_minus_1 = n - 1;
+            const uint64_t s = n_minus_1.count_trailing_zeros();
+            return strong_probable_prime(bigint_modulus(n), n_minus_1 >> s, s, 2) && strong_lucas_probable_prime(n);
+        }
+    };
+}
+
+inline bigint pow(const bigint &base, uint64_t exponent)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::pow, base.limbs.size());
+    bigint result = 1;
+    if (exponent == 0)
+    {
+        return result;
+    }
+    result = base;
+    for (int i = 62 - __builtin_clzll(exponent); i >= 0; i--)
+    {
+        result *= result;
+        if ((exponent >> i) & 1)
+        {
+            result *= base;
+        }
+    }
+    result.negative = base.negative && (exponent & 1) != 0;
+    return result;
+}
+
+inline bigint isqrt(const bigint &x)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::root, x.limbs.size());
+    if (x.negative)
+    {
+        throw domain_error("square root of a negative number");
+    }
+    if (x.limbs.empty())
+    {
+        return x;
+    }
+    return bigint_detail::number_theory::root(x, 2);
+}
+
+inline bigint iroot(const bigint &x, uint64_t k)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::root, x.limbs.size());
+    if (k == 0)
+    {
+        throw domain_error("root of index zero");
+    }
+    if (x.negative && k % 2 == 0)
+    {
+        throw domain_error("even root of a negative number");
+    }
+    if (x.limbs.empty() || k == 1)
+    {
+        return x;
+    }
+    bigint magnitude = x;
+    magnitude.negative = false;
+    bigint result = bigint_detail::number_theory::root(magnitude, k);
+    result.negative = x.negative;
+    return result;
+}
+
+inline bigint gcd(const bigint &x, const bigint &y)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::gcd, max(x.limbs.size(), y.limbs.size()));
+    bigint a = x, b = y;
+    a.negative = b.negative = false;
+    if (a < b)
+    {
+        swap(a, b);
+    }
+    return bigint_detail::number_theory::gcd(move(a), move(b), nullptr);
+}
+
+inline tuple<bigint, bigint, bigint> xgcd(const bigint &x, const bigint &y)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::gcd, max(x.limbs.size(), y.limbs.size()));
+    using number_theory = bigint_detail::number_theory;
+    bigint a = x, b = y;
+    a.negative = b.negative = false;
+    const bool swapped = a < b;
+    if (swapped)
+    {
+        swap(a, b);
+    }
+    number_theory::matrix m;
+    bigint g = number_theory::gcd(a, b, &m);
+    bigint s = 1, t = 0;
+    if (!b.limbs.empty())
+    {
+        /* g = det (m11 a - m01 b); the cofactor of a is then reduced modulo b / g to the
+           smallest one, and the cofactor of b follows. */
+        s = m.det > 0 ? move(m.m11) : -move(m.m11);
+        bigint period = b / g;
+        s %= period;
+        if (s.negative)
+        {
+            s += period;
+        }
+        if (bigint(2) * s > period)
+        {
+            s -= period;
+        }
+        t = g;
+        submul(t, s, a);
+        t /= b;
+    }
+    if (swapped)
+    {
+        swap(s, t);
+    }
+    if (x.negative)
+    {
+        s = -move(s);
+    }
+    if (y.negative)
+    {
+        t = -move(t);
+    }
+    return {move(g), move(s), move(t)};
+}
+
+/**
+ * @brief Product of the values of a range.
+ *
+ * @param first, last The range. Its values are integers or anything that converts to a bigint,
+ * such as bigint, bigint_view or fixed_bigint.
+ *
+ * @details The values are multiplied in a balanced tree, every range being split where its
+ * limbs are halved, so that most of the work is done by a few multiplications of large and
+ * balanced operands, and not by a long sequence of products of a large number by a small one.
+ * Built-in integers are first multiplied together as long as their product fits in 64 bits.
+ * Under a bigint_parallel_scope the two halves of a large range are multiplied in parallel.
+ *
+ * @return The product, 1 for an empty range.
+ */
+template <class It>
+bigint product(It first, It last)
+{
+    using namespace bigint_detail;
+    using value_type = typename iterator_traits<It>::value_type;
+    operation_scope scope(bigint_stats::operation::product, 0);
+    if constexpr (is_integral_v<value_type>)
+    {
+        number_theory::word_product factors;
+        bool negative = false;
+        for (; first != last; ++first)
+        {
+            const value_type x = *first;
+            if constexpr (is_signed_v<value_type>)
+            {
+                negative ^= x < 0;
+                factors.push(x < 0 ? 0 - (limb_t)x : (limb_t)x);
+            }
+            else
+            {
+                factors.push((limb_t)x);
+            }
+        }
+        bigint result = factors.finish();
+        if (negative)
+        {
+            result = -move(result);
+        }
+        return result;
+    }
+    else
+    {
+        vector<bigint> values;
+        vector<size_t> end;
+        size_t total = 0;
+        for (; first != last; ++first)
+        {
+            values.push_back(bigint(*first));
+            total += (number_theory::bit_length(values.back()) + 63) / 64;
+            end.push_back(total);
+        }
+        if (values.empty())
+        {
+            return 1;
+        }
+        return number_theory::product(values.data(), end.data(), values.size());
+    }
+}
+/**
+ * @brief Product of the values of a range, such as a vector, with the algorithm of
+ * product(first, last).
+ */
+template <class Range>
+bigint product(const Range &values)
+{
+    return product(begin(values), end(values));
+}
+
+/**
+ * @brief Factorial of n.
+ *
+ * @details Luschny's prime swing algorithm: n! is floor(n/2)!^2 times the swinging factorial
+ * n! / floor(n/2)!^2, whose factorization is read directly from the primes up to n, and the
+ * powers of two are left out of every step and applied with one shift at the end. The primes
+ * come from a segmented sieve and their powers are multiplied with a product tree, so the
+ * cost is a few multiplications of the size of the result. Under a bigint_parallel_scope the
+ * swinging factorial and the factorial of n/2 are computed in parallel.
+ */
+inline bigint factorial(uint64_t n)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::product, 0);
+    return bigint_detail::number_theory::odd_factorial(n) << (n - (uint64_t)popcount(n));
+}
+
+/**
+ * @brief Binomial coefficient n choose k, 0 if k > n.
+ *
+ * @details When n is not much larger than k the coefficient is built from its factorization:
+ * by Legendre's formula the exponent of a prime p is the sum over i >= 1 of
+ * floor(n / p^i) - floor(k / p^i) - floor((n - k) / p^i), and the prime powers are multiplied
+ * with a product tree. Otherwise, so as not to sieve up to a large n, the product of the k
+ * factors n - k + 1, ..., n is computed with a product tree and divided by k!.
+ */
+inline bigint binomial(uint64_t n, uint64_t k)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::product, 0);
+    if (k > n)
+    {
+        return 0;
+    }
+    k = min(k, n - k);
+    number_theory::word_product factors;
+    if (n / 64 <= k)
+    {
+        number_theory::for_each_prime(n, [&](uint64_t p)
+                                      {
+                                          for (uint64_t a = n / p, b = k / p, c = (n - k) / p; a > 0; a /= p, b /= p, c /= p)
+                                          {
+                                              for (uint64_t e = a - b - c; e > 0; e--)
+                                              {
+                                                  factors.push(p);
+                                              }
+                                          } });
+        return factors.finish();
+    }
+    for (uint64_t i = n - k + 1; i <= n && i != 0; i++)
+    {
+        factors.push(i);
+    }
+    return factors.finish() / factorial(k);
+}
+
+/**
+ * @brief Primorial of n, the product of the primes up to n.
+ *
+ * @details The primes come from a segmented sieve and are multiplied with a product tree.
+ */
+inline bigint primorial(uint64_t n)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::product, 0);
+    bigint_detail::number_theory::word_product factors;
+    bigint_detail::number_theory::for_each_prime(n, [&](uint64_t p)
+                                                 { factors.push(p); });
+    return factors.finish();
+}
+
+namespace bigint_detail
+{
+    template <class Leaf, class Merge>
+    auto binary_split(uint64_t first, uint64_t last, const Leaf &leaf, const Merge &merge, unsigned parallel_depth)
+        -> decltype(leaf(first))
+    {
+        using value_type = decltype(leaf(first));
+        if (last - first == 1)
+        {
+            return leaf(first);
+        }
+        const uint64_t middle = first + (last - first) / 2;
+        if (parallel_depth == 0 || last - first < 64)
+        {
+            value_type low = binary_split(first, middle, leaf, merge, 0);
+            return merge(move(low), binary_split(middle, last, leaf, merge, 0));
+        }
+        optional<value_type> low, high;
+        parallel_invoke({[&]
+                         { low.emplace(binary_split(first, middle, leaf, merge, parallel_depth - 1)); },
+                         [&]
+                         { high.emplace(binary_split(middle, last, leaf, merge, parallel_depth - 1)); }});
+        return merge(move(*low), move(*high));
+    }
+}
+
+/**
+ * @brief Binary splitting: combines the terms of the range [first, last) in a balanced tree.
+ *
+ * @param first, last The range of indices, which must not be empty.
+ * @param leaf The function leaf(i) computing the value for the index i, of any type T.
+ * @param merge The function merge(T &&low, T &&high) combining the values of two consecutive
+ * ranges, the one of the lower indices first.
+ *
+ * @details This is the scheme used to sum series with rational terms, such as the ones of e,
+ * pi or the hypergeometric functions, where every value holds the numerator and the
+ * denominator of a partial sum as bigint objects: the values of the two halves of a range are
+ * about the same size, so the merges are large and balanced multiplications. Under a
+ * bigint_parallel_scope the top levels of the tree run in parallel, with about two ranges per
+ * thread, so leaf and merge must be safe to call from several threads at once.
+ *
+ * @return The merge of the values of every index, in order.
+ */
+template <class Leaf, class Merge>
+auto binary_split(uint64_t first, uint64_t last, const Leaf &leaf, const Merge &merge) -> decltype(leaf(first))
+{
+    if (first >= last)
+    {
+        throw invalid_argument("empty range");
+    }
+    bigint_executor *executor = bigint_detail::scoped_executor;
+    const unsigned depth = executor == nullptr ? 0 : (unsigned)bit_width(executor->concurrency());
+    return bigint_detail::binary_split(first, last, leaf, merge, depth);
+}
+
+/**
+ * @brief Returns a random integer in [0, 2^bits), every value with the same probability.
+ *
+ * @param bits The number of random bits. For a number of exactly bits bits, as for key
+ * material, the top bit is set afterwards with set_bit(bits - 1).
+ * @param g The uniform random bit generator, such as mt19937_64 or random_device, from which
+ * every limb is drawn with a uniform_int_distribution, whatever the range of g.
+ */
+template <uniform_random_bit_generator URBG>
+bigint random_bits(uint64_t bits, URBG &g)
+{
+    return bigint_detail::number_theory::random_bits(bits, g);
+}
+
+/**
+ * @brief Returns a random integer in the closed range [low, high], every value with the same
+ * probability, like uniform_int_distribution.
+ *
+ * @details Numbers of as many bits as high - low are drawn until one is not larger than it,
+ * which takes less than two draws on average. An invalid_argument is thrown if high < low.
+ */
+template <uniform_random_bit_generator URBG>
+bigint random_range(const bigint &low, const bigint &high, URBG &g)
+{
+    if (high < low)
+    {
+        throw invalid_argument("empty range");
+    }
+    const bigint width = high - low;
+    const uint64_t bits = width.bit_length();
+    bigint x;
+    do
+    {
+        x = bigint_detail::number_theory::random_bits(bits, g);
+    } while (x > width);
+    return x += low;
+}
+
+/**
+ * @brief Miller-Rabin test of n with rounds random bases drawn from g.
+ *
+ * @details Each round is a strong probable-prime test to a base chosen uniformly in
+ * [2, n - 2]: with n - 1 = d 2^s and d odd, n passes if a^d = 1 or a^(d 2^r) = n - 1 modulo n
+ * for some r < s. A prime always passes, and a composite passes a round with probability at
+ * most 1/4, so far less for numbers that were not built to fool the test. The exponentiations
+ * share one bigint_modulus and are done in Montgomery form.
+ *
+ * @return false if n is composite; true if n is prime or passed every round.
+ */
+template <uniform_random_bit_generator URBG>
+bool miller_rabin(const bigint &n, size_t rounds, URBG &g)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::prime, 0);
+    if (n < 4)
+    {
+        return n > 1;
+    }
+    if (!n.test_bit(0))
+    {
+        return false;
+    }
+    const bigint n_minus_1 = n - 1;
+    const uint64_t s = n_minus_1.count_trailing_zeros();
+    const bigint d = n_minus_1 >> s;
+    const bigint_modulus ctx(n);
+    for (size_t i = 0; i < rounds; i++)
+    {
+        if (!bigint_detail::number_theory::strong_probable_prime(ctx, d, s, random_range(2, n - 2, g)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Baillie-PSW primality test.
+ *
+ * @details Values below 2^20 are looked up in a table of primes, and other values are first
+ * divided by the primes below 1024, with one division of n per group of primes whose product
+ * fits in a limb. The survivors go through a strong probable-prime test to the base 2 and a
+ * strong Lucas test with Selfridge's parameters. The two tests fail on different kinds of
+ * numbers, and no composite that passes both is known; none exists below 2^64, so there the
+ * result is exact. The cost is about that of three exponentiations modulo n.
+ *
+ * @return true if n is prime or a Baillie-PSW pseudoprime, false if it is composite or less
+ * than 2.
+ */
+inline bool is_probable_prime(const bigint &n)
+{
+    using number_theory = bigint_detail::number_theory;
+    bigint_detail::operation_scope scope(bigint_stats::operation::prime, 0);
+    if (n < 2)
+    {
+        return false;
+    }
+    const vector<uint32_t> &primes = number_theory::small_primes();
+    if (n.bit_length() <= 20)
+    {
+        const uint32_t value = (uint32_t)number_theory::bits_from(n, 0);
+        return value == 2 || binary_search(primes.begin(), primes.end(), value);
+    }
+    if (!n.test_bit(0))
+    {
+        return false;
+    }
+    const size_t trial = (size_t)(lower_bound(primes.begin(), primes.end(), 1024u) - primes.begin());
+    vector<uint32_t> r(trial);
+    number_theory::residues(n, primes.data(), trial, r.data());
+    if (find(r.begin(), r.end(), 0u) != r.end())
+    {
+        return false;
+    }
+    return number_theory::baillie_psw(n);
+}
+
+/**
+ * @brief Returns the smallest prime larger than n, as certain as is_probable_prime.
+ *
+ * @details Values below 2^20 are answered from the table of primes. Above, the odd numbers
+ * after n are taken a window at a time, a few times the expected gap between primes, and the
+ * window is sieved: the residues of its first number modulo the small primes, up to a bound
+ * that grows with the size of n, give the multiples to cross out. Only the numbers left
+ * have no small factor, about 8% of the odd numbers at 2048 bits, and go through the
+ * Baillie-PSW test, where most composites fail at the first exponentiation.
+ */
+inline bigint next_prime(const bigint &n)
+{
+    using number_theory = bigint_detail::number_theory;
+    bigint_detail::operation_scope scope(bigint_stats::operation::prime, 0);
+    const vector<uint32_t> &primes = number_theory::small_primes();
+    if (n < 2)
+    {
+        return 2;
+    }
+    if (n < primes.back())
+    {
+        return *upper_bound(primes.begin(), primes.end(), (uint32_t)number_theory::bits_from(n, 0));
+    }
+    const uint64_t bits = n.bit_length();
+    /* The sieve bound and the window, in odd numbers: the gap between primes is about
+       0.7 bits on average, and a larger number makes every survivor more costly to test. */
+    const uint64_t bound = clamp<uint64_t>(bits * bits / 2, 1024, primes.back());
+    const size_t sieving = (size_t)(upper_bound(primes.begin(), primes.end(), (uint32_t)bound) - primes.begin());
+    const size_t window = (size_t)max<uint64_t>(1024, 4 * bits);
+    bigint start = n + 1;
+    if (!start.test_bit(0))
+    {
+        start += 1;
+    }
+    vector<uint32_t> r(sieving);
+    vector<uint8_t> composite(window);
+    for (;; start += 2 * (int64_t)window)
+    {
+        number_theory::residues(start, primes.data(), sieving, r.data());
+        fill(composite.begin(), composite.end(), 0);
+        for (size_t j = 0; j < sieving; j++)
+        {
+            /* start + 2i = 0 mod p for i = -r / 2 = (p - r) (p + 1) / 2 mod p. */
+            const uint64_t p = primes[j];
+            for (uint64_t i = (p - r[j]) % p * ((p + 1) / 2) % p; i < window; i += p)
+            {
+                composite[i] = 1;
+            }
+        }
+        for (size_t i = 0; i < window; i++)
+        {
+            if (!composite[i])
+            {
+                bigint candidate = start + 2 * (int64_t)i;
+                if (number_theory::baillie_psw(candidate))
+                {
+                    return candidate;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns a random prime of exactly bits bits, as certain as is_probable_prime.
+ *
+ * @details The prime is next_prime of a random number of bits bits, drawn from g, and a new
+ * number is drawn in the rare case that the prime has one more bit. As with most libraries,
+ * a prime that follows a long gap is more likely than one that follows a short gap, which
+ * does not matter for key generation. A domain_error is thrown if bits < 2.
+ */
+template <uniform_random_bit_generator URBG>
+bigint random_prime(uint64_t bits, URBG &g)
+{
+    if (bits < 2)
+    {
+        throw domain_error("a prime has at least 2 bits");
+    }
+    for (;;)
+    {
+        bigint x = random_bits(bits, g);
+        x.set_bit(bits - 1);
+        bigint p = next_prime(x);
+        if (p.bit_length() == bits)
+        {
+            return p;
+        }
+    }
+}
+
+/**
+ * @brief Expression templates for bigint.
+ *
+ * @details Wrapping an operand with lazy() makes +, - and * build a small tree of nodes that
+ * refer to the operands instead of computing a bigint for every sub-expression. The tree is
+ * evaluated when it is assigned to (or added to, subtracted from, used to construct) a bigint:
+ * the destination is sized once for the whole expression, and every product is accumulated
+ * into it with addmul or submul. For example
+ *
+ *     r = lazy(a) * b + lazy(c) * d - e;
+ *
+ * computes the same value as r = a * b + c * d - e with a single buffer and no temporaries.
+ * The nodes keep references to their operands, so an expression must be evaluated in the
+ * statement that builds it and must not be stored with auto. Factors that are themselves sums,
+ * as in lazy(a) * (b + c), are evaluated into a temporary first.
+ */
+namespace bigint_expr
+{
+    /* Base of every node, E being the node type itself. */
+    template <class E>
+    struct expression
+    {
+        const E &self() const
+        {
+            return static_cast<const E &>(*this);
+        }
+    };
+    /* A reference to a bigint operand. */
+    struct leaf : expression<leaf>
+    {
+        const bigint &value;
+        explicit leaf(const bigint &value_) : value(value_) {}
+    };
+    template <class L, class R>
+    struct sum : expression<sum<L, R>>
+    {
+        L left;
+        R right;
+        sum(const L &left_, const R &right_) : left(left_), right(right_) {}
+    };
+    template <class L, class R>
+    struct difference : expression<difference<L, R>>
+    {
+        L left;
+        R right;
+        difference(const L &left_, const R &right_) : left(left_), right(right_) {}
+    };
+    template <class L, class R>
+    struct product : expression<product<L, R>>
+    {
+        L left;
+        R right;
+        product(const L &left_, const R &right_) : left(left_), right(right_) {}
+    };
+
+    /**
+     * @brief Starts an expression template.
+     *
+     * @param x The bigint operand.
+     *
+     * @return A node referring to x, which turns the operators it is used with into nodes.
+     */
+    inline leaf lazy(const bigint &x)
+    {
+        return leaf(x);
+    }
+
+    template <class T>
+    concept node = is_base_of_v<expression<T>, T>;
+    template <class T>
+    concept operand = node<T> || is_same_v<T, bigint>;
+
+    /* Node type of an operand: bigint operands become leaves. */
+    template <class T>
+    using term_t = conditional_t<node<T>, T, leaf>;
+    inline leaf as_term(const bigint &x)
+    {
+        return leaf(x);
+    }
+    template <node E>
+    const E &as_term(const E &e)
+    {
+        return e;
+    }
+
+    template <operand A, operand B>
+        requires(node<A> || node<B>)
+    sum<term_t<A>, term_t<B>> operator+(const A &a, const B &b)
+    {
+        return {as_term(a), as_term(b)};
+    }
+    template <operand A, operand B>
+        requires(node<A> || node<B>)
+    difference<term_t<A>, term_t<B>> operator-(const A &a, const B &b)
+    {
+        return {as_term(a), as_term(b)};
+    }
+    template <operand A, operand B>
+        requires(node<A> || node<B>)
+    product<term_t<A>, term_t<B>> operator*(const A &a, const B &b)
+    {
+        return {as_term(a), as_term(b)};
+    }
+
+    /**
+     * @brief Walks an expression tree and accumulates it into a bigint.
+     */
+    struct evaluator
+    {
+        /* Upper bound on the number of limbs of the value of a node. */
+        static size_t size(const leaf &e)
+        {
+            return e.value.limbs.size();
+        }
+        template <class L, class R>
+        static size_t size(const sum<L, R> &e)
+        {
+            return max(size(e.left), size(e.right)) + 1;
+        }
+        template <class L, class R>
+        static size_t size(const difference<L, R> &e)
+        {
+            return max(size(e.left), size(e.right)) + 1;
+        }
+        template <class L, class R>
+        static size_t size(const product<L, R> &e)
+        {
+            return size(e.left) + size(e.right);
+        }
+
+        /* True if the value of x is read by the node. */
+        static bool refers_to(const leaf &e, const bigint &x)
+        {
+            return &e.value == &x;
+        }
+        template <template <class, class> class N, class L, class R>
+        static bool refers_to(const N<L, R> &e, const bigint &x)
+        {
+            return refers_to(e.left, x) || refers_to(e.right, x);
+        }
+
+        /* The value of a factor: leaves are used in place, other nodes are evaluated. */
+        static const bigint &value(const leaf &e)
+        {
+            return e.value;
+        }
+        template <class E>
+        static bigint value(const E &e)
+        {
+            return bigint(e);
+        }
+
+        /* x += e, or x -= e if subtract is set. x must not be read by e. */
+        static void accumulate(bigint &x, const leaf &e, bool subtract)
+        {
+            subtract ? x -= e.value : x += e.value;
+        }
+        template <class L, class R>
+        static void accumulate(bigint &x, const sum<L, R> &e, bool subtract)
+        {
+            accumulate(x, e.left, subtract);
+            accumulate(x, e.right, subtract);
+        }
+        template <class L, class R>
+        static void accumulate(bigint &x, const difference<L, R> &e, bool subtract)
+        {
+            accumulate(x, e.left, subtract);
+            accumulate(x, e.right, !subtract);
+        }
+        template <class L, class R>
+        static void accumulate(bigint &x, const product<L, R> &e, bool subtract)
+        {
+            const bigint &a = value(e.left);
+            const bigint &b = value(e.right);
+            x.add_product(a, b, subtract);
+        }
+
+        template <class E>
+        static void assign(bigint &x, const E &e)
+        {
+            if (refers_to(e, x))
+            {
+                bigint result;
+                assign(result, e);
+                x = move(result);
+                return;
+            }
+            x = 0;
+            x.limbs.reserve(size(e));
+            accumulate(x, e, false);
+        }
+        template <class E>
+        static void update(bigint &x, const E &e, bool subtract)
+        {
+            if (refers_to(e, x))
+            {
+                bigint result(e);
+                subtract ? x -= result : x += result;
+                return;
+            }
+            x.limbs.reserve(max(x.limbs.size(), size(e)) + 1);
+            accumulate(x, e, subtract);
+        }
+    };
+}
+
+template <class E>
+bigint::bigint(const bigint_expr::expression<E> &e)
+{
+    bigint_expr::evaluator::assign(*this, e.self());
+}
+template <class E>
+bigint &bigint::operator=(const bigint_expr::expression<E> &e)
+{
+    bigint_expr::evaluator::assign(*this, e.self());
+    return *this;
+}
+template <class E>
+bigint &bigint::operator+=(const bigint_expr::expression<E> &e)
+{
+    bigint_expr::evaluator::update(*this, e.self(), false);
+    return *this;
+}
+template <class E>
+bigint &bigint::operator-=(const bigint_expr::expression<E> &e)
+{
+    bigint_expr::evaluator::update(*this, e.self(), true);
+    return *this;
+}
+
+/**
+ * @brief Many fixed-width integers stored in structure-of-arrays layout, with elementwise
+ * operations over whole batches.
+ *
+ * @details Every element is a two's complement integer of limbs() limbs, like a machine
+ * integer of 64 limbs() bits. The elements are stored in blocks of `lanes` consecutive
+ * elements: a block holds limb 0 of its elements, then limb 1, and so on. The elementwise
+ * operations therefore run their innermost loop over the independent elements of a block with
+ * unit stride, which the compiler turns into vector instructions for add, sub and cmp, and into
+ * independent multiplications, with no carry chain between them, for mul. Nothing is
+ * allocated per element.
+ *
+ * The operations are free functions taking the result first, which may also be an operand.
+ * The operands are sign-extended and the result is truncated to the width of the result
+ * batch: add, sub and mul into a batch of the operands' width wrap around like machine
+ * integers, and mul into a batch as wide as both operands together is exact. All the batches
+ * of an operation must have the same size, otherwise an invalid_argument is thrown. When a
+ * bigint_parallel_scope is active, large batches are split between its threads.
+ */
+class bigint_batch
+{
+public:
+    /**
+     * @brief Number of elements in a block.
+     */
+    static constexpr size_t lanes = 8;
+
+    /**
+     * @brief Constructs an empty batch.
+     */
+    bigint_batch() {}
+    /**
+     * @brief Constructs a batch of count elements of width limbs, all zero.
+     */
+    bigint_batch(size_t count_, size_t width_);
+    /**
+     * @brief Converts the values, with the smallest width that holds all of them.
+     */
+    explicit bigint_batch(const vector<bigint> &values);
+    /**
+     * @brief Converts the values into elements of width limbs.
+     *
+     * @details An out_of_range is thrown if a value does not fit in 64 width bits as a two's
+     * complement integer.
+     */
+    bigint_batch(const vector<bigint> &values, size_t width_);
+    /**
+     * @brief Returns the number of elements.
+     */
+    size_t size() const
+    {
+        return count;
+    }
+    /**
+     * @brief Returns the number of limbs of every element.
+     */
+    size_t limbs() const
+    {
+        return width;
+    }
+    /**
+     * @brief Returns element i.
+     */
+    bigint get(size_t i) const;
+    /**
+     * @brief Sets element i to x. An out_of_range is thrown if x does not fit in the width.
+     */
+    void set(size_t i, const bigint &x);
+    /**
+     * @brief Converts all the elements back to bigint.
+     */
+    vector<bigint> to_vector() const;
+    /**
+     * @brief Returns the smallest number of limbs that holds x as a two's complement integer.
+     */
+    static size_t width_of(const bigint &x);
+
+    /**
+     * @brief Elementwise r = a + b.
+     */
+    friend void add(bigint_batch &r, const bigint_batch &a, const bigint_batch &b);
+    /**
+     * @brief Elementwise r = a - b.
+     */
+    friend void sub(bigint_batch &r, const bigint_batch &a, const bigint_batch &b);
+    /**
+     * @brief Elementwise r = a * b.
+     *
+     * @details Schoolbook multiplication of the blocks of a and b, lane by lane, followed by the
+     * corrections for the negative operands; only the limbs of the product below the width of
+     * r are computed.
+     */
+    friend void mul(bigint_batch &r, const bigint_batch &a, const bigint_batch &b);
+    /**
+     * @brief Sets r[i] to -1, 0 or 1 as a[i] is less than, equal to or greater than b[i].
+     */
+    friend void cmp(vector<int> &r, const bigint_batch &a, const bigint_batch &b);
+    /**
+     * @brief Elementwise r = a * b mod m, in the range [0, m).
+     *
+     * @details The products are computed as by mul and each one is reduced with the Barrett
+     * reduction of m. r must be wide enough to hold m - 1 as a non-negative element, otherwise
+     * an invalid_argument is thrown.
+     */
+    friend void mulmod(bigint_batch &r, const bigint_batch &a, const bigint_batch &b, const bigint_modulus &m);
+
+private:
+    using limb_t = bigint_detail::limb_t;
+
+    size_t count = 0;
+    size_t width = 0;
+    bigint_detail::limb_vector storage;
+
+    size_t blocks() const
+    {
+        return (count + lanes - 1) / lanes;
+    }
+    limb_t *block(size_t k)
+    {
+        return storage.data() + k * width * lanes;
+    }
+    const limb_t *block(size_t k) const
+    {
+        return storage.data() + k * width * lanes;
+    }
+    /* Sets signs[l] to all ones if element l of block k is negative, to zero otherwise. */
+    void signs(size_t k, limb_t *signs_) const
+    {
+        if (width == 0)
+        {
+            fill(signs_, signs_ + lanes, 0);
+            return;
+        }
+        const limb_t *top = block(k) + (width - 1) * lanes;
+        for (size_t l = 0; l < lanes; l++)
+        {
+            signs_[l] = 0 - (top[l] >> 63);
+        }
+    }
+    /* Limb j of the elements of block k, which is the sign extension beyond the width. */
+    const limb_t *limb(size_t k, size_t j, const limb_t *signs_) const
+    {
+        return j < width ? block(k) + j * lanes : signs_;
+    }
+    /* Writes the product of the elements of block k of a and b, truncated to width limbs, to
+       product, in the layout of a block. */
+    static void multiply_block(limb_t *product, size_t width_, const bigint_batch &a, const bigint_batch &b, size_t k);
+    /* Calls f(first, last) on ranges of blocks covering the batch, in parallel if it is large. */
+    template <class F>
+    void for_each_block(const F &f) const
+    {
+        using namespace bigint_detail;
+        const size_t n = blocks();
+        if (!parallel_enabled(count * width))
+        {
+            f(0, n);
+            return;
+        }
+        parallel_for(0, n, parallel_grain(n, max<size_t>(tuning.parallel / (width * lanes + 1), 1)), f);
+    }
+    static void check_sizes(const bigint_batch &r, const bigint_batch &a, const bigint_batch &b)
+    {
+        if (a.count != r.count || b.count != r.count)
+        {
+            throw invalid_argument("batches of different sizes");
+        }
+    }
+};
+
+inline bigint_batch::bigint_batch(size_t count_, size_t width_)
+    : count(count_), width(width_), storage(blocks() * width_ * lanes)
+{
+}
+
+inline bigint_batch::bigint_batch(const vector<bigint> &values)
+{
+    size_t width_ = 1;
+    for (const bigint &x : values)
+    {
+        width_ = max(width_, width_of(x));
+    }
+    *this = bigint_batch(values, width_);
+}
+
+inline bigint_batch::bigint_batch(const vector<bigint> &values, size_t width_)
+    : bigint_batch(values.size(), width_)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        set(i, values[i]);
+    }
+}
+
+inline size_t bigint_batch::width_of(const bigint &x)
+{
+    const size_t xn = x.limbs.size();
+    if (xn == 0)
+    {
+        return 1;
+    }
+    size_t bits = 64 * xn - (size_t)__builtin_clzll(x.limbs[xn - 1]);
+    /* -2^(bits - 1) is the only negative number of that many bits that needs no extra bit. */
+    if (x.negative && __builtin_popcountll(x.limbs[xn - 1]) == 1 &&
+        bigint_detail::normalized_size(x.limbs.data(), xn - 1) == 0)
+    {
+        bits--;
+    }
+    return bits / 64 + 1;
+}
+
+inline bigint bigint_batch::get(size_t i) const
+{
+    const limb_t *p = block(i / lanes) + i % lanes;
+    bigint result;
+    result.limbs.resize(width);
+    for (size_t j = 0; j < width; j++)
+    {
+        result.limbs[j] = p[j * lanes];
+    }
+    if (width > 0 && result.limbs[width - 1] >> 63)
+    {
+        bigint_detail::negate_n(result.limbs.data(), width);
+        result.negative = true;
+    }
+    result.erase_left_zeros();
+    return result;
+}
+
+inline void bigint_batch::set(size_t i, const bigint &x)
+{
+    if (width_of(x) > width)
+    {
+        throw out_of_range("value does not fit in the width of the batch");
+    }
+    limb_t *p = block(i / lanes) + i % lanes;
+    const size_t xn = x.limbs.size();
+    limb_t borrow = 0;
+    for (size_t j = 0; j < width; j++)
+    {
+        limb_t v = j < xn ? x.limbs[j] : 0;
+        if (x.negative)
+        {
+            /* Two's complement: 0 - v - borrow, which borrows unless both are zero. */
+            limb_t negated = 0 - v - borrow;
+            borrow = (v | borrow) != 0;
+            v = negated;
+        }
+        p[j * lanes] = v;
+    }
+}
+
+inline vector<bigint> bigint_batch::to_vector() const
+{
+    vector<bigint> values(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = get(i);
+    }
+    return values;
+}
+
+inline void add(bigint_batch &r, const bigint_batch &a, const bigint_batch &b)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::batch, a.width);
+    using limb_t = bigint_detail::limb_t;
+    constexpr size_t lanes = bigint_batch::lanes;
+    bigint_batch::check_sizes(r, a, b);
+    r.for_each_block([&](size_t first, size_t last)
+                     {
+                         for (size_t k = first; k < last; k++)
+                         {
+                             limb_t sa[lanes], sb[lanes], carry[lanes] = {};
+                             a.signs(k, sa);
+                             b.signs(k, sb);
+                             limb_t *z = r.block(k);
+                             for (size_t j = 0; j < r.width; j++, z += lanes)
+                             {
+                                 const limb_t *x = a.limb(k, j, sa), *y = b.limb(k, j, sb);
+                                 for (size_t l = 0; l < lanes; l++)
+                                 {
+                                     limb_t s = x[l] + y[l];
+                                     limb_t t = s + carry[l];
+                                     carry[l] = (limb_t)(s < x[l]) | (limb_t)(t < s);
+                                     z[l] = t;
+                                 }
+                             }
+                         } });
+}
+
+inline void sub(bigint_batch &r, const bigint_batch &a, const bigint_batch &b)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::batch, a.width);
+    using limb_t = bigint_detail::limb_t;
+    constexpr size_t lanes = bigint_batch::lanes;
+    bigint_batch::check_sizes(r, a, b);
+    r.for_each_block([&](size_t first, size_t last)
+                     {
+                         for (size_t k = first; k < last; k++)
+                         {
+                             limb_t sa[lanes], sb[lanes], borrow[lanes] = {};
+                             a.signs(k, sa);
+                             b.signs(k, sb);
+                             limb_t *z = r.block(k);
+                             for (size_t j = 0; j < r.width; j++, z += lanes)
+                             {
+                                 const limb_t *x = a.limb(k, j, sa), *y = b.limb(k, j, sb);
+                                 for (size_t l = 0; l < lanes; l++)
+                                 {
+                                     limb_t d = x[l] - y[l];
+                                     limb_t t = d - borrow[l];
+                                     borrow[l] = (limb_t)(x[l] < y[l]) | (limb_t)(d < borrow[l]);
+                                     z[l] = t;
+                                 }
+                             }
+                         } });
+}
+
+inline void bigint_batch::multiply_block(limb_t *product, size_t width_, const bigint_batch &a, const bigint_batch &b, size_t k)
+{
+    using bigint_detail::dlimb_t;
+    const size_t an = min(a.width, width_), bn = min(b.width, width_);
+    const limb_t *ap = a.block(k), *bp = b.block(k);
+    limb_t sa[lanes], sb[lanes];
+    a.signs(k, sa);
+    b.signs(k, sb);
+    fill(product, product + width_ * lanes, 0);
+    /* Product of the limbs as unsigned numbers, row by row. */
+    for (size_t i = 0; i < an; i++)
+    {
+        limb_t carry[lanes] = {};
+        const limb_t *x = ap + i * lanes;
+        const size_t jn = min(bn, width_ - i);
+        for (size_t j = 0; j < jn; j++)
+        {
+            const limb_t *y = bp + j * lanes;
+            limb_t *z = product + (i + j) * lanes;
+            for (size_t l = 0; l < lanes; l++)
+            {
+                dlimb_t t = (dlimb_t)x[l] * y[l] + z[l] + carry[l];
+                z[l] = (limb_t)t;
+                carry[l] = (limb_t)(t >> 64);
+            }
+        }
+        if (i + jn < width_)
+        {
+            copy(carry, carry + lanes, product + (i + jn) * lanes);
+        }
+    }
+    /* With x = a mod B^an and y = b mod B^bn as unsigned numbers, a negative a is x - B^an and
+       a negative b is y - B^bn, so a b = x y - [b < 0] x B^bn - [a < 0] b B^an, where the last
+       term uses b itself, sign-extended. */
+    auto subtract_shifted = [&](size_t shift, const limb_t *mask, const bigint_batch &x, const limb_t *x_signs)
+    {
+        limb_t borrow[lanes] = {};
+        for (size_t j = shift; j < width_; j++)
+        {
+            const limb_t *v = x.limb(k, j - shift, x_signs);
+            limb_t *z = product + j * lanes;
+            for (size_t l = 0; l < lanes; l++)
+            {
+                limb_t w = v[l] & mask[l];
+                limb_t d = z[l] - w;
+                limb_t t = d - borrow[l];
+                borrow[l] = (limb_t)(z[l] < w) | (limb_t)(d < borrow[l]);
+                z[l] = t;
+            }
+        }
+    };
+    const limb_t zeros[lanes] = {};
+    if (b.width < width_)
+    {
+        subtract_shifted(b.width, sb, a, zeros);
+    }
+    if (a.width < width_)
+    {
+        subtract_shifted(a.width, sa, b, sb);
+    }
+}
+
+inline void mul(bigint_batch &r, const bigint_batch &a, const bigint_batch &b)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::batch, a.width);
+    constexpr size_t lanes = bigint_batch::lanes;
+    bigint_batch::check_sizes(r, a, b);
+    r.for_each_block([&](size_t first, size_t last)
+                     {
+                         bigint_detail::limb_vector product(r.width * lanes);
+                         for (size_t k = first; k < last; k++)
+                         {
+                             bigint_batch::multiply_block(product.data(), r.width, a, b, k);
+                             copy(product.data(), product.data() + r.width * lanes, r.block(k));
+                         } });
+}
+
+inline void cmp(vector<int> &r, const bigint_batch &a, const bigint_batch &b)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::batch, a.width);
+    using limb_t = bigint_detail::limb_t;
+    constexpr size_t lanes = bigint_batch::lanes;
+    if (a.count != b.count)
+    {
+        throw invalid_argument("batches of different sizes");
+    }
+    r.resize(a.count);
+    const size_t width = max(a.width, b.width);
+    a.for_each_block([&](size_t first, size_t last)
+                     {
+                         for (size_t k = first; k < last; k++)
+                         {
+                             limb_t sa[lanes], sb[lanes];
+                             a.signs(k, sa);
+                             b.signs(k, sb);
+                             int result[lanes] = {};
+                             /* The top limbs are compared as signed, by flipping their sign bits. */
+                             limb_t flip = (limb_t)1 << 63;
+                             for (size_t j = width; j-- > 0; flip = 0)
+                             {
+                                 const limb_t *x = a.limb(k, j, sa), *y = b.limb(k, j, sb);
+                                 for (size_t l = 0; l < lanes; l++)
+                                 {
+                                     limb_t u = x[l] ^ flip, v = y[l] ^ flip;
+                                     int c = (int)(u > v) - (int)(u < v);
+                                     result[l] = result[l] != 0 ? result[l] : c;
+                                 }
+                             }
+                             const size_t n = min(lanes, a.count - k * lanes);
+                             copy(result, result + n, r.begin() + (ptrdiff_t)(k * lanes));
+                         } });
+}
+
+inline void mulmod(bigint_batch &r, const bigint_batch &a, const bigint_batch &b, const bigint_modulus &m)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::batch, a.width);
+    using limb_t = bigint_detail::limb_t;
+    constexpr size_t lanes = bigint_batch::lanes;
+    bigint_batch::check_sizes(r, a, b);
+    const size_t n = m.n;
+    if (bigint_batch::width_of(m.m - 1) > r.width)
+    {
+        throw invalid_argument("batch too narrow for the modulus");
+    }
+    const size_t width = a.width + b.width;
+    r.for_each_block([&](size_t first, size_t last)
+                     {
+                         bigint_detail::limb_vector product(width * lanes), x(width), residue(n);
+                         bigint_detail::limb_vector padded(2 * n), scratch(m.reduction_scratch_size());
+                         for (size_t k = first; k < last; k++)
+                         {
+                             bigint_batch::multiply_block(product.data(), width, a, b, k);
+                             limb_t *z = r.block(k);
+                             fill(z, z + r.width * lanes, 0);
+                             const size_t lanes_used = min(lanes, r.count - k * lanes);
+                             for (size_t l = 0; l < lanes_used; l++)
+                             {
+                                 for (size_t j = 0; j < width; j++)
+                                 {
+                                     x[j] = product[j * lanes + l];
+                                 }
+                                 const bool negative = x[width - 1] >> 63;
+                                 if (negative)
+                                 {
+                                     bigint_detail::negate_n(x.data(), width);
+                                 }
+                                 m.residue(residue.data(), x.data(), width, negative, padded.data(), scratch.data());
+                                 for (size_t j = 0; j < n; j++)
+                                 {
+                                     z[j * lanes + l] = residue[j];
+                                 }
+                             }
+                         } });
+}
+
+/**
+ * @brief Integer of a fixed number of bits, stored in the object, with constexpr arithmetic.
+ *
+ * @details The value is held in Bits / 64 limbs, least significant first, as an unsigned
+ * number or, if Signed is set, as a two's complement one. Nothing is ever allocated and
+ * every operation is a loop over a constant number of limbs, which the compiler unrolls, so
+ * the class is meant for values with a known maximum width such as 128- to 512-bit keys,
+ * hashes and counters. All the operations except the conversions to and from bigint are
+ * constexpr, so constants and tables can be computed at compile time.
+ *
+ * With the fixed_wrap policy the results are reduced modulo 2^Bits. With fixed_checked an
+ * operation whose exact result does not fit throws an overflow_error, and a conversion of a
+ * value that does not fit throws an out_of_range; in a constant expression either one is a
+ * compilation error.
+ */
+template <size_t Bits, bool Signed, class Overflow>
+class fixed_bigint
+{
+    static_assert(Bits > 0 && Bits % 64 == 0, "the width of a fixed_bigint must be a multiple of 64 bits");
+    static_assert(is_same_v<Overflow, fixed_wrap> || is_same_v<Overflow, fixed_checked>,
+                  "the overflow policy must be fixed_wrap or fixed_checked");
+
+    using limb_t = bigint_detail::limb_t;
+    using dlimb_t = bigint_detail::dlimb_t;
+
+public:
+    static constexpr size_t bits = Bits;
+    static constexpr size_t limb_count = Bits / 64;
+    static constexpr bool is_signed = Signed;
+    static constexpr bool is_checked = is_same_v<Overflow, fixed_checked>;
+
+    /**
+     * @brief Constructs a zero.
+     */
+    constexpr fixed_bigint() {}
+    /**
+     * @brief Constructs the value of a built-in integer.
+     *
+     * @details Negative values are sign-extended. With fixed_checked, a negative value for an
+     * unsigned type, or a value of 2^63 or more for a signed 64-bit type, throws an out_of_range.
+     */
+    template <integral T>
+    constexpr fixed_bigint(T value)
+    {
+        bool negative = false;
+        if constexpr (is_signed_v<T>)
+        {
+            negative = value < 0;
+        }
+        limbs[0] = (limb_t)value;
+        for (size_t i = 1; i < limb_count; i++)
+        {
+            limbs[i] = negative ? ~(limb_t)0 : 0;
+        }
+        if constexpr (is_checked)
+        {
+            if (negative != is_negative())
+            {
+                throw out_of_range("value does not fit in the fixed_bigint");
+            }
+        }
+    }
+    /**
+     * @brief Constructs the value of a string of decimal digits, or of hexadecimal digits after
+     * a 0x prefix, with an optional leading '-'.
+     *
+     * @details An invalid_argument is thrown if the string is not an integer. A value out of
+     * range wraps around with fixed_wrap and throws an out_of_range with fixed_checked.
+     */
+    explicit constexpr fixed_bigint(string_view s)
+    {
+        const bool negative = !s.empty() && s[0] == '-';
+        size_t i = negative ? 1 : 0;
+        limb_t base = 10;
+        if (s.size() - i > 2 && s[i] == '0' && (s[i + 1] == 'x' || s[i + 1] == 'X'))
+        {
+            base = 16;
+            i += 2;
+        }
+        if (i == s.size())
+        {
+            throw invalid_argument("invalid integer");
+        }
+        bool overflow = false;
+        for (; i < s.size(); i++)
+        {
+            const limb_t digit = digit_value(s[i]);
+            if (digit >= base)
+            {
+                throw invalid_argument("invalid integer");
+            }
+            /* limbs = limbs * base + digit, with the carry out of the top limb. */
+            limb_t carry = digit;
+            for (size_t j = 0; j < limb_count; j++)
+            {
+                const dlimb_t t = (dlimb_t)limbs[j] * base + carry;
+                limbs[j] = (limb_t)t;
+                carry = (limb_t)(t >> 64);
+            }
+            overflow |= carry != 0;
+        }
+        if constexpr (is_checked)
+        {
+            /* The magnitude is at most 2^(Bits - 1) for a negative value and below it otherwise. */
+            const bool top = (limbs[limb_count - 1] >> 63) != 0;
+            if (overflow || (negative && !is_zero() && (!Signed || (top && !is_min()))) || (Signed && !negative && top))
+            {
+                throw out_of_range("value does not fit in the fixed_bigint");
+            }
+        }
+        if (negative)
+        {
+            negate();
+        }
+    }
+    explicit constexpr fixed_bigint(const char *s) : fixed_bigint(string_view(s)) {}
+    explicit constexpr fixed_bigint(const string &s) : fixed_bigint(string_view(s)) {}
+    /**
+     * @brief Converts a fixed_bigint of another width, signedness or policy.
+     *
+     * @details The value is sign-extended if x is signed and truncated to Bits bits; with
+     * fixed_checked, a value that changes in the conversion throws an out_of_range.
+     */
+    template <size_t OtherBits, bool OtherSigned, class OtherOverflow>
+    explicit constexpr fixed_bigint(const fixed_bigint<OtherBits, OtherSigned, OtherOverflow> &x)
+    {
+        constexpr size_t other_count = OtherBits / 64;
+        const limb_t fill_ = x.is_negative() ? ~(limb_t)0 : 0;
+        for (size_t i = 0; i < limb_count; i++)
+        {
+            limbs[i] = i < other_count ? x.limb(i) : fill_;
+        }
+        if constexpr (is_checked)
+        {
+            bool lost = x.is_negative() != is_negative();
+            for (size_t i = limb_count; i < other_count; i++)
+            {
+                lost |= x.limb(i) != fill_;
+            }
+            if (lost)
+            {
+                throw out_of_range("value does not fit in the fixed_bigint");
+            }
+        }
+    }
+    /**
+     * @brief Converts a bigint.
+     *
+     * @details The value is reduced modulo 2^Bits with fixed_wrap; with fixed_checked a value
+     * that does not fit throws an out_of_range.
+     */
+    explicit fixed_bigint(const bigint &x)
+    {
+        const size_t n = std::min(x.limbs.size(), limb_count);
+        copy(x.limbs.begin(), x.limbs.begin() + n, limbs);
+        if constexpr (is_checked)
+        {
+            /* The magnitude must fit in Bits bits, or Bits - 1 bits if signed, except for the
+               magnitude 2^(Bits - 1) of the smallest negative value. */
+            const bool top = (limbs[limb_count - 1] >> 63) != 0;
+            if (x.limbs.size() > limb_count || (x.negative && !Signed) || (Signed && top && !(x.negative && is_min())))
+            {
+                throw out_of_range("value does not fit in the fixed_bigint");
+            }
+        }
+        if (x.negative)
+        {
+            negate();
+        }
+    }
+    /**
+     * @brief Converts to a bigint.
+     */
+    explicit operator bigint() const
+    {
+        bigint result;
+        result.limbs.assign(limbs, limbs + limb_count);
+        if (is_negative())
+        {
+            bigint_detail::negate_n(result.limbs.data(), limb_count);
+            result.negative = true;
+        }
+        result.erase_left_zeros();
+        return result;
+    }
+    /**
+     * @brief Returns the decimal representation, with a leading '-' if negative.
+     */
+    string get_string() const
+    {
+        return bigint(*this).get_string();
+    }
+    /**
+     * @brief True unless the value is zero.
+     */
+    explicit constexpr operator bool() const
+    {
+        return !is_zero();
+    }
+
+    /**
+     * @brief Returns limb i of the two's complement representation, least significant first.
+     */
+    constexpr limb_t limb(size_t i) const
+    {
+        return limbs[i];
+    }
+    /**
+     * @brief True if the type is signed and the value is negative.
+     */
+    constexpr bool is_negative() const
+    {
+        return Signed && (limbs[limb_count - 1] >> 63) != 0;
+    }
+    /**
+     * @brief Returns the smallest value of the type: 0, or -2^(Bits - 1) if signed.
+     */
+    static constexpr fixed_bigint min()
+    {
+        fixed_bigint result;
+        if constexpr (Signed)
+        {
+            result.limbs[limb_count - 1] = (limb_t)1 << 63;
+        }
+        return result;
+    }
+    /**
+     * @brief Returns the largest value of the type: 2^Bits - 1, or 2^(Bits - 1) - 1 if signed.
+     */
+    static constexpr fixed_bigint max()
+    {
+        fixed_bigint result;
+        for (limb_t &l : result.limbs)
+        {
+            l = ~(limb_t)0;
+        }
+        if constexpr (Signed)
+        {
+            result.limbs[limb_count - 1] >>= 1;
+        }
+        return result;
+    }
+
+    constexpr fixed_bigint &operator+=(const fixed_bigint &y)
+    {
+        const bool sign = is_negative();
+        const limb_t carry = add_n(limbs, limbs, y.limbs);
+        if constexpr (is_checked)
+        {
+            if (Signed ? sign == y.is_negative() && sign != is_negative() : carry != 0)
+            {
+                throw overflow_error("fixed_bigint overflow");
+            }
+        }
+        return *this;
+    }
+    constexpr fixed_bigint &operator-=(const fixed_bigint &y)
+    {
+        const bool sign = is_negative();
+        const limb_t borrow = sub_n(limbs, limbs, y.limbs);
+        if constexpr (is_checked)
+        {
+            if (Signed ? sign != y.is_negative() && sign != is_negative() : borrow != 0)
+            {
+                throw overflow_error("fixed_bigint overflow");
+            }
+        }
+        return *this;
+    }
+    /**
+     * @brief Multiplies by y.
+     *
+     * @details With fixed_wrap only the low Bits bits of the product are computed, which are the
+     * same for signed and unsigned operands. With fixed_checked the full product of the
+     * magnitudes is computed to detect the overflow.
+     */
+    constexpr fixed_bigint &operator*=(const fixed_bigint &y)
+    {
+        if constexpr (!is_checked)
+        {
+            limb_t r[limb_count] = {};
+            unrolled<limb_count>([&](size_t i)
+                                 {
+                                     limb_t carry = 0;
+                                     unrolled<limb_count>([&](size_t j)
+                                                          {
+                                                              if (i + j < limb_count)
+                                                              {
+                                                                  const dlimb_t t = (dlimb_t)limbs[i] * y.limbs[j] + r[i + j] + carry;
+                                                                  r[i + j] = (limb_t)t;
+                                                                  carry = (limb_t)(t >> 64);
+                                                              } }); });
+            copy(r, r + limb_count, limbs);
+        }
+        else
+        {
+            const bool negative = is_negative() != y.is_negative();
+            fixed_bigint a = *this, b = y;
+            if (a.is_negative())
+            {
+                a.negate();
+            }
+            if (b.is_negative())
+            {
+                b.negate();
+            }
+            limb_t r[2 * limb_count] = {};
+            for (size_t i = 0; i < limb_count; i++)
+            {
+                limb_t carry = 0;
+                for (size_t j = 0; j < limb_count; j++)
+                {
+                    const dlimb_t t = (dlimb_t)a.limbs[i] * b.limbs[j] + r[i + j] + carry;
+                    r[i + j] = (limb_t)t;
+                    carry = (limb_t)(t >> 64);
+                }
+                r[i + limb_count] = carry;
+            }
+            bool overflow = false;
+            for (size_t i = limb_count; i < 2 * limb_count; i++)
+            {
+                overflow |= r[i] != 0;
+            }
+            copy(r, r + limb_count, limbs);
+            if constexpr (Signed)
+            {
+                overflow |= (limbs[limb_count - 1] >> 63) != 0 && !(negative && is_min());
+            }
+            else
+            {
+                overflow |= negative && !is_zero();
+            }
+            if (overflow)
+            {
+                throw overflow_error("fixed_bigint overflow");
+            }
+            if (negative)
+            {
+                negate();
+            }
+        }
+        return *this;
+    }
+    /**
+     * @brief Shifts left by count bits; with fixed_checked, losing a significant bit throws an
+     * overflow_error.
+     */
+    constexpr fixed_bigint &operator<<=(size_t count)
+    {
+        const fixed_bigint original = *this;
+        const size_t whole = std::min(count / 64, limb_count);
+        const unsigned part = (unsigned)(count % 64);
+        for (size_t i = limb_count; i-- > 0;)
+        {
+            limb_t l = 0;
+            if (i >= whole)
+            {
+                l = limbs[i - whole] << part;
+                if (part != 0 && i > whole)
+                {
+                    l |= limbs[i - whole - 1] >> (64 - part);
+                }
+            }
+            limbs[i] = l;
+        }
+        if constexpr (is_checked)
+        {
+            fixed_bigint back = *this;
+            back >>= count;
+            if (back != original || is_negative() != original.is_negative())
+            {
+                throw overflow_error("fixed_bigint overflow");
+            }
+        }
+        return *this;
+    }
+    /**
+     * @brief Shifts right by count bits, replicating the sign bit if the type is signed, so
+     * that signed values are divided by 2^count rounding toward minus infinity.
+     */
+    constexpr fixed_bigint &operator>>=(size_t count)
+    {
+        const limb_t fill_ = is_negative() ? ~(limb_t)0 : 0;
+        const size_t whole = std::min(count / 64, limb_count);
+        const unsigned part = (unsigned)(count % 64);
+        for (size_t i = 0; i < limb_count; i++)
+        {
+            const limb_t low = i + whole < limb_count ? limbs[i + whole] : fill_;
+            const limb_t high = i + whole + 1 < limb_count ? limbs[i + whole + 1] : fill_;
+            limbs[i] = part == 0 ? low : (low >> part) | (high << (64 - part));
+        }
+        return *this;
+    }
+
+    friend constexpr fixed_bigint operator+(fixed_bigint x, const fixed_bigint &y)
+    {
+        return x += y;
+    }
+    friend constexpr fixed_bigint operator-(fixed_bigint x, const fixed_bigint &y)
+    {
+        return x -= y;
+    }
+    friend constexpr fixed_bigint operator*(fixed_bigint x, const fixed_bigint &y)
+    {
+        return x *= y;
+    }
+    friend constexpr fixed_bigint operator<<(fixed_bigint x, size_t count)
+    {
+        return x <<= count;
+    }
+    friend constexpr fixed_bigint operator>>(fixed_bigint x, size_t count)
+    {
+        return x >>= count;
+    }
+    /**
+     * @brief Negation; with fixed_checked, negating a nonzero unsigned value or the smallest
+     * signed value throws an overflow_error.
+     */
+    friend constexpr fixed_bigint operator-(fixed_bigint x)
+    {
+        if constexpr (is_checked)
+        {
+            if (Signed ? x.is_min() : !x.is_zero())
+            {
+                throw overflow_error("fixed_bigint overflow");
+            }
+        }
+        x.negate();
+        return x;
+    }
+    friend constexpr bool operator==(const fixed_bigint &x, const fixed_bigint &y)
+    {
+        for (size_t i = 0; i < limb_count; i++)
+        {
+            if (x.limbs[i] != y.limbs[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * @brief Three-way comparison, signed or unsigned according to the type.
+     */
+    friend constexpr strong_ordering operator<=>(const fixed_bigint &x, const fixed_bigint &y)
+    {
+        if (x.is_negative() != y.is_negative())
+        {
+            return x.is_negative() ? strong_ordering::less : strong_ordering::greater;
+        }
+        /* With equal signs the two's complement limbs compare as unsigned numbers. */
+        for (size_t i = limb_count; i-- > 0;)
+        {
+            if (x.limbs[i] != y.limbs[i])
+            {
+                return x.limbs[i] < y.limbs[i] ? strong_ordering::less : strong_ordering::greater;
+            }
+        }
+        return strong_ordering::equal;
+    }
+    friend ostream &operator<<(ostream &out, const fixed_bigint &x)
+    {
+        return out << x.get_string();
+    }
+
+private:
+    limb_t limbs[limb_count] = {};
+
+    constexpr bool is_zero() const
+    {
+        limb_t any = 0;
+        for (limb_t l : limbs)
+        {
+            any |= l;
+        }
+        return any == 0;
+    }
+    /* True if the bits are those of 2^(Bits - 1), the smallest signed value. */
+    constexpr bool is_min() const
+    {
+        for (size_t i = 0; i + 1 < limb_count; i++)
+        {
+            if (limbs[i] != 0)
+            {
+                return false;
+            }
+        }
+        return limbs[limb_count - 1] == (limb_t)1 << 63;
+    }
+    /* Replaces the value by its two's complement. */
+    constexpr void negate()
+    {
+        limb_t borrow = 0;
+        for (limb_t &l : limbs)
+        {
+            const limb_t v = l;
+            l = 0 - v - borrow;
+            borrow = (v | borrow) != 0;
+        }
+    }
+    /* Calls f(i) for i = 0, ..., n - 1 with the loop unrolled at compile time. */
+    template <size_t n, class F>
+    static constexpr void unrolled(const F &f)
+    {
+        [&]<size_t... i>(index_sequence<i...>)
+        {
+            (f(i), ...);
+        }(make_index_sequence<n>{});
+    }
+    static constexpr limb_t add_n(limb_t *r, const limb_t *a, const limb_t *b)
+    {
+        limb_t carry = 0;
+        unrolled<limb_count>([&](size_t i)
+                             {
+                                 const limb_t s = a[i] + b[i];
+                                 const limb_t t = s + carry;
+                                 carry = (limb_t)(s < a[i]) + (limb_t)(t < s);
+                                 r[i] = t; });
+        return carry;
+    }
+    static constexpr limb_t sub_n(limb_t *r, const limb_t *a, const limb_t *b)
+    {
+        limb_t borrow = 0;
+        unrolled<limb_count>([&](size_t i)
+                             {
+                                 const limb_t d = a[i] - b[i];
+                                 const limb_t t = d - borrow;
+                                 borrow = (limb_t)(a[i] < b[i]) + (limb_t)(d < borrow);
+                                 r[i] = t; });
+        return borrow;
+    }
+    /* Value of a decimal or hexadecimal digit, or 16 for any other character. */
+    static constexpr limb_t digit_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return (limb_t)(c - '0');
+        }
+        if (c >= 'a' && c <= 'f')
+        {
+            return (limb_t)(c - 'a' + 10);
+        }
+        if (c >= 'A' && c <= 'F')
+        {
+            return (limb_t)(c - 'A' + 10);
+        }
+        return 16;
+    }
+};
+
+/* Unsigned and signed fixed_bigint of Bits bits. */
+template <size_t Bits, class Overflow = fixed_wrap>
+using fixed_uint = fixed_bigint<Bits, false, Overflow>;
+template <size_t Bits, class Overflow = fixed_wrap>
+using fixed_int = fixed_bigint<Bits, true, Overflow>;
+
+namespace bigint_detail
+{
+    /**
+     * @brief Kernels of decimal_bigint, on limbs that each hold 18 decimal digits.
+     *
+     * @details A limb is a digit in base 10^18 < 2^60, so the sum of two limbs and a carry never
+     * overflows a limb, and a product of two limbs plus two more limbs is below 10^18 B. Such a
+     * product is split into its two base 10^18 digits with the same reciprocal division as
+     * divrem_1, so no operation needs a hardware division. The pointer arguments follow the
+     * conventions of the binary kernels: r may be a or b, and sizes are in limbs.
+     */
+    namespace decimal
+    {
+        constexpr limb_t base = 1000000000000000000ULL;
+        constexpr size_t base_digits = 18;
+        /* The base shifted to have its top bit set, and its reciprocal, for div2by1. */
+        constexpr unsigned base_shift = 4;
+        constexpr limb_t base_normalized = base << base_shift;
+        constexpr limb_t base_reciprocal = reciprocal(base_normalized);
+        /* Operands of at least this many limbs are multiplied with Karatsuba. The column sums
+           of mul_basecase, of fewer products than this, must stay below 2^128. */
+        constexpr size_t karatsuba_threshold = 48;
+        static_assert((dlimb_t)karatsuba_threshold * base * base < ~(dlimb_t)0 / 2);
+
+        /* Splits t < 10^18 B, returning t / 10^18 and storing t % 10^18 in low. */
+        inline limb_t split(dlimb_t t, limb_t &low)
+        {
+            const limb_t u1 = (limb_t)(t >> 64), u0 = (limb_t)t;
+            limb_t rem;
+            const limb_t q = div2by1(rem, u1 << base_shift | u0 >> (64 - base_shift), u0 << base_shift,
+                                     base_normalized, base_reciprocal);
+            low = rem >> base_shift;
+            return q;
+        }
+        inline limb_t add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            limb_t carry = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                const limb_t s = a[i] + b[i] + carry;
+                carry = s >= base;
+                r[i] = s - (carry != 0 ? base : 0);
+            }
+            return carry;
+        }
+        /* r = a + b for a single limb b < 10^18, returning the carry. */
+        inline limb_t add_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+        {
+            size_t i = 0;
+            for (; i < n && b != 0; i++)
+            {
+                const limb_t s = a[i] + b;
+                b = s >= base;
+                r[i] = s - (b != 0 ? base : 0);
+            }
+            if (r != a)
+            {
+                copy(a + i, a + n, r + i);
+            }
+            return b;
+        }
+        inline limb_t sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            limb_t borrow = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                const limb_t d = a[i] - b[i] - borrow;
+                borrow = a[i] < b[i] + borrow;
+                r[i] = d + (borrow != 0 ? base : 0);
+            }
+            return borrow;
+        }
+        /* r = a - b for a single limb b < 10^18, returning the borrow. */
+        inline limb_t sub_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+        {
+            size_t i = 0;
+            for (; i < n && b != 0; i++)
+            {
+                const limb_t d = a[i] - b;
+                b = a[i] < b;
+                r[i] = d + (b != 0 ? base : 0);
+            }
+            if (r != a)
+            {
+                copy(a + i, a + n, r + i);
+            }
+            return b;
+        }
+        /* q = a / d for a limb 0 < d < 10^18, returning the remainder. q may be a. */
+        inline limb_t divrem_1(limb_t *q, const limb_t *a, size_t n, limb_t d)
+        {
+            /* The dividend rem 10^18 + a[i] < d 10^18 is shifted as a two-limb number, as in
+               the binary divrem_1. */
+            const unsigned shift = (unsigned)__builtin_clzll(d);
+            const limb_t dn = d << shift, v = reciprocal(dn);
+            limb_t rem = 0;
+            for (size_t i = n; i-- > 0;)
+            {
+                const dlimb_t t = ((dlimb_t)rem * base + a[i]) << shift;
+                q[i] = div2by1(rem, (limb_t)(t >> 64), (limb_t)t, dn, v);
+                rem >>= shift;
+            }
+            return rem;
+        }
+        /**
+         * @brief r = a * b for an >= bn >= 1, with r of an + bn limbs not overlapping a or b.
+         *
+         * @details The product is computed a column at a time: the at most bn products of limb
+         * k of r, each below 10^36, are summed in a dlimb_t, which is then split once. Splitting
+         * every product, as a row-by-row addmul_1 would, costs several times more.
+         */
+        inline void mul_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+        {
+            dlimb_t carry = 0;
+            for (size_t k = 0; k + 1 < an + bn; k++)
+            {
+                dlimb_t sum = carry;
+                const size_t last = std::min(k, bn - 1);
+                for (size_t j = k >= an ? k - an + 1 : 0; j <= last; j++)
+                {
+                    sum += (dlimb_t)a[k - j] * b[j];
+                }
+                /* The sum may reach 10^18 B, so its high limb is reduced before the split. */
+                const limb_t high = (limb_t)(sum >> 64);
+                const limb_t q = split((dlimb_t)(high % base) << 64 | (limb_t)sum, r[k]);
+                carry = (dlimb_t)(high / base) << 64 | q;
+            }
+            r[an + bn - 1] = (limb_t)carry;
+        }
+        /**
+         * @brief r = a * b for an >= bn >= 1, with r of an + bn limbs not overlapping a or b.
+         *
+         * @details Karatsuba multiplication, as in the binary mul: a0 b0 and a1 b1 go to the
+         * low and high halves of r, and (a0 + a1)(b0 + b1) - a0 b0 - a1 b1 is added in the
+         * middle. An unbalanced product is computed as a sum of bn by bn products.
+         */
+        inline void mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+        {
+            if (bn < karatsuba_threshold)
+            {
+                mul_basecase(r, a, an, b, bn);
+                return;
+            }
+            if (an > bn)
+            {
+                fill(r, r + an + bn, 0);
+                limb_vector t(2 * bn);
+                for (size_t i = 0; i < an; i += bn)
+                {
+                    const size_t n = std::min(bn, an - i);
+                    if (n == bn)
+                    {
+                        mul(t.data(), a + i, n, b, bn);
+                    }
+                    else
+                    {
+                        mul(t.data(), b, bn, a + i, n);
+                    }
+                    const limb_t carry = add_n(r + i, r + i, t.data(), n + bn);
+                    add_1(r + i + n + bn, r + i + n + bn, an - i - n, carry);
+                }
+                return;
+            }
+            const size_t n = an, h = n / 2, hh = n - h;
+            mul(r, a, h, b, h);
+            mul(r + 2 * h, a + h, hh, b + h, hh);
+            limb_vector sa(hh + 1), sb(hh + 1), middle(2 * hh + 2);
+            copy(a + h, a + n, sa.data());
+            copy(b + h, b + n, sb.data());
+            sa[hh] = add_1(sa.data() + h, sa.data() + h, hh - h, add_n(sa.data(), sa.data(), a, h));
+            sb[hh] = add_1(sb.data() + h, sb.data() + h, hh - h, add_n(sb.data(), sb.data(), b, h));
+            mul(middle.data(), sa.data(), hh + 1, sb.data(), hh + 1);
+            limb_t *m = middle.data();
+            sub_1(m + 2 * h, m + 2 * h, 2 * hh + 2 - 2 * h, sub_n(m, m, r, 2 * h));
+            sub_1(m + 2 * hh, m + 2 * hh, 2, sub_n(m, m, r + 2 * h, 2 * hh));
+            const limb_t carry = add_n(r + h, r + h, m, 2 * hh + 2);
+            add_1(r + h + 2 * hh + 2, r + h + 2 * hh + 2, n + hh - 2 * hh - 2, carry);
+        }
+    }
+}
+
+/**
+ * @brief Arbitrary-precision integer stored in base 10^18, for programs that mostly add, compare
+ * and print decimal numbers.
+ *
+ * @details The value is kept in sign-magnitude form like bigint, but every limb holds 18
+ * decimal digits, least significant first. Reading and writing decimal text is then a linear
+ * pass over the digits, where bigint needs a divide-and-conquer conversion that costs a few
+ * multiplications of the whole number, and digit_length is exact and constant-time. Addition,
+ * subtraction and comparison are linear as in bigint; multiplication uses Karatsuba above a
+ * few dozen limbs. Division by a value below 10^18 is a single linear pass, and any other
+ * division converts the operands to bigint and back, so a division-heavy program should use
+ * bigint. The right shift, the bitwise operators, the bit queries, isqrt, iroot, gcd and xgcd
+ * convert as well; the left shift, addmul and submul are computed in base 10^18. The limbs are a bigint_detail::limb_vector, so small values are stored inline,
+ * heap buffers come from current_resource() and copies share their buffer.
+ *
+ * The operators and functions have the same meaning as the ones of bigint, and the explicit
+ * conversions to and from bigint are exact. basic_bigint<decimal_radix> names this class. The
+ * modular, number-theoretic, random and serialization functions take bigint only.
+ */
+class decimal_bigint
+{
+    using limb_t = bigint_detail::limb_t;
+
+public:
+    /* The base of the limbs and the number of decimal digits in a limb. */
+    static constexpr limb_t base = bigint_detail::decimal::base;
+    static constexpr size_t base_digits = bigint_detail::decimal::base_digits;
+
+    /**
+     * @brief Default constructor initializing the value to 0.
+     */
+    decimal_bigint() {}
+    /**
+     * @brief Constructor initializing the value with a 64-bit integer.
+     */
+    decimal_bigint(const int64_t x_)
+    {
+        *this = x_;
+    }
+    /**
+     * @brief Constructor initializing the value with a string of decimal digits, with an
+     * optional leading '-'. An invalid_argument is thrown if the string is not an integer.
+     */
+    decimal_bigint(const string &x_)
+    {
+        set_string(x_);
+    }
+    /**
+     * @brief Converts a bigint exactly, with about the cost of x.get_string() but without the
+     * string.
+     *
+     * @details The magnitude is split by powers 10^(18 2^k) with the division of bigint, down
+     * to pieces of conversion_dc limbs that are divided by 10^18 one limb at a time.
+     */
+    explicit decimal_bigint(const bigint &x);
+    /**
+     * @brief Converts to a bigint exactly, with about the cost of bigint::set_string but
+     * without the string.
+     *
+     * @details The two halves of the limbs are converted recursively and combined with one
+     * multiplication by a power 10^(18 2^k), down to pieces of conversion_dc limbs that are
+     * accumulated one limb at a time.
+     */
+    explicit operator bigint() const;
+    decimal_bigint &operator=(const int64_t &i);
+    decimal_bigint &operator=(const string &s)
+    {
+        set_string(s);
+        return *this;
+    }
+    /**
+     * @brief Stores the value of a string of decimal digits, with an optional leading '-', in
+     * linear time. An invalid_argument is thrown if the string is not an integer.
+     */
+    void set_string(const string &x_);
+    /**
+     * @brief Returns the decimal representation, with a leading '-' if negative, in linear time.
+     */
+    string get_string() const;
+    /**
+     * @brief Returns the number of decimal digits of the magnitude, 0 for zero.
+     */
+    size_t digit_length() const;
+    /**
+     * @brief Bit queries and updates on the two's complement form, as for bigint. Each one
+     * converts the value to bigint, so a program that works on bits should use bigint.
+     */
+    uint64_t bit_length() const;
+    uint64_t popcount() const;
+    uint64_t count_trailing_zeros() const;
+    bool test_bit(uint64_t i) const;
+    void set_bit(uint64_t i);
+    void clear_bit(uint64_t i);
+
+    friend bool operator==(const decimal_bigint &x, const decimal_bigint &y)
+    {
+        return x.negative == y.negative && x.limbs.size() == y.limbs.size() &&
+               equal(x.limbs.begin(), x.limbs.end(), y.limbs.begin());
+    }
+    /**
+     * @brief Three-way comparison; the limbs of two magnitudes compare like their digits.
+     */
+    friend strong_ordering operator<=>(const decimal_bigint &x, const decimal_bigint &y);
+    friend decimal_bigint &operator+=(decimal_bigint &x, const decimal_bigint &y);
+    friend decimal_bigint &operator-=(decimal_bigint &x, const decimal_bigint &y);
+    friend decimal_bigint &operator*=(decimal_bigint &x, const decimal_bigint &y);
+    /**
+     * @brief Computes the quotient, truncated toward zero, and the remainder, which has the sign
+     * of x, as for bigint. A domain_error is thrown if y is zero.
+     */
+    friend pair<decimal_bigint, decimal_bigint> divmod(const decimal_bigint &x, const decimal_bigint &y);
+    friend decimal_bigint operator-(decimal_bigint x)
+    {
+        x.negative = !x.negative && !x.limbs.empty();
+        return x;
+    }
+    /**
+     * @brief Writes the decimal representation to the stream, one limb at a time, without
+     * building the whole string.
+     */
+    friend ostream &operator<<(ostream &out, const decimal_bigint &x);
+
+private:
+    bigint_detail::limb_vector limbs;
+    bool negative = false;
+
+    void erase_left_zeros()
+    {
+        while (!limbs.empty() && limbs.back() == 0)
+        {
+            limbs.pop_back();
+        }
+        if (limbs.empty())
+        {
+            negative = false;
+        }
+    }
+    /* x = x + y, or x - y if subtract is set, for any signs of x and y. */
+    static void add(decimal_bigint &x, const decimal_bigint &y, bool subtract);
+    /* Number of limbs up to which the conversions to and from bigint work a limb at a time. */
+    static size_t conversion_basecase()
+    {
+        return max<size_t>(bigint_detail::tuning.conversion_dc, 1);
+    }
+    /* Writes the value of the n limbs at a, which need not be normalized, into out in base
+       2^64, normalized. */
+    static void to_binary(bigint_detail::limb_vector &out, const limb_t *a, size_t n);
+    /* Writes the value of the n limbs at a in base 2^64, which must be below 10^(18 rn), into
+       the rn limbs at r. */
+    static void from_binary(limb_t *r, size_t rn, const limb_t *a, size_t n);
+    /* Writes the 18 digits of a limb, with leading zeros, at out. */
+    static void print_limb(char *out, limb_t value)
+    {
+        /* Two independent halves of 9 digits, in 32-bit arithmetic. */
+        uint32_t high = (uint32_t)(value / 1000000000), low = (uint32_t)(value % 1000000000);
+        for (size_t j = base_digits / 2; j-- > 0;)
+        {
+            out[j] = (char)('0' + high % 10);
+            out[j + base_digits / 2] = (char)('0' + low % 10);
+            high /= 10;
+            low /= 10;
+        }
+    }
+};
+
+inline decimal_bigint &decimal_bigint::operator=(const int64_t &i)
+{
+    /* Negating in unsigned arithmetic keeps INT64_MIN representable. */
+    uint64_t magnitude = i < 0 ? 0 - (uint64_t)i : (uint64_t)i;
+    limbs.clear();
+    for (; magnitude != 0; magnitude /= base)
+    {
+        limbs.push_back(magnitude % base);
+    }
+    negative = i < 0;
+    return *this;
+}
+inline void decimal_bigint::set_string(const string &x_)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::from_string, (x_.size() + base_digits - 1) / base_digits);
+    const size_t start = (!x_.empty() && x_[0] == '-') ? 1 : 0;
+    if (start == x_.size() || !all_digits(x_.data() + start, x_.size() - start))
+    {
+        throw invalid_argument("invalid integer");
+    }
+    /* Every limb takes the 18 digits that end where the previous one begins, and the most
+       significant limb the leftover digits. */
+    const size_t len = x_.size() - start;
+    limbs.resize((len + base_digits - 1) / base_digits);
+    limb_t *out = limbs.data();
+    size_t end = x_.size();
+    for (size_t i = 0; i < limbs.size(); i++, end -= base_digits)
+    {
+        const size_t digits = std::min(base_digits, end - start);
+        out[i] = parse_digits(x_.data() + end - digits, digits);
+    }
+    negative = start == 1;
+    erase_left_zeros();
+}
+inline string decimal_bigint::get_string() const
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::to_string, limbs.size());
+    if (limbs.empty())
+    {
+        return "0";
+    }
+    const string top = to_string(limbs.back());
+    string out;
+    out.resize((negative ? 1 : 0) + top.size() + (limbs.size() - 1) * base_digits);
+    char *p = out.data();
+    if (negative)
+    {
+        *p++ = '-';
+    }
+    p = copy(top.begin(), top.end(), p);
+    for (size_t i = limbs.size() - 1; i-- > 0; p += base_digits)
+    {
+        print_limb(p, limbs[i]);
+    }
+    return out;
+}
+inline size_t decimal_bigint::digit_length() const
+{
+    if (limbs.empty())
+    {
+        return 0;
+    }
+    size_t digits = (limbs.size() - 1) * base_digits + 1;
+    for (limb_t top = limbs.back(); top >= 10; top /= 10)
+    {
+        digits++;
+    }
+    return digits;
+}
+inline void decimal_bigint::to_binary(bigint_detail::limb_vector &out, const limb_t *a, size_t n)
+{
+    using namespace bigint_detail;
+    if (n <= conversion_basecase())
+    {
+        /* Horner's rule; out stays normalized since a zero carry is never pushed. */
+        out.clear();
+        out.reserve(n);
+        for (size_t i = n; i-- > 0;)
+        {
+            limb_t carry = mul_1(out.data(), out.data(), out.size(), base);
+            carry += add_1(out.data(), out.data(), out.size(), a[i]);
+            if (carry != 0)
+            {
+                out.push_back(carry);
+            }
+        }
+        return;
+    }
+    /* The low part has the largest power of two of limbs below n, 18 2^k digits. */
+    const size_t k = (size_t)bit_width(n - 1) - 1, m = (size_t)1 << k;
+    limb_vector high, low;
+    to_binary(high, a + m, n - m);
+    to_binary(low, a, m);
+    combine_power(out, high, low, five_power<base_digits>(k), base_digits << k);
+}
+inline void decimal_bigint::from_binary(limb_t *r, size_t rn, const limb_t *a, size_t n)
+{
+    using namespace bigint_detail;
+    n = normalized_size(a, n);
+    if (rn <= conversion_basecase())
+    {
+        limb_vector t(a, a + n);
+        for (size_t i = 0; i < rn; i++)
+        {
+            r[i] = n == 0 ? 0 : divrem_1(t.data(), t.data(), n, base);
+            n = normalized_size(t.data(), n);
+        }
+        return;
+    }
+    const size_t k = (size_t)bit_width(rn - 1) - 1, m = (size_t)1 << k;
+    const size_t low_digits = base_digits << k;
+    if (n <= low_digits / 64)
+    {
+        /* a < 2^(64 n) <= 10^(18 m) fits in the low part. */
+        from_binary(r, m, a, n);
+        fill(r + m, r + rn, 0);
+        return;
+    }
+    limb_vector q, low;
+    split_power(q, low, a, n, five_power<base_digits>(k), low_digits);
+    from_binary(r, m, low.data(), low.size());
+    from_binary(r + m, rn - m, q.data(), q.size());
+}
+inline decimal_bigint::decimal_bigint(const bigint &x)
+{
+    /* Every limb holds more than 59 bits, so the top limbs may be zero. */
+    const size_t n = x.limbs.empty() ? 0 : 64 * x.limbs.size() / 59 + 1;
+    limbs.resize(n);
+    from_binary(limbs.data(), n, x.limbs.data(), x.limbs.size());
+    negative = x.negative;
+    erase_left_zeros();
+}
+inline decimal_bigint::operator bigint() const
+{
+    bigint result;
+    to_binary(result.limbs, limbs.data(), limbs.size());
+    result.negative = negative;
+    return result;
+}
+inline uint64_t decimal_bigint::bit_length() const
+{
+    return bigint(*this).bit_length();
+}
+inline uint64_t decimal_bigint::popcount() const
+{
+    return bigint(*this).popcount();
+}
+inline uint64_t decimal_bigint::count_trailing_zeros() const
+{
+    return bigint(*this).count_trailing_zeros();
+}
+inline bool decimal_bigint::test_bit(uint64_t i) const
+{
+    return bigint(*this).test_bit(i);
+}
+inline void decimal_bigint::set_bit(uint64_t i)
+{
+    bigint x(*this);
+    x.set_bit(i);
+    *this = decimal_bigint(x);
+}
+inline void decimal_bigint::clear_bit(uint64_t i)
+{
+    bigint x(*this);
+    x.clear_bit(i);
+    *this = decimal_bigint(x);
+}
+inline strong_ordering operator<=>(const decimal_bigint &x, const decimal_bigint &y)
+{
+    bigint_detail::operation_scope scope(bigint_stats::operation::compare, max(x.limbs.size(), y.limbs.size()));
+    if (x.negative != y.negative)
+    {
+        return x.negative ? strong_ordering::less : strong_ordering::greater;
+    }
+    int c = bigint_detail::cmp(x.limbs.data(), x.limbs.size(), y.limbs.data(), y.limbs.size());
+    if (x.negative)
+    {
+        c = -c;
+    }
+    return c < 0 ? strong_ordering::less : c > 0 ? strong_ordering::greater : strong_ordering::equal;
+}
+inline void decimal_bigint::add(decimal_bigint &x, const decimal_bigint &y, bool subtract)
+{
+    using namespace bigint_detail;
+    operation_scope scope(subtract ? bigint_stats::operation::sub : bigint_stats::operation::add,
+                          max(x.limbs.size(), y.limbs.size()));
+    const size_t xn = x.limbs.size(), yn = y.limbs.size();
+    if (x.negative != (y.negative != subtract))
+    {
+        /* Opposite signs: the smaller magnitude is subtracted from the larger one, and the
+           result takes the sign of the larger. */
+        const int c = cmp(x.limbs.data(), xn, y.limbs.data(), yn);
+        if (c == 0)
+        {
+            x = 0;
+            return;
+        }
+        if (c > 0)
+        {
+            limb_t *r = x.limbs.data();
+            decimal::sub_1(r + yn, r + yn, xn - yn, decimal::sub_n(r, r, y.limbs.data(), yn));
+        }
+        else
+        {
+            x.limbs.resize(yn);
+            limb_t *r = x.limbs.data();
+            const limb_t *b = y.limbs.data();
+            decimal::sub_1(r + xn, b + xn, yn - xn, decimal::sub_n(r, b, r, xn));
+            x.negative = !x.negative;
+        }
+        x.erase_left_zeros();
+        return;
+    }
+    if (xn < yn)
+    {
+        x.limbs.resize(yn);
+    }
+    /* y is read after x is resized, which may move the limbs of x when y is x. */
+    limb_t *r = x.limbs.data();
+    const limb_t *b = y.limbs.data();
+    const size_t n = max(xn, yn);
+    limb_t carry = decimal::add_n(r, r, b, yn);
+    carry = decimal::add_1(r + yn, r + yn, n - yn, carry);
+    if (carry != 0)
+    {
+        x.limbs.push_back(carry);
+    }
+}
+inline decimal_bigint &operator+=(decimal_bigint &x, const decimal_bigint &y)
+{
+    decimal_bigint::add(x, y, false);
+    return x;
+}
+inline decimal_bigint &operator-=(decimal_bigint &x, const decimal_bigint &y)
+{
+    decimal_bigint::add(x, y, true);
+    return x;
+}
+inline decimal_bigint &operator*=(decimal_bigint &x, const decimal_bigint &y)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::mul, max(x.limbs.size(), y.limbs.size()));
+    if (x.limbs.empty() || y.limbs.empty())
+    {
+        x = 0;
+        return x;
+    }
+    const size_t xn = x.limbs.size(), yn = y.limbs.size();
+    limb_vector result(xn + yn);
+    if (xn >= yn)
+    {
+        decimal::mul(result.data(), x.limbs.data(), xn, y.limbs.data(), yn);
+    }
+    else
+    {
+        decimal::mul(result.data(), y.limbs.data(), yn, x.limbs.data(), xn);
+    }
+    x.limbs = move(result);
+    x.negative = x.negative != y.negative;
+    x.erase_left_zeros();
+    return x;
+}
+inline pair<decimal_bigint, decimal_bigint> divmod(const decimal_bigint &x, const decimal_bigint &y)
+{
+    using namespace bigint_detail;
+    operation_scope scope(bigint_stats::operation::div, x.limbs.size());
+    if (y.limbs.empty())
+    {
+        throw domain_error("division by zero");
+    }
+    if (y.limbs.size() > 1)
+    {
+        pair<bigint, bigint> result = divmod(bigint(x), bigint(y));
+        return {decimal_bigint(result.first), decimal_bigint(result.second)};
+    }
+    pair<decimal_bigint, decimal_bigint> result;
+    decimal_bigint &q = result.first, &r = result.second;
+    q.limbs.resize(x.limbs.size());
+    const limb_t rem = decimal::divrem_1(q.limbs.data(), x.limbs.data(), x.limbs.size(), y.limbs[0]);
+    q.negative = x.negative != y.negative;
+    q.erase_left_zeros();
+    r = (int64_t)rem;
+    r.negative = rem != 0 && x.negative;
+    return result;
+}
+inline ostream &operator<<(ostream &out, const decimal_bigint &x)
+{
+    if (x.limbs.empty())
+    {
+        return out << '0';
+    }
+    /* A field width pads the text as a whole, so it needs the whole string. */
+    if (out.width() != 0)
+    {
+        return out << x.get_string();
+    }
+    /* Otherwise whole limbs are formatted into a buffer that is written when full. */
+    char buffer[4096];
+    size_t n = 0;
+    if (x.negative)
+    {
+        buffer[n++] = '-';
+    }
+    const string top = to_string(x.limbs.back());
+    n = (size_t)(copy(top.begin(), top.end(), buffer + n) - buffer);
+    for (size_t i = x.limbs.size() - 1; i-- > 0;)
+    {
+        if (n + decimal_bigint::base_digits > sizeof(buffer))
+        {
+            out.write(buffer, (streamsize)n);
+            n = 0;
+        }
+        decimal_bigint::print_limb(buffer + n, x.limbs[i]);
+        n += decimal_bigint::base_digits;
+    }
+    return out.write(buffer, (streamsize)n);
+}
+/**
+ * @brief Extracts a decimal integer from a stream, with the same rules as for bigint.
+ *
+ * @details If no digit is found the failbit is set and x is left unchanged.
+ */
+inline istream &operator>>(istream &in, decimal_bigint &x)
+{
+    istream::sentry sentry(in);
+    if (!sentry)
+    {
+        return in;
+    }
+    streambuf *buffer = in.rdbuf();
+    string s;
+    int c = buffer->sgetc();
+    if (c == '-')
+    {
+        s.push_back('-');
+        c = buffer->snextc();
+    }
+    while (c != char_traits<char>::eof() && c >= '0' && c <= '9')
+    {
+        s.push_back((char)c);
+        c = buffer->snextc();
+    }
+    if (c == char_traits<char>::eof())
+    {
+        in.setstate(ios::eofbit);
+    }
+    if (s.empty() || s == "-")
+    {
+        in.setstate(ios::failbit);
+        return in;
+    }
+    x.set_string(s);
+    return in;
+}
+inline decimal_bigint operator+(const decimal_bigint &x, const decimal_bigint &y)
+{
+    decimal_bigint result = x;
+    result += y;
+    return result;
+}
+/* The overloads for temporaries compute the result in the buffer of one of them, as for bigint. */
+inline decimal_bigint operator+(decimal_bigint &&x, const decimal_bigint &y)
+{
+    x += y;
+    return move(x);
+}
+inline decimal_bigint operator+(const decimal_bigint &x, decimal_bigint &&y)
+{
+    y += x;
+    return move(y);
+}
+inline decimal_bigint operator+(decimal_bigint &&x, decimal_bigint &&y)
+{
+    x += y;
+    return move(x);
+}
+inline decimal_bigint operator-(const decimal_bigint &x, const decimal_bigint &y)
+{
+    decimal_bigint result = x;
+    result -= y;
+    return result;
+}
+inline decimal_bigint operator-(decimal_bigint &&x, const decimal_bigint &y)
+{
+    x -= y;
+    return move(x);
+}
+inline decimal_bigint operator-(const decimal_bigint &x, decimal_bigint &&y)
+{
+    y -= x;
+    return -move(y);
+}
+inline decimal_bigint operator-(decimal_bigint &&x, decimal_bigint &&y)
+{
+    x -= y;
+    return move(x);
+}
+inline decimal_bigint operator*(const decimal_bigint &x, const decimal_bigint &y)
+{
+    decimal_bigint result = x;
+    result *= y;
+    return result;
+}
+inline decimal_bigint operator*(decimal_bigint &&x, const decimal_bigint &y)
+{
+    x *= y;
+    return move(x);
+}
+inline decimal_bigint operator*(const decimal_bigint &x, decimal_bigint &&y)
+{
+    y *= x;
+    return move(y);
+}
+inline decimal_bigint operator*(decimal_bigint &&x, decimal_bigint &&y)
+{
+    x *= y;
+    return move(x);
+}
+inline decimal_bigint operator/(const decimal_bigint &x, const decimal_bigint &y)
+{
+    return divmod(x, y).first;
+}
+inline decimal_bigint operator%(const decimal_bigint &x, const decimal_bigint &y)
+{
+    return divmod(x, y).second;
+}
+inline decimal_bigint &operator/=(decimal_bigint &x, const decimal_bigint &y)
+{
+    x = divmod(x, y).first;
+    return x;
+}
+inline decimal_bigint &operator%=(decimal_bigint &x, const decimal_bigint &y)
+{
+    x = divmod(x, y).second;
+    return x;
+}
+/**
+ * @brief Raises base to the power exponent by repeated squaring; 0^0 is 1.
+ */
+inline decimal_bigint pow(decimal_bigint base, uint64_t exponent)
+{
+    decimal_bigint result = 1;
+    for (; exponent != 0; exponent >>= 1)
+    {
+        if (exponent & 1)
+        {
+            result *= base;
+        }
+        if (exponent > 1)
+        {
+            base *= base;
+        }
+    }
+    return result;
+}
+/**
+ * @brief x += a * b and x -= a * b, as for bigint.
+ */
+inline void addmul(decimal_bigint &x, const decimal_bigint &a, const decimal_bigint &b)
+{
+    x += a * b;
+}
+inline void submul(decimal_bigint &x, const decimal_bigint &a, const decimal_bigint &b)
+{
+    x -= a * b;
+}
+/**
+ * @brief x * 2^count, computed in base 10^18 as a product by a power of two.
+ */
+inline decimal_bigint operator<<(const decimal_bigint &x, uint64_t count)
+{
+    return count == 0 ? x : x * pow(decimal_bigint(2), count);
+}
+inline decimal_bigint &operator<<=(decimal_bigint &x, uint64_t count)
+{
+    if (count != 0)
+    {
+        x *= pow(decimal_bigint(2), count);
+    }
+    return x;
+}
+/*
+ * The right shift, the bitwise operators, the roots and the greatest common divisor work on
+ * the binary representation: they convert their operands to bigint and the result back, and
+ * give the same results as for bigint.
+ */
+inline decimal_bigint operator>>(const decimal_bigint &x, uint64_t count)
+{
+    return decimal_bigint(bigint(x) >> count);
+}
+inline decimal_bigint &operator>>=(decimal_bigint &x, uint64_t count)
+{
+    x = x >> count;
+    return x;
+}
+inline decimal_bigint operator&(const decimal_bigint &x, const decimal_bigint &y)
+{
+    return decimal_bigint(bigint(x) & bigint(y));
+}
+inline decimal_bigint operator|(const decimal_bigint &x, const decimal_bigint &y)
+{
+    return decimal_bigint(bigint(x) | bigint(y));
+}
+inline decimal_bigint operator^(const decimal_bigint &x, const decimal_bigint &y)
+{
+    return decimal_bigint(bigint(x) ^ bigint(y));
+}
+/**
+ * @brief Bitwise complement, -x - 1, which needs no conversion.
+ */
+inline decimal_bigint operator~(const decimal_bigint &x)
+{
+    return -x - 1;
+}
+inline decimal_bigint &operator&=(decimal_bigint &x, const decimal_bigint &y)
+{
+    x = x & y;
+    return x;
+}
+inline decimal_bigint &operator|=(decimal_bigint &x, const decimal_bigint &y)
+{
+    x = x | y;
+    return x;
+}
+inline decimal_bigint &operator^=(decimal_bigint &x, const decimal_bigint &y)
+{
+    x = x ^ y;
+    return x;
+}
+inline decimal_bigint isqrt(const decimal_bigint &x)
+{
+    return decimal_bigint(isqrt(bigint(x)));
+}
+inline decimal_bigint iroot(const decimal_bigint &x, uint64_t k)
+{
+    return decimal_bigint(iroot(bigint(x), k));
+}
+inline decimal_bigint gcd(const decimal_bigint &x, const decimal_bigint &y)
+{
+    return decimal_bigint(gcd(bigint(x), bigint(y)));
+}
+inline tuple<decimal_bigint, decimal_bigint, decimal_bigint> xgcd(const decimal_bigint &x, const decimal_bigint &y)
+{
+    const auto [g, s, t] = xgcd(bigint(x), bigint(y));
+    return {decimal_bigint(g), decimal_bigint(s), decimal_bigint(t)};
+}
+
+/**
+ * @brief Radix policy of basic_bigint: limbs in base 2^64, the representation of bigint.
+ * Arithmetic is fastest in this base, and decimal text is converted with subquadratic
+ * divide-and-conquer algorithms.
+ */
+struct binary_radix
+{
+    using integer = bigint;
+};
+/**
+ * @brief Radix policy of basic_bigint: limbs in base 10^18, the representation of
+ * decimal_bigint. Decimal text is read and written in linear time.
+ */
+struct decimal_radix
+{
+    using integer = decimal_bigint;
+};
+/* The arbitrary-precision integer with the limbs of a radix policy. Both types have the same
+   constructors, string functions, operators, bit queries, and divmod, pow, isqrt, iroot, gcd,
+   xgcd, addmul and submul, and convert to each other explicitly. */
+template <class Radix>
+using basic_bigint = typename Radix::integer;
+
+namespace bigint_detail
+{
+    /* Header of the binary format of write_binary; see its documentation. */
+    constexpr char binary_magic[8] = {'B', 'I', 'G', 'I', 'N', 'T', 'S', '\0'};
+    constexpr uint32_t binary_version = 1;
+    constexpr uint32_t binary_indexed = 1;
+    constexpr size_t binary_header_size = 24;
+
+    /* Converts between the byte order of the host and the little-endian order of the format. */
+    inline limb_t little_endian(limb_t x)
+    {
+        if constexpr (endian::native == endian::big)
+        {
+            return __builtin_bswap64(x);
+        }
+        return x;
+    }
+    inline void write_word(ostream &out, limb_t x)
+    {
+        x = little_endian(x);
+        out.write(reinterpret_cast<const char *>(&x), sizeof(x));
+    }
+    inline void write_limbs(ostream &out, const limb_t *a, size_t n)
+    {
+        if constexpr (endian::native == endian::little)
+        {
+            out.write(reinterpret_cast<const char *>(a), (streamsize)(n * sizeof(limb_t)));
+        }
+        else
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                write_word(out, a[i]);
+            }
+        }
+    }
+    /* Reads from the stream buffer directly, which costs much less than istream::read for the
+       small records of most values. */
+    inline void read_bytes(istream &in, void *p, size_t n)
+    {
+        if (in.rdbuf() == nullptr || in.rdbuf()->sgetn(static_cast<char *>(p), (streamsize)n) != (streamsize)n)
+        {
+            in.setstate(ios::failbit | ios::eofbit);
+            throw invalid_argument("truncated bigint data");
+        }
+    }
+    inline limb_t read_word(istream &in)
+    {
+        limb_t x;
+        read_bytes(in, &x, sizeof(x));
+        return little_endian(x);
+    }
+    /* Reads the header and returns the number of values and the flags. */
+    inline pair<uint64_t, uint32_t> read_header(istream &in)
+    {
+        char magic[8];
+        read_bytes(in, magic, sizeof(magic));
+        const limb_t version_and_flags = read_word(in);
+        const uint32_t version = (uint32_t)version_and_flags, flags = (uint32_t)(version_and_flags >> 32);
+        if (!equal(magic, magic + 8, binary_magic) || version == 0 || version > binary_version || (flags & ~binary_indexed) != 0)
+        {
+            throw invalid_argument("invalid bigint data");
+        }
+        return {read_word(in), flags};
+    }
+}
+
+inline void write_binary(ostream &out, const vector<bigint> &values, bool index = true)
+{
+    using namespace bigint_detail;
+    out.write(binary_magic, sizeof(binary_magic));
+    write_word(out, binary_version | (limb_t)(index ? binary_indexed : 0) << 32);
+    write_word(out, values.size());
+    if (index)
+    {
+        limb_t offset = binary_header_size + 8 * values.size();
+        for (const bigint &x : values)
+        {
+            write_word(out, offset);
+            offset += 8 * (x.limbs.size() + 1);
+        }
+    }
+    for (const bigint &x : values)
+    {
+        write_word(out, 2 * x.limbs.size() + x.negative);
+        write_limbs(out, x.limbs.data(), x.limbs.size());
+    }
+}
+
+inline void write_binary(ostream &out, const bigint &x)
+{
+    using namespace bigint_detail;
+    out.write(binary_magic, sizeof(binary_magic));
+    write_word(out, binary_version);
+    write_word(out, 1);
+    write_word(out, 2 * x.limbs.size() + x.negative);
+    write_limbs(out, x.limbs.data(), x.limbs.size());
+}
+
+inline void read_binary(istream &in, vector<bigint> &values)
+{
+    using namespace bigint_detail;
+    const auto [count, flags] = read_header(in);
+    if ((flags & binary_indexed) != 0)
+    {
+        if (count > (uint64_t)numeric_limits<streamsize>::max() / 8 ||
+            in.ignore((streamsize)(8 * count)).gcount() != (streamsize)(8 * count))
+        {
+            throw invalid_argument("truncated bigint data");
+        }
+    }
+    values.clear();
+    /* Bounded, since the count has not been checked against the data yet. */
+    values.reserve((size_t)min<uint64_t>(count, 1 << 20));
+    for (uint64_t i = 0; i < count; i++)
+    {
+        const limb_t word = read_word(in);
+        const limb_t n = word >> 1;
+        bigint x;
+        /* The buffer grows with the data actually read, so a corrupt size fails on the missing
+           data instead of on a huge allocation. */
+        const size_t step = size_t(1) << 20;
+        for (size_t done = 0; done < n;)
+        {
+            const size_t chunk = (size_t)min<limb_t>(n - done, step);
+            x.limbs.resize(done + chunk);
+            read_bytes(in, x.limbs.data() + done, chunk * sizeof(limb_t));
+            for (size_t j = done; j < done + chunk; j++)
+            {
+                x.limbs[j] = little_endian(x.limbs[j]);
+            }
+            done += chunk;
+        }
+        if ((n > 0 && x.limbs.back() == 0) || (n == 0 && (word & 1) != 0))
+        {
+            throw invalid_argument("invalid bigint data");
+        }
+        x.negative = (word & 1) != 0;
+        values.push_back(move(x));
+    }
+}
+
+inline void read_binary(istream &in, bigint &x)
+{
+    vector<bigint> values;
+    read_binary(in, values);
+    if (values.size() != 1)
+    {
+        throw invalid_argument("invalid bigint data");
+    }
+    x = move(values[0]);
+}
+
+/**
+ * @brief Read-only reference to an integer stored elsewhere, such as in a mapped file.
+ *
+ * @details A view is a pointer to the limbs of a magnitude, its number of limbs and a sign,
+ * in the representation of bigint: least significant limb first, no most significant zero
+ * limb, and no sign for zero. It does not own the limbs, which must outlive it. Views are
+ * compared and combined with +, -, *, / and % without copying their limbs, and the results
+ * are new bigint values. A bigint converts to a view implicitly, so the operators also accept
+ * one view and one bigint.
+ */
+class bigint_view
+{
+    using limb_t = bigint_detail::limb_t;
+
+public:
+    /**
+     * @brief Constructs a view of zero.
+     */
+    bigint_view() {}
+    /**
+     * @brief Constructs a view of the limbs of x, which must outlive it and not change.
+     */
+    bigint_view(const bigint &x) : limbs(x.limbs.data()), n(x.limbs.size()), negative(x.negative) {}
+    /**
+     * @brief Constructs a view of the magnitude limbs_[0..n_) with the given sign.
+     *
+     * @details limbs_[n_ - 1] must not be zero, and negative_ must be false when n_ is zero.
+     */
+    bigint_view(const limb_t *limbs_, size_t n_, bool negative_) : limbs(limbs_), n(n_), negative(negative_) {}
+
+    const limb_t *data() const
+    {
+        return limbs;
+    }
+    size_t size() const
+    {
+        return n;
+    }
+    bool is_negative() const
+    {
+        return negative;
+    }
+    /**
+     * @brief Copies the value into a bigint.
+     */
+    explicit operator bigint() const
+    {
+        bigint result;
+        result.limbs.assign(limbs, limbs + n);
+        result.negative = negative;
+        return result;
+    }
+    /**
+     * @brief Returns the decimal representation, with a leading '-' if negative.
+     */
+    string get_string() const;
+
+    friend int compare(bigint_view x, bigint_view y);
+    friend bool operator==(bigint_view x, bigint_view y)
+    {
+        return compare(x, y) == 0;
+    }
+    friend bool operator!=(bigint_view x, bigint_view y)
+    {
+        return compare(x, y) != 0;
+    }
+    friend bool operator<(bigint_view x, bigint_view y)
+    {
+        return compare(x, y) < 0;
+    }
+    friend bool operator>(bigint_view x, bigint_view y)
+    {
+        return compare(x, y) > 0;
+    }
+    friend bool operator<=(bigint_view x, bigint_view y)
+    {
+        return compare(x, y) <= 0;
+    }
+    friend bool operator>=(bigint_view x, bigint_view y)
+    {
+        return compare(x, y) >= 0;
+    }
+    friend bigint operator+(bigint_view x, bigint_view y)
+    {
+        return sum(x, y, false);
+    }
+    friend bigint operator-(bigint_view x, bigint_view y)
+    {
+        return sum(x, y, true);
+    }
+    friend bigint operator*(bigint_view x, bigint_view y)
+    {
+        return product(x, y);
+    }
+    /**
+     * @brief Quotient and remainder, with the rounding of divmod for bigint.
+     */
+    friend pair<bigint, bigint> divmod(bigint_view x, bigint_view y)
+    {
+        return quotient(x, y);
+    }
+    friend bigint operator/(bigint_view x, bigint_view y)
+    {
+        return divmod(x, y).first;
+    }
+    friend bigint operator%(bigint_view x, bigint_view y)
+    {
+        return divmod(x, y).second;
+    }
+    friend ostream &operator<<(ostream &out, bigint_view x)
+    {
+        return out << x.get_string();
+    }
+
+private:
+    const limb_t *limbs = nullptr;
+    size_t n = 0;
+    bool negative = false;
+
+    /* x + y, or x - y if subtract is set. */
+    static bigint sum(bigint_view x, bigint_view y, bool subtract);
+    static bigint product(bigint_view x, bigint_view y);
+    static pair<bigint, bigint> quotient(bigint_view x, bigint_view y);
+};
+
+inline int compare(bigint_view x, bigint_view y)
+{
+    if (x.negative != y.negative)
+    {
+        return x.negative ? -1 : 1;
+    }
+    const int c = bigint_detail::cmp(x.limbs, x.n, y.limbs, y.n);
+    return x.negative ? -c : c;
+}
+
+inline bigint bigint_view::sum(bigint_view x, bigint_view y, bool subtract)
+{
+    using namespace bigint_detail;
+    bool x_negative = x.negative, y_negative = y.negative != subtract;
+    if (x.n < y.n)
+    {
+        swap(x, y);
+        swap(x_negative, y_negative);
+    }
+    bigint result;
+    if (x_negative == y_negative)
+    {
+        result.limbs.resize(x.n + 1);
+        limb_t *r = result.limbs.data();
+        const limb_t carry = add_n(r, x.limbs, y.limbs, y.n);
+        r[x.n] = add_1(r + y.n, x.limbs + y.n, x.n - y.n, carry);
+        result.negative = x_negative;
+    }
+    else
+    {
+        result.limbs.resize(x.n);
+        result.negative = abs_diff(result.limbs.data(), x.limbs, x.n, y.limbs, y.n) ? y_negative : x_negative;
+    }
+    result.erase_left_zeros();
+    return result;
+}
+
+inline bigint bigint_view::product(bigint_view x, bigint_view y)
+{
+    using namespace bigint_detail;
+    bigint result;
+    if (x.n == 0 || y.n == 0)
+    {
+        return result;
+    }
+    if (x.n < y.n)
+    {
+        swap(x, y);
+    }
+    result.limbs.resize(x.n + y.n);
+    mul(result.limbs.data(), x.limbs, x.n, y.limbs, y.n);
+    result.negative = x.negative != y.negative;
+    result.erase_left_zeros();
+    return result;
+}
+
+inline pair<bigint, bigint> bigint_view::quotient(bigint_view x, bigint_view y)
+{
+    using namespace bigint_detail;
+    if (y.n == 0)
+    {
+        throw domain_error("division by zero");
+    }
+    pair<bigint, bigint> result;
+    bigint &q = result.first, &r = result.second;
+    if (cmp(x.limbs, x.n, y.limbs, y.n) < 0)
+    {
+        r = bigint(x);
+        return result;
+    }
+    q.limbs.resize(x.n - y.n + 1);
+    r.limbs.resize(y.n);
+    divrem(q.limbs.data(), r.limbs.data(), x.limbs, x.n, y.limbs, y.n);
+    q.erase_left_zeros();
+    r.erase_left_zeros();
+    q.negative = !q.limbs.empty() && x.negative != y.negative;
+    r.negative = !r.limbs.empty() && x.negative;
+    return result;
+}
+
+inline string bigint_view::get_string() const
 {
-    if (lhs == rhs)
+    if (n == 0)
     {
-        return false;
+        return "0";
+    }
+    /* A limb holds less than 20 decimal digits; the leading zeros of the padding are dropped. */
+    const size_t width = n * 20;
+    string out(width + 1, '-');
+    bigint_detail::print_decimal(&out[1], width, limbs, n);
+    const size_t first = out.find_first_not_of('0', 1);
+    if (negative)
+    {
+        out.erase(1, first - 1);
     }
     else
     {
-        return !(lhs < rhs);
+        out.erase(0, first);
     }
-};
-/**
- * @brief Less or equal to comparison operator for bigint objects.
- *
- * @param lhs The left-hand-side bigint object to compare.
- *
- * @param rhs The right-hand-side bigint object to compare.
- *
- * @details the function uses the pre-define less than and equal to operators.
- *
- * @return A boolean object, true if lhs is les or equal to rhs, false otherwise
- */
-bool operator<=(const bigint &lhs, const bigint &rhs)
-{
-    return ((lhs < rhs) || (lhs == rhs));
+    return out;
 }
+
 /**
- * @brief Bigger or equal to comparison operator for bigint objects.
- *
- * @param lhs The left-hand-side bigint object to compare.
- *
- * @param rhs The right-hand-side bigint object to compare.
- *
- * @details the function uses the pre-define bigger-than and equal-to operators.
+ * @brief Random access to the values of a buffer in the binary format of write_binary, such
+ * as a mapped file, without copying or parsing them.
  *
- * @return A boolean object, true if lhs is les or equal to rhs, false otherwise
+ * @details Opening an archive only checks its header, so it takes the same time for any
+ * number of values, provided it was written with an index; without one, the records are
+ * scanned once to find their offsets. Each record is checked when it is accessed, and an
+ * invalid_argument is thrown if it lies outside the buffer or is not normalized. The buffer
+ * must be aligned to 8 bytes, as the memory of a mapped file is, and must outlive the archive
+ * and its views. Since the limbs are used in place, archives need a little-endian host; on
+ * other hosts read_binary must be used instead.
  */
-bool operator>=(const bigint &lhs, const bigint &rhs)
+class bigint_archive
 {
-    return ((lhs > rhs) || (lhs == rhs));
-};
+    using limb_t = bigint_detail::limb_t;
 
-bigint operator-(bigint x)
-{
-    x.biginteger.replace(0, 2, to_string(-1 * stoi(x.biginteger.substr(0, 2))));
-    return x;
-}
+public:
+    bigint_archive(const void *data_, size_t size_);
 
-void unsigned_sum(bigint &x, bigint &y) /*Sum of two positive numbers*/
-{
-    if (x.biginteger.size() <= y.biginteger.size())
+    /**
+     * @brief Returns the number of values.
+     */
+    size_t size() const
     {
-        int8_t tens = 0;
-        x.biginteger.insert(0, string(y.biginteger.size() - x.biginteger.size(), '0'));
-        for (uint64_t i = y.biginteger.size() - 1; i > 0; i--)
-        {
-            int8_t c = stoi(string(1, x.biginteger[i])) + stoi(string(1, y.biginteger[i]));
-            if (c + tens >= 10)
-            {
-                c -= 10;
-                x.biginteger.replace(i, 1, to_string(c + tens));
-                tens = 1;
-            }
-            else
-            {
-                x.biginteger.replace(i, 1, to_string(c + tens));
-                tens = 0;
-            }
-        }
-        int8_t c = stoi(string(1, x.biginteger[0])) + stoi(string(1, y.biginteger[0]));
-        x.biginteger.replace(0, 1, to_string(c + tens));
+        return count;
     }
-    else
+    /**
+     * @brief Returns a view of value i, which is valid as long as the buffer.
+     */
+    bigint_view operator[](size_t i) const;
+    /**
+     * @brief Copies all the values into bigint objects.
+     */
+    vector<bigint> to_vector() const;
+
+private:
+    const unsigned char *data = nullptr;
+    size_t bytes = 0;
+    size_t count = 0;
+    /* The index of the file, or nullptr if it has none and offsets was filled by scanning. */
+    const limb_t *index = nullptr;
+    vector<limb_t> offsets;
+
+    limb_t word(size_t offset) const
     {
-        int8_t tens = 0;
-        y.biginteger.insert(0, string(x.biginteger.size() - y.biginteger.size(), '0'));
-        for (uint64_t i = y.biginteger.size() - 1; i > 0; i--)
-        {
-            int8_t c = stoi(string(1, x.biginteger[i])) + stoi(string(1, y.biginteger[i]));
-            if (c + tens >= 10)
-            {
-                c -= 10;
-                x.biginteger.replace(i, 1, to_string(c + tens));
-                tens = 1;
-            }
-            else
-            {
-                x.biginteger.replace(i, 1, to_string(c + tens));
-                tens = 0;
-            }
-        }
-        int8_t c = stoi(string(1, x.biginteger[0])) + stoi(string(1, y.biginteger[0]));
-        x.biginteger.replace(0, 1, to_string(c + tens));
-        y.erase_left_zeros(); // ask if use this is better than passing a copy
+        limb_t x;
+        memcpy(&x, data + offset, sizeof(x));
+        return x;
     }
-}
+};
 
-void unsigned_subtraction(bigint &x, bigint &y) /*Difference of two positive numbers*/
+inline bigint_archive::bigint_archive(const void *data_, size_t size_)
+    : data(static_cast<const unsigned char *>(data_)), bytes(size_)
 {
-    if (x <= y)
+    using namespace bigint_detail;
+    if constexpr (endian::native != endian::little)
+    {
+        throw invalid_argument("bigint_archive needs a little-endian host");
+    }
+    if (reinterpret_cast<uintptr_t>(data) % alignof(limb_t) != 0)
+    {
+        throw invalid_argument("bigint_archive needs a buffer aligned to 8 bytes");
+    }
+    if (bytes < binary_header_size || memcmp(data, binary_magic, sizeof(binary_magic)) != 0)
     {
-        int8_t tens = 0;
-        x.biginteger.insert(0, string(y.biginteger.size() - x.biginteger.size(), '0'));
-        for (uint64_t i = y.biginteger.size() - 1; i > 0; i--)
+        throw invalid_argument("invalid bigint data");
+    }
+    const limb_t version_and_flags = word(8), n = word(16);
+    const uint32_t version = (uint32_t)version_and_flags, flags = (uint32_t)(version_and_flags >> 32);
+    if (version == 0 || version > binary_version || (flags & ~binary_indexed) != 0)
+    {
+        throw invalid_argument("invalid bigint data");
+    }
+    count = (size_t)n;
+    if ((flags & binary_indexed) != 0)
+    {
+        if (n > (bytes - binary_header_size) / 8)
         {
-            int8_t c = stoi(string(1, y.biginteger[i])) - stoi(string(1, x.biginteger[i]));
-            if (c + tens < 0)
-            {
-                c += 10;
-                x.biginteger.replace(i, 1, to_string(c + tens));
-                tens = -1;
-            }
-            else
-            {
-                x.biginteger.replace(i, 1, to_string(c + tens));
-                tens = 0;
-            }
+            throw invalid_argument("invalid bigint data");
         }
-        int8_t c = stoi(string(1, y.biginteger[0])) - stoi(string(1, x.biginteger[0]));
-        x.biginteger.replace(0, 1, to_string(c + tens));
-        x.erase_left_zeros();
-        y.erase_left_zeros();
-        x = -x;
+        index = reinterpret_cast<const limb_t *>(data + binary_header_size);
+        return;
     }
-    else
+    offsets.reserve((size_t)min<limb_t>(n, (bytes - binary_header_size) / 8));
+    size_t offset = binary_header_size;
+    for (limb_t i = 0; i < n; i++)
     {
-        int8_t tens = 0;
-        y.biginteger.insert(0, string(x.biginteger.size() - y.biginteger.size(), '0'));
-        for (uint64_t i = y.biginteger.size() - 1; i > 0; i--)
+        if (offset > bytes - 8 || (word(offset) >> 1) > (bytes - offset - 8) / 8)
         {
-            int8_t c = stoi(string(1, x.biginteger[i])) - stoi(string(1, y.biginteger[i]));
-            if (c + tens < 0)
-            {
-                c += 10;
-                x.biginteger.replace(i, 1, to_string(c + tens));
-                tens = -1;
-            }
-            else
-            {
-                x.biginteger.replace(i, 1, to_string(c + tens));
-                tens = 0;
-            }
+            throw invalid_argument("invalid bigint data");
         }
-        int8_t c = stoi(string(1, x.biginteger[0])) - stoi(string(1, y.biginteger[0]));
-        x.biginteger.replace(0, 1, to_string(c + tens));
-        x.erase_left_zeros();
-        y.erase_left_zeros();
+        offsets.push_back(offset);
+        offset += 8 * (size_t)((word(offset) >> 1) + 1);
     }
 }
 
-bigint &operator+=(bigint &x, bigint &y) // I think I can pass "y" as reference
+inline bigint_view bigint_archive::operator[](size_t i) const
 {
-    if (x.biginteger[0] == '-' && y.biginteger[0] != '-')
+    const limb_t offset = index != nullptr ? index[i] : offsets[i];
+    if (offset % 8 != 0 || offset < bigint_detail::binary_header_size || offset > bytes - 8)
     {
-        x.biginteger.erase(0, 1);
-        unsigned_subtraction(x, y);
-        x = -x;
-        return x;
+        throw invalid_argument("invalid bigint data");
     }
-    else if (y.biginteger[0] == '-' && x.biginteger[0] != '-')
+    const limb_t header = word((size_t)offset), n = header >> 1;
+    const bool negative = (header & 1) != 0;
+    if (n > (bytes - offset - 8) / 8)
     {
-        y.biginteger.erase(0, 1);
-        unsigned_subtraction(x, y);
-        y.biginteger.insert(0, "-");
-        return x;
+        throw invalid_argument("invalid bigint data");
     }
-    else if (x.biginteger[0] == '-' && y.biginteger[0] == '-')
+    const limb_t *limbs = reinterpret_cast<const limb_t *>(data + offset + 8);
+    if ((n > 0 && limbs[n - 1] == 0) || (n == 0 && negative))
     {
-        x.biginteger.erase(0, 1);
-        y.biginteger.erase(0, 1);
-        unsigned_sum(x, y);
-        x = -x;
-        y = -y;
-        return x;
+        throw invalid_argument("invalid bigint data");
     }
-    else
+    return bigint_view(limbs, (size_t)n, negative);
+}
+
+inline vector<bigint> bigint_archive::to_vector() const
+{
+    vector<bigint> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; i++)
     {
-        unsigned_sum(x, y);
-        return x;
+        values.push_back(bigint((*this)[i]));
     }
+    return values;
 }
+
+#if __has_include(<sys/mman.h>)
 /**
- * @brief Summation operation for bigint instances.
- *
- * @param x The left-hand side bigint.
+ * @brief Read-only memory mapping of a whole file, to open a bigint_archive on it.
  *
- * @param y The right-hand side bigint.
- *
- * @details This function computes the summation x+y and returns a new bigint with the result of
- * the sum. This function uses the pre-defined += operator.
+ * @details The pages are only read from the disk when they are accessed, so opening an
+ * archive of any size is immediate and its values are loaded on demand. A system_error is
+ * thrown if the file cannot be opened or mapped.
  */
-bigint operator+(bigint x, bigint &y)
-{
-    x += y;
-    return x;
-}
-
-bigint &operator-=(bigint &x, bigint &y)
+class bigint_mapped_file
 {
-    if (x.biginteger[0] == '-' && y.biginteger[0] != '-')
+public:
+    explicit bigint_mapped_file(const string &path)
     {
-        y = -y;
-        x += y;
-        y = -y;
-        return x;
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw system_error(errno, generic_category(), path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            const int error = errno;
+            close(fd);
+            throw system_error(error, generic_category(), path);
+        }
+        bytes = (size_t)st.st_size;
+        if (bytes > 0)
+        {
+            void *p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                const int error = errno;
+                close(fd);
+                throw system_error(error, generic_category(), path);
+            }
+            address = p;
+        }
+        close(fd);
     }
-    else if (y.biginteger[0] == '-' && x.biginteger[0] != '-')
+    ~bigint_mapped_file()
     {
-        y.biginteger.erase(0, 1);
-        x += y;
-        y.biginteger.insert(0, "-");
-        return x;
+        if (address != nullptr)
+        {
+            munmap(address, bytes);
+        }
     }
-    else if (x.biginteger[0] == '-' && y.biginteger[0] == '-')
+    bigint_mapped_file(const bigint_mapped_file &) = delete;
+    bigint_mapped_file &operator=(const bigint_mapped_file &) = delete;
+
+    const void *data() const
     {
-        x.biginteger.erase(0, 1);
-        y.biginteger.erase(0, 1);
-        unsigned_subtraction(x, y);
-        x = -x;
-        y = -y;
-        return x;
+        return address;
     }
-    else
+    size_t size() const
     {
-        unsigned_subtraction(x, y);
-        return x;
+        return bytes;
     }
-}
+
+private:
+    void *address = nullptr;
+    size_t bytes = 0;
+};
+#endif
+
 /**
- * @brief Subtraction operation for bigint instances.
- *
- * @param x The left-hand side bigint.
- *
- * @param y The right-hand side bigint.
+ * @brief Converts a decimal number given in pieces, such as the successive buffers of a file
+ * or a socket, into a bigint.
  *
- * @details This function computes the subtraction x-y and returns a new bigint with the result of
- * the subtraction. This function uses the pre-defined -= and erase_left_zeros operators.
+ * @details The digits are checked as they arrive and converted a block of 1216 digits at a
+ * time. The blocks are combined in a balanced tree, like the carries of a binary counter: two
+ * pending values that stand for the same number of digits are merged as soon as they exist,
+ * with the divide-and-conquer step of set_string. The cost is the same as for set_string,
+ * and the memory used is that of the binary value plus one block, never the whole text.
  */
-bigint operator-(bigint x, bigint &y)
-{
-    x -= y;
-    x.erase_left_zeros();
-    return x;
-}
-ostream &operator<<(ostream &out, const bigint &x)
+class bigint_parser
 {
-    out << x.biginteger;
-    return out;
+public:
+    /**
+     * @brief Number of digits converted at once, 19 2^6.
+     */
+    static constexpr size_t block_digits = bigint_detail::decimal_base_digits << 6;
+
+    /**
+     * @brief Appends the next characters of the number.
+     *
+     * @details The first character of the number may be a '-'; every other character must be a
+     * decimal digit, otherwise an invalid_argument is thrown and the parser must be reset.
+     */
+    void feed(string_view chunk);
+    void feed(const char *chunk, size_t n)
+    {
+        feed(string_view(chunk, n));
+    }
+    /**
+     * @brief Returns the number of digits received so far.
+     */
+    size_t digits() const
+    {
+        return digit_count;
+    }
+    /**
+     * @brief Returns the number and resets the parser for another one.
+     *
+     * @details An invalid_argument is thrown if no digit was received.
+     */
+    bigint finish();
+    /**
+     * @brief Discards what was received so far.
+     */
+    void reset();
+
+private:
+    using limb_vector = bigint_detail::limb_vector;
+
+    /* Converted blocks, from the most significant; a node of level k holds 19 2^k digits and
+       the levels decrease strictly toward the back. */
+    vector<pair<limb_vector, size_t>> nodes;
+    string pending;
+    size_t digit_count = 0;
+    bool negative = false;
+    bool started = false;
+
+    /* Converts the full block in pending and merges the nodes of equal level. */
+    void push_block();
 };
 
-bigint &operator*=(bigint &x, bigint &y)
+inline void bigint_parser::feed(string_view chunk)
 {
-    if ((x.biginteger[0] != '0' && y.biginteger[0] == '0'))
+    using namespace bigint_detail;
+    if (!started && !chunk.empty())
     {
-        x = 0;
-        return x;
+        started = true;
+        if (chunk[0] == '-')
+        {
+            negative = true;
+            chunk.remove_prefix(1);
+        }
+    }
+    if (!all_digits(chunk.data(), chunk.size()))
+    {
+        throw invalid_argument("invalid integer");
     }
-    bigint a(1);
-    if ((x.biginteger[0] != '-' && y.biginteger[0] == '-'))
+    digit_count += chunk.size();
+    while (!chunk.empty())
     {
-        y = -y;
-        bigint z = x;
-        for (bigint i(1); i < y; unsigned_sum(i, a))
+        const size_t n = min(chunk.size(), block_digits - pending.size());
+        pending.append(chunk.data(), n);
+        chunk.remove_prefix(n);
+        if (pending.size() == block_digits)
         {
-            unsigned_sum(x, z);
+            push_block();
         }
-        y = -y;
-        x = -x;
-        return x;
     }
-    else if (x.biginteger[0] == '-' && y.biginteger[0] != '-')
+}
+
+inline void bigint_parser::push_block()
+{
+    using namespace bigint_detail;
+    limb_vector block;
+    parse_decimal(block, pending.data(), pending.size());
+    pending.clear();
+    size_t level = 6;
+    while (!nodes.empty() && nodes.back().second == level)
+    {
+        limb_vector merged;
+        combine_decimal(merged, nodes.back().first, block, level);
+        nodes.pop_back();
+        block = move(merged);
+        level++;
+    }
+    nodes.emplace_back(move(block), level);
+}
+
+inline bigint bigint_parser::finish()
+{
+    using namespace bigint_detail;
+    if (digit_count == 0)
+    {
+        reset();
+        throw invalid_argument("invalid integer");
+    }
+    /* The nodes are folded from the least significant one, the digits still pending, so that
+       every step multiplies a node by the power of ten of the smaller value below it and only
+       the last step is a large multiplication. */
+    bigint result = pending.empty() ? bigint() : bigint(pending);
+    bigint scale = pow(bigint(10), pending.size());
+    for (size_t i = nodes.size(); i-- > 0;)
     {
-        x = -x;
-        bigint z = x;
-        for (bigint i(1); i < y; unsigned_sum(i, a))
+        bigint node;
+        node.limbs = move(nodes[i].first);
+        result += node * scale;
+        if (i != 0)
         {
-            unsigned_sum(x, z);
+            limb_vector next;
+            combine_decimal(next, scale.limbs, limb_vector(), nodes[i].second);
+            scale.limbs = move(next);
         }
-        x = -x;
-        return x;
     }
-    else if (x.biginteger[0] == '-' && y.biginteger[0] == '-')
+    result.negative = negative;
+    result.erase_left_zeros();
+    reset();
+    return result;
+}
+
+inline void bigint_parser::reset()
+{
+    nodes.clear();
+    pending.clear();
+    digit_count = 0;
+    negative = false;
+    started = false;
+}
+
+/**
+ * @brief Produces the decimal digits of a number a piece at a time, without building the
+ * whole text.
+ *
+ * @details The number is split in a tree like the one of get_string, but only the path to the
+ * digits being produced is kept: the high part of every split is converted before the low part,
+ * and the low parts waiting their turn take, in total, about the size of the number. The digits
+ * are produced in pieces of at most 1216 characters, so the memory used is about twice the
+ * binary size of the number, whatever the length of its text. The number is read when the
+ * formatter is constructed and need not outlive it.
+ */
+class bigint_formatter
+{
+public:
+    explicit bigint_formatter(bigint_view x);
+
+    /**
+     * @brief Writes up to size characters of the number to buffer and returns how many were
+     * written, which is 0 only once the whole number has been produced.
+     */
+    size_t read(char *buffer, size_t size);
+    /**
+     * @brief True once every character has been produced.
+     */
+    bool done() const
+    {
+        return next == chunk.size() && parts.empty();
+    }
+
+private:
+    using limb_vector = bigint_detail::limb_vector;
+
+    /* Parts still to be converted, the next one at the back, with their number of digits, or
+       0 for the most significant part, which is written without leading zeros. */
+    vector<pair<limb_vector, size_t>> parts;
+    string chunk;
+    size_t next = 0;
+
+    /* Splits the parts until the next one is small enough, and converts it into chunk. */
+    void refill();
+};
+
+inline bigint_formatter::bigint_formatter(bigint_view x)
+{
+    if (x.is_negative())
+    {
+        chunk = "-";
+    }
+    parts.emplace_back(limb_vector(x.data(), x.data() + x.size()), 0);
+}
+
+inline void bigint_formatter::refill()
+{
+    using namespace bigint_detail;
+    chunk.clear();
+    next = 0;
+    while (chunk.empty() && !parts.empty())
     {
-        x = -x;
-        y = -y;
-        bigint z = x;
-        for (bigint i(1); i < y; unsigned_sum(i, a))
+        auto [a, width] = move(parts.back());
+        parts.pop_back();
+        const size_t n = normalized_size(a.data(), a.size());
+        if (width == 0 ? n * 20 > bigint_parser::block_digits : width > bigint_parser::block_digits)
+        {
+            /* The most significant part is split as in print_decimal, the others in two halves
+               of their number of digits, whatever their value. */
+            size_t k = 0;
+            if (width == 0)
+            {
+                k = print_split_level(n);
+            }
+            while (width != 0 && decimal_base_digits << (k + 1) < width)
+            {
+                k++;
+            }
+            const size_t low_digits = decimal_base_digits << k;
+            limb_vector q, r;
+            if (n > low_digits / 64)
+            {
+                split_decimal(q, r, a.data(), n, k);
+            }
+            else
+            {
+                /* a < 2^(64 n) <= 2^low_digits, so it is all low part. */
+                r = move(a);
+            }
+            parts.emplace_back(move(r), low_digits);
+            parts.emplace_back(move(q), width == 0 ? 0 : width - low_digits);
+            continue;
+        }
+        if (width != 0)
         {
-            unsigned_sum(x, z);
+            chunk.assign(width, '0');
+            print_decimal(chunk.data(), width, a.data(), n);
+        }
+        else if (n != 0)
+        {
+            /* The most significant part, written without its leading zeros. */
+            chunk.assign(n * 20, '0');
+            print_decimal(chunk.data(), chunk.size(), a.data(), n);
+            chunk.erase(0, chunk.find_first_not_of('0'));
+        }
+        else if (parts.empty())
+        {
+            chunk = "0";
+        }
+        else
+        {
+            /* A zero high part: the next part becomes the most significant one. */
+            parts.back().second = 0;
         }
-        y = -y;
-        return x;
     }
-    else
+}
+
+inline size_t bigint_formatter::read(char *buffer, size_t size)
+{
+    size_t written = 0;
+    while (written < size)
     {
-        bigint z = x;
-        for (bigint i(1); i < y; unsigned_sum(i, a))
+        if (next == chunk.size())
         {
-            unsigned_sum(x, z);
+            if (parts.empty())
+            {
+                break;
+            }
+            refill();
         }
-        return x;
+        const size_t n = min(size - written, chunk.size() - next);
+        copy(chunk.data() + next, chunk.data() + next + n, buffer + written);
+        next += n;
+        written += n;
     }
+    return written;
 }
+
 /**
- * @brief Multiplication operation for bigint instances.
- *
- * @param x The left-hand side bigint.
- *
- * @param y The right-hand side bigint.
+ * @brief Extracts a decimal integer from a stream.
  *
- * @details This function computes the multiplication x*y and returns a new bigint with the result
- * of the multiplication. This function uses the pre-defined *= and operator.
+ * @details Leading whitespace is skipped and an optional '-' and the digits that follow it are
+ * read, stopping before the first other character, like the extraction of a built-in integer.
+ * The digits go through a bigint_parser, so the text is never held in memory as a whole. If no
+ * digit is found the failbit is set and x is left unchanged.
  */
-bigint operator*(bigint x, bigint y)
+inline istream &operator>>(istream &in, bigint &x)
 {
-    x *= y;
-    x.erase_left_zeros();
-    return x;
+    istream::sentry sentry(in);
+    if (!sentry)
+    {
+        return in;
+    }
+    streambuf *buffer = in.rdbuf();
+    bigint_parser parser;
+    char chunk[4096];
+    size_t n = 0;
+    int c = buffer->sgetc();
+    if (c == '-')
+    {
+        chunk[n++] = '-';
+        c = buffer->snextc();
+    }
+    bool any = false;
+    while (c != char_traits<char>::eof() && c >= '0' && c <= '9')
+    {
+        chunk[n++] = (char)c;
+        any = true;
+        if (n == sizeof(chunk))
+        {
+            parser.feed(chunk, n);
+            n = 0;
+        }
+        c = buffer->snextc();
+    }
+    if (c == char_traits<char>::eof())
+    {
+        in.setstate(ios::eofbit);
+    }
+    if (!any)
+    {
+        in.setstate(ios::failbit);
+        return in;
+    }
+    parser.feed(chunk, n);
+    x = parser.finish();
+    return in;
 }
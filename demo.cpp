@@ -59,4 +59,11 @@ int main()
     A *= B;                             // The class supports the multiplication assignment operator "-="
     cout << A << "\n";
     cout << B << "\n"; // The object B stays unchanged after the use of the "*=" operator
+    string s9 = "-114040016";
+    A = s9;
+    B = 2396;
+    cout << "A/B =? " << A / B << "\n"; // The class supports the division operator "/"
+    cout << "A%7 =? " << A % 7 << "\n"; // The class supports the modulo operator "%"
+    auto [q, r] = divmod(A, 7);         // divmod returns the quotient and the remainder at once
+    cout << q << " " << r << "\n";
 }
\ No newline at end of file
@@ -0,0 +1,496 @@
+/*
+ * Tests of the bigint algorithms that must give the same result as a simpler reference.
+ *
+ * Each test compares a fast path of bigint.hpp, limb for limb, with the straightforward
+ * algorithm it replaces, on random operands and on operands chosen to stress the carries.
+ * A mismatch is printed with the name of the check and the operand sizes, and the program
+ * exits with a nonzero status when any check fails.
+ *
+ * Usage: tests [--seed N]
+ */
+#include <iostream>
+#include <random>
+#include <sstream>
+#include "../bigint.hpp"
+using namespace std;
+
+using bigint_detail::limb_t;
+
+/* Number of checks that failed so far. */
+size_t failures = 0;
+
+/* Records the outcome of one check and prints it when it failed. */
+void check(bool ok, const string &what)
+{
+    if (!ok)
+    {
+        failures++;
+        cout << "FAILED: " << what << '\n';
+    }
+}
+
+vector<limb_t> random_limbs(mt19937_64 &rng, size_t n)
+{
+    vector<limb_t> limbs(n);
+    for (limb_t &limb : limbs)
+    {
+        limb = rng();
+    }
+    return limbs;
+}
+
+vector<limb_t> ones_limbs(size_t n)
+{
+    return vector<limb_t>(n, ~(limb_t)0);
+}
+
+/* Restores the multiplication thresholds when a test that changed them returns. */
+class thresholds_scope
+{
+public:
+    explicit thresholds_scope(const bigint_thresholds &thresholds) : saved(bigint::thresholds())
+    {
+        bigint::thresholds() = thresholds;
+    }
+    ~thresholds_scope()
+    {
+        bigint::thresholds() = saved;
+    }
+    thresholds_scope(const thresholds_scope &) = delete;
+    thresholds_scope &operator=(const thresholds_scope &) = delete;
+
+private:
+    bigint_thresholds saved;
+};
+
+/*
+ * Multiplies a by b, an >= bn, through bigint_detail::mul, which picks the algorithm from the
+ * thresholds in force, and compares the product with the schoolbook one. Passing the same
+ * vector twice checks a square against sqr_basecase.
+ */
+void check_product(const vector<limb_t> &a, const vector<limb_t> &b, const string &what)
+{
+    const size_t an = a.size(), bn = b.size();
+    vector<limb_t> product(an + bn), expected(an + bn);
+    bigint_detail::mul(product.data(), a.data(), an, b.data(), bn);
+    if (&a == &b)
+    {
+        bigint_detail::sqr_basecase(expected.data(), a.data(), an);
+    }
+    else
+    {
+        bigint_detail::mul_basecase(expected.data(), a.data(), an, b.data(), bn);
+    }
+    check(product == expected,
+          what + (&a == &b ? " square " : " product ") + to_string(an) + "x" + to_string(bn));
+}
+
+/*
+ * The number-theoretic transform has to be bit-identical to the schoolbook product. The
+ * thresholds are lowered so that it runs on operands small enough to be checked against the
+ * basecase in a moment, across many transform lengths, with Karatsuba and Toom-3 in between.
+ */
+void test_ntt_small(mt19937_64 &rng)
+{
+    bigint_thresholds lowered;
+    lowered.mul_karatsuba = 4;
+    lowered.sqr_karatsuba = 4;
+    lowered.mul_toom3 = 10;
+    lowered.sqr_toom3 = 10;
+    lowered.mul_ntt = 16;
+    lowered.sqr_ntt = 16;
+    thresholds_scope scope(lowered);
+    for (size_t n = 1; n <= 160; n++)
+    {
+        vector<limb_t> a = random_limbs(rng, n), b = random_limbs(rng, n);
+        check_product(a, b, "ntt random");
+        check_product(a, a, "ntt random");
+        vector<limb_t> ones = ones_limbs(n);
+        check_product(ones, ones, "ntt all-ones");
+        vector<limb_t> other = ones_limbs(n);
+        check_product(ones, other, "ntt all-ones");
+    }
+    for (size_t i = 0; i < 200; i++)
+    {
+        size_t bn = 1 + rng() % 400, an = bn + rng() % 1200;
+        vector<limb_t> a = random_limbs(rng, an), b = random_limbs(rng, bn);
+        check_product(a, b, "ntt unbalanced random");
+        vector<limb_t> ones = ones_limbs(an), other = ones_limbs(bn);
+        check_product(ones, other, "ntt unbalanced all-ones");
+    }
+}
+
+/* Checks the products and squares on either side of the default NTT threshold. */
+void test_ntt_threshold(mt19937_64 &rng)
+{
+    thresholds_scope scope(bigint_thresholds{});
+    const bigint_thresholds defaults;
+    for (size_t n : {defaults.mul_ntt - 1, defaults.mul_ntt, defaults.sqr_ntt - 1, defaults.sqr_ntt})
+    {
+        vector<limb_t> a = random_limbs(rng, n), b = random_limbs(rng, n);
+        check_product(a, b, "threshold random");
+        check_product(a, a, "threshold random");
+        vector<limb_t> ones = ones_limbs(n), other = ones_limbs(n);
+        check_product(ones, other, "threshold all-ones");
+        check_product(ones, ones, "threshold all-ones");
+    }
+    vector<limb_t> a = random_limbs(rng, 2 * defaults.mul_ntt + 5);
+    vector<limb_t> b = random_limbs(rng, defaults.mul_ntt);
+    check_product(a, b, "threshold unbalanced random");
+}
+
+/* The operand pairs the kernels are checked on for n limbs: random, carry-heavy and mixed. */
+vector<pair<vector<limb_t>, vector<limb_t>>> kernel_operands(mt19937_64 &rng, size_t n)
+{
+    vector<limb_t> zeros(n, 0), ones = ones_limbs(n), one(n, 0);
+    if (n > 0)
+    {
+        one[0] = 1;
+    }
+    vector<limb_t> sparse = random_limbs(rng, n);
+    for (limb_t &limb : sparse)
+    {
+        limb = rng() % 3 == 0 ? 0 : rng() % 2 == 0 ? ~(limb_t)0 : limb;
+    }
+    return {{random_limbs(rng, n), random_limbs(rng, n)},
+            {zeros, zeros},
+            {ones, ones},
+            {ones, one},
+            {one, ones},
+            {zeros, ones},
+            {ones, zeros},
+            {sparse, random_limbs(rng, n)},
+            {random_limbs(rng, n), sparse}};
+}
+
+/*
+ * Runs the addition or subtraction kernel of a table into a separate result and in place over
+ * either operand, and compares the limbs and the carry with the portable kernel.
+ */
+void check_add_sub(limb_t (*kernel)(limb_t *, const limb_t *, const limb_t *, size_t),
+                   limb_t (*reference)(limb_t *, const limb_t *, const limb_t *, size_t),
+                   const vector<limb_t> &a, const vector<limb_t> &b, const string &what)
+{
+    const size_t n = a.size();
+    vector<limb_t> expected(n), r(n);
+    limb_t expected_carry = reference(expected.data(), a.data(), b.data(), n);
+    limb_t carry = kernel(r.data(), a.data(), b.data(), n);
+    check(r == expected && carry == expected_carry, what + " " + to_string(n));
+    r = a;
+    carry = kernel(r.data(), r.data(), b.data(), n);
+    check(r == expected && carry == expected_carry, what + " in place over a " + to_string(n));
+    r = b;
+    carry = kernel(r.data(), a.data(), r.data(), n);
+    check(r == expected && carry == expected_carry, what + " in place over b " + to_string(n));
+}
+
+/*
+ * Every kernel table the processor supports must give the same limbs, carries and results as
+ * the portable kernels, for all lengths up to 64 limbs, which covers the unrolled loops of the
+ * vector kernels and their tails.
+ */
+void test_kernels(mt19937_64 &rng)
+{
+    for (const bigint_detail::kernel_table &table : bigint_detail::supported_kernels())
+    {
+        const string name = table.name;
+        for (size_t n = 0; n <= 64; n++)
+        {
+            for (const auto &[a, b] : kernel_operands(rng, n))
+            {
+                check_add_sub(table.add_n, bigint_detail::generic::add_n, a, b, name + " add_n");
+                check_add_sub(table.sub_n, bigint_detail::generic::sub_n, a, b, name + " sub_n");
+                for (limb_t m : {(limb_t)rng(), (limb_t)0, (limb_t)1, ~(limb_t)0})
+                {
+                    vector<limb_t> expected = a, r = a;
+                    limb_t expected_carry = bigint_detail::generic::addmul_1(expected.data(), b.data(), n, m);
+                    limb_t carry = table.addmul_1(r.data(), b.data(), n, m);
+                    check(r == expected && carry == expected_carry, name + " addmul_1 " + to_string(n));
+                    expected = a;
+                    r = a;
+                    expected_carry = bigint_detail::generic::addmul_1(expected.data(), expected.data(), n, m);
+                    carry = table.addmul_1(r.data(), r.data(), n, m);
+                    check(r == expected && carry == expected_carry, name + " addmul_1 in place " + to_string(n));
+                }
+                check(table.cmp_n(a.data(), b.data(), n) == bigint_detail::generic::cmp_n(a.data(), b.data(), n),
+                      name + " cmp_n " + to_string(n));
+                check(table.cmp_n(a.data(), a.data(), n) == 0, name + " cmp_n equal " + to_string(n));
+                for (size_t i = 0; i < n; i++)
+                {
+                    vector<limb_t> c = a;
+                    c[i] ^= (limb_t)1 << (rng() % 64);
+                    check(table.cmp_n(a.data(), c.data(), n) == bigint_detail::generic::cmp_n(a.data(), c.data(), n) &&
+                              table.cmp_n(c.data(), a.data(), n) == bigint_detail::generic::cmp_n(c.data(), a.data(), n),
+                          name + " cmp_n differing at " + to_string(i) + " of " + to_string(n));
+                }
+                for (size_t zeros = 0; zeros <= n; zeros++)
+                {
+                    vector<limb_t> c = a;
+                    fill(c.end() - (ptrdiff_t)zeros, c.end(), 0);
+                    check(table.normalized_size(c.data(), n) == bigint_detail::generic::normalized_size(c.data(), n),
+                          name + " normalized_size " + to_string(n) + " with " + to_string(zeros) + " zeros");
+                }
+            }
+        }
+    }
+}
+
+/* Primality by trial division, the reference for the small values. */
+bool is_prime_by_division(uint64_t n)
+{
+    if (n < 2)
+    {
+        return false;
+    }
+    for (uint64_t d = 2; d * d <= n; d++)
+    {
+        if (n % d == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * is_probable_prime and miller_rabin must agree with trial division on both sides of the table
+ * of primes below 2^20, and reject zero, one and every negative number, however large, instead
+ * of reaching the tests that work modulo n.
+ */
+void test_primes(mt19937_64 &rng)
+{
+    vector<int64_t> values;
+    for (int64_t n = 0; n < 2000; n++)
+    {
+        values.push_back(n);
+        values.push_back((1u << 20) - 1000 + n);
+    }
+    for (size_t i = 0; i < 2000; i++)
+    {
+        values.push_back((int64_t)((1u << 20) + rng() % (1u << 24)));
+    }
+    for (int64_t n : values)
+    {
+        const bool prime = is_prime_by_division((uint64_t)n);
+        check(is_probable_prime(bigint(n)) == prime, "is_probable_prime " + to_string(n));
+        check(miller_rabin(bigint(n), 8, rng) == prime, "miller_rabin " + to_string(n));
+    }
+    const bigint mersenne = (bigint(1) << 127) - 1;
+    check(is_probable_prime(mersenne), "is_probable_prime 2^127-1");
+    vector<bigint> negatives = {-1, -2, -3, -4, -1048573, -1048583, -(bigint(1) << 64) - 13, -mersenne,
+                                -((bigint(1) << 127) + 1)};
+    for (const bigint &n : negatives)
+    {
+        ostringstream text;
+        text << n;
+        bool prime = true;
+        try
+        {
+            prime = is_probable_prime(n);
+        }
+        catch (const exception &e)
+        {
+            check(false, "is_probable_prime " + text.str() + " threw " + e.what());
+            continue;
+        }
+        check(!prime, "is_probable_prime " + text.str());
+        check(!miller_rabin(n, 8, rng), "miller_rabin " + text.str());
+        check(next_prime(n) == 2, "next_prime " + text.str());
+    }
+}
+
+/*
+ * bigint_mpn::mul and sqr must give the schoolbook result with exactly the scratch space that
+ * mul_scratch_size and sqr_scratch_size ask for, and throw instead of writing past a scratch
+ * span one limb shorter.
+ */
+void test_mpn_scratch(mt19937_64 &rng)
+{
+    for (size_t i = 0; i < 100; i++)
+    {
+        size_t bn = 1 + rng() % 400, an = bn + rng() % 400;
+        vector<limb_t> a = random_limbs(rng, an), b = random_limbs(rng, bn);
+        vector<limb_t> product(an + bn), expected(an + bn);
+        vector<limb_t> scratch(bigint_mpn::mul_scratch_size(an, bn));
+        bigint_mpn::mul(product, a, b, scratch);
+        bigint_detail::mul_basecase(expected.data(), a.data(), an, b.data(), bn);
+        check(product == expected, "bigint_mpn::mul " + to_string(an) + "x" + to_string(bn));
+        vector<limb_t> square(2 * bn), expected_square(2 * bn);
+        vector<limb_t> square_scratch(bigint_mpn::sqr_scratch_size(bn));
+        bigint_mpn::sqr(square, b, square_scratch);
+        bigint_detail::sqr_basecase(expected_square.data(), b.data(), bn);
+        check(square == expected_square, "bigint_mpn::sqr " + to_string(bn));
+        if (!scratch.empty())
+        {
+            scratch.pop_back();
+            bool thrown = false;
+            try
+            {
+                bigint_mpn::mul(product, a, b, scratch);
+            }
+            catch (const invalid_argument &)
+            {
+                thrown = true;
+            }
+            check(thrown, "bigint_mpn::mul short scratch " + to_string(an) + "x" + to_string(bn));
+        }
+        if (!square_scratch.empty())
+        {
+            square_scratch.pop_back();
+            bool thrown = false;
+            try
+            {
+                bigint_mpn::sqr(square, b, square_scratch);
+            }
+            catch (const invalid_argument &)
+            {
+                thrown = true;
+            }
+            check(thrown, "bigint_mpn::sqr short scratch " + to_string(bn));
+        }
+    }
+}
+
+/*
+ * addmul and submul accumulate the product in place, through the per-thread buffer for small
+ * products and a temporary for large ones; both must agree with forming the product first.
+ */
+void test_addmul(mt19937_64 &rng)
+{
+    for (size_t i = 0; i < 300; i++)
+    {
+        const uint64_t limit = i < 250 ? 64 * 20 : 64 * 3000;
+        bigint x = random_bits(rng() % limit, rng), a = random_bits(rng() % limit, rng),
+               b = random_bits(rng() % limit, rng);
+        if (rng() % 2 == 0)
+        {
+            x = -x;
+        }
+        if (rng() % 2 == 0)
+        {
+            a = -a;
+        }
+        bigint sum = x, difference = x;
+        addmul(sum, a, b);
+        submul(difference, a, b);
+        check(sum == x + a * b, "addmul " + to_string(a.bit_length()) + "x" + to_string(b.bit_length()));
+        check(difference == x - a * b, "submul " + to_string(a.bit_length()) + "x" + to_string(b.bit_length()));
+    }
+}
+
+string random_decimal(mt19937_64 &rng, size_t digits)
+{
+    string text = rng() % 2 == 0 ? "-" : "";
+    text.push_back((char)('1' + rng() % 9));
+    for (size_t i = 1; i < digits; i++)
+    {
+        text.push_back((char)('0' + rng() % 10));
+    }
+    return text;
+}
+
+/*
+ * The explicit conversions between bigint and decimal_bigint work on the limbs, splitting by
+ * powers of 10^18 above conversion_dc limbs; they must agree with going through the string,
+ * including for values whose limbs are mostly zero or all nines.
+ */
+void test_decimal_conversions(mt19937_64 &rng)
+{
+    vector<string> values = {"0", "1", "-1", "999999999999999999", "1000000000000000000", "-1000000000000000000"};
+    for (size_t digits : {18u, 19u, 36u, 37u, 540u, 541u, 1000u, 5000u, 20000u})
+    {
+        values.push_back(random_decimal(rng, digits));
+        values.push_back("1" + string(digits, '0'));
+        values.push_back("-" + string(digits, '9'));
+        values.push_back("1" + string(digits / 2, '0') + "1" + string(digits / 2, '0'));
+    }
+    for (const string &text : values)
+    {
+        const bigint binary(text);
+        const decimal_bigint decimal(text);
+        check(decimal_bigint(binary) == decimal, "decimal_bigint(bigint) " + text.substr(0, 40));
+        check(bigint(decimal) == binary, "bigint(decimal_bigint) " + text.substr(0, 40));
+    }
+}
+
+/*
+ * Code written once against basic_bigint<Radix>, using the operators and functions the two
+ * radices have in common, must compile for both and print the same results. x must not be
+ * zero, since it is also a divisor.
+ */
+template <class Radix>
+string generic_operations(const string &x_text, const string &y_text)
+{
+    using integer = basic_bigint<Radix>;
+    const integer x(x_text), y(y_text);
+    const integer magnitude = x < 0 ? -x : x;
+    ostringstream out;
+    out << x + y << ' ' << x - y << ' ' << x * y << ' ' << y / x << ' ' << y % x << ' ';
+    out << integer(x) + y << ' ' << x - integer(y) << ' ' << integer(x) * integer(y) << ' ';
+    const auto [q, r] = divmod(y, x);
+    out << q << ' ' << r << ' ' << pow(x, 3) << ' ' << -x << ' ';
+    out << (x & y) << ' ' << (x | y) << ' ' << (x ^ y) << ' ' << ~x << ' ' << (x << 67) << ' ' << (y >> 67) << ' ';
+    out << isqrt(magnitude) << ' ' << iroot(magnitude, 3) << ' ' << gcd(x, y) << ' ';
+    const auto [g, s, t] = xgcd(x, y);
+    out << g << ' ' << s << ' ' << t << ' ';
+    out << magnitude.bit_length() << ' ' << magnitude.popcount() << ' ' << x.count_trailing_zeros() << ' ';
+    out << x.test_bit(70) << y.test_bit(3) << (x < y) << (x == y) << (x <= y) << (x != y) << ' ';
+    integer a = x;
+    a += y;
+    a -= 3;
+    a *= y;
+    a /= x;
+    a %= y + 1;
+    a <<= 5;
+    a >>= 2;
+    a &= y;
+    a |= x;
+    a ^= y;
+    addmul(a, x, y);
+    submul(a, y, y);
+    a.set_bit(100);
+    a.clear_bit(2);
+    out << a << ' ' << a.get_string();
+    return out.str();
+}
+
+/* Checks that the binary and decimal integers agree on the whole common surface. */
+void test_radices(mt19937_64 &rng)
+{
+    for (size_t i = 0; i < 200; i++)
+    {
+        const string x = random_decimal(rng, 1 + rng() % (i < 150 ? 60 : 1500));
+        const string y = random_decimal(rng, 1 + rng() % (i < 150 ? 60 : 1500));
+        check(generic_operations<binary_radix>(x, y) == generic_operations<decimal_radix>(x, y),
+              "basic_bigint " + x.substr(0, 40) + " " + y.substr(0, 40));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seed = random_device{}();
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--seed" && i + 1 < argc)
+        {
+            seed = stoull(argv[++i]);
+        }
+    }
+    cout << "seed " << seed << '\n';
+    mt19937_64 rng(seed);
+    test_ntt_small(rng);
+    test_ntt_threshold(rng);
+    test_kernels(rng);
+    test_primes(rng);
+    test_mpn_scratch(rng);
+    test_addmul(rng);
+    test_decimal_conversions(rng);
+    test_radices(rng);
+    if (failures != 0)
+    {
+        cout << failures << " checks failed\n";
+        return 1;
+    }
+    cout << "all checks passed\n";
+    return 0;
+}